@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <limits>
+
+#include "config.h"
+
+#ifdef _WIN32
+# include <malloc.h>
+#endif
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief std allocator returning memory aligned to Align bytes
+///
+/// Used for the SIMD friendly containers, so vector loads / stores
+/// can use the aligned forms.
+template <typename T, size_t Align = 32>
+class aligned_allocator
+{
+public:
+	static_assert( Align >= alignof(T) && ( Align & ( Align - 1 ) ) == 0, "Invalid alignment" );
+
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind { typedef aligned_allocator<U, Align> other; };
+
+	aligned_allocator( void ) noexcept {}
+	template <typename U>
+	aligned_allocator( const aligned_allocator<U, Align> & ) noexcept {}
+
+	T *allocate( size_t n )
+	{
+		if ( n > std::numeric_limits<size_t>::max() / sizeof(T) )
+			throw std::bad_alloc();
+
+		void *p = nullptr;
+#ifdef _WIN32
+		p = _aligned_malloc( n * sizeof(T), Align );
+#else
+		if ( ::posix_memalign( &p, Align < sizeof(void *) ? sizeof(void *) : Align, n * sizeof(T) ) != 0 )
+			p = nullptr;
+#endif
+		if ( ! p )
+			throw std::bad_alloc();
+		return static_cast<T *>( p );
+	}
+
+	void deallocate( T *p, size_t ) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free( p );
+#else
+		::free( p );
+#endif
+	}
+
+	template <typename U>
+	bool operator==( const aligned_allocator<U, Align> & ) const noexcept { return true; }
+	template <typename U>
+	bool operator!=( const aligned_allocator<U, Align> & ) const noexcept { return false; }
+};
+
+} // namespace __priv
+
+} // namespace yaco
+
+
+////////////////////////////////////////
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -0,0 +1,494 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "vector_pack.h"
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief Whether det, computed from the dim x dim m, is
+/// indistinguishable from 0
+///
+/// |det| is at most the product of the lengths of the rows
+/// (Hadamard's inequality), and rounding leaves the determinant of
+/// a singular matrix within about an ulp of that product rather
+/// than at 0, so det is compared to it. This doesn't depend on the
+/// scale of the rows.
+template <typename T, size_t dim>
+inline bool
+negligible_determinant( const T *m, T det )
+{
+	T q = std::abs( det );
+	for ( size_t r = 0; r != dim; ++r )
+	{
+		// scaled by the largest entry so the squares can't overflow
+		T mx = T( 0 );
+		for ( size_t c = 0; c != dim; ++c )
+			mx = std::max( mx, std::abs( m[c * dim + r] ) );
+		if ( mx == T( 0 ) )
+			return true;
+		T imx = T( 1 ) / mx, s = T( 0 );
+		for ( size_t c = 0; c != dim; ++c )
+		{
+			T v = m[c * dim + r] * imx;
+			s += v * v;
+		}
+		q /= mx * std::sqrt( s );
+	}
+	return q <= T( 2 * dim ) * std::numeric_limits<T>::epsilon();
+}
+
+/// @brief The per matrix kernels of a math::square_matrix
+///
+/// All matrices are dim x dim, column major (element (r, c) at
+/// m[c * dim + r]) and 16 byte aligned, vectors are dim elements
+/// (stored as a math::vector, so padded to vector_pack<T, dim>).
+/// Outputs never alias inputs. This is the scalar version, with
+/// closed forms for the inverse and determinant up to 4 x 4 and
+/// Gauss-Jordan elimination beyond that. The determinant and the
+/// inverse come from the same arithmetic, and both treat a
+/// negligible_determinant as 0, so they agree on which matrices are
+/// singular.
+template <typename T, size_t dim>
+struct matrix_ops_scalar
+{
+	/// out = a * b
+	static void multiply( const T *a, const T *b, T *out )
+	{
+		for ( size_t c = 0; c != dim; ++c )
+		{
+			for ( size_t r = 0; r != dim; ++r )
+			{
+				T s = a[r] * b[c * dim];
+				for ( size_t k = 1; k != dim; ++k )
+					s += a[k * dim + r] * b[c * dim + k];
+				out[c * dim + r] = s;
+			}
+		}
+	}
+
+	/// out = m * v
+	static void transform( const T *m, const T *v, T *out )
+	{
+		for ( size_t r = 0; r != dim; ++r )
+		{
+			T s = m[r] * v[0];
+			for ( size_t k = 1; k != dim; ++k )
+				s += m[k * dim + r] * v[k];
+			out[r] = s;
+		}
+	}
+
+	static void transpose( const T *m, T *out )
+	{
+		for ( size_t c = 0; c != dim; ++c )
+			for ( size_t r = 0; r != dim; ++r )
+				out[r * dim + c] = m[c * dim + r];
+	}
+
+	static T determinant( const T *m )
+	{
+		T det = det_impl( m, std::integral_constant<size_t, dim>() );
+		return negligible_determinant<T, dim>( m, det ) ? T( 0 ) : det;
+	}
+
+	/// writes the inverse to out and returns the determinant, out
+	/// is unspecified when that is 0
+	static T inverse( const T *m, T *out )
+	{
+		T det = inverse_impl( m, out, std::integral_constant<size_t, dim>() );
+		return det == T( 0 ) || negligible_determinant<T, dim>( m, det ) ? T( 0 ) : det;
+	}
+
+private:
+	static T at( const T *m, size_t r, size_t c ) { return m[c * dim + r]; }
+
+	static T det_impl( const T *m, std::integral_constant<size_t, 1> ) { return m[0]; }
+	static T det_impl( const T *m, std::integral_constant<size_t, 2> ) { return m[0] * m[3] - m[2] * m[1]; }
+	static T det_impl( const T *m, std::integral_constant<size_t, 3> )
+	{
+		return inverse_impl( m, nullptr, std::integral_constant<size_t, 3>(), false );
+	}
+	static T det_impl( const T *m, std::integral_constant<size_t, 4> )
+	{
+		return inverse_impl( m, nullptr, std::integral_constant<size_t, 4>(), false );
+	}
+	template <size_t N>
+	static T det_impl( const T *m, std::integral_constant<size_t, N> )
+	{
+		return inverse_impl( m, nullptr, std::integral_constant<size_t, N>(), false );
+	}
+
+	static T inverse_impl( const T *m, T *out, std::integral_constant<size_t, 1> )
+	{
+		if ( m[0] != T( 0 ) )
+			out[0] = T( 1 ) / m[0];
+		return m[0];
+	}
+	static T inverse_impl( const T *m, T *out, std::integral_constant<size_t, 2> )
+	{
+		T det = det_impl( m, std::integral_constant<size_t, 2>() );
+		if ( det == T( 0 ) )
+			return det;
+		T id = T( 1 ) / det;
+		out[0] = m[3] * id;
+		out[1] = -m[1] * id;
+		out[2] = -m[2] * id;
+		out[3] = m[0] * id;
+		return det;
+	}
+	static T inverse_impl( const T *m, T *out, std::integral_constant<size_t, 3>, bool write = true )
+	{
+		// transposed cofactors
+		T c00 = at( m, 1, 1 ) * at( m, 2, 2 ) - at( m, 1, 2 ) * at( m, 2, 1 );
+		T c01 = at( m, 1, 2 ) * at( m, 2, 0 ) - at( m, 1, 0 ) * at( m, 2, 2 );
+		T c02 = at( m, 1, 0 ) * at( m, 2, 1 ) - at( m, 1, 1 ) * at( m, 2, 0 );
+		T det = at( m, 0, 0 ) * c00 + at( m, 0, 1 ) * c01 + at( m, 0, 2 ) * c02;
+		if ( ! write || det == T( 0 ) )
+			return det;
+		T id = T( 1 ) / det;
+		out[0] = c00 * id;
+		out[1] = c01 * id;
+		out[2] = c02 * id;
+		out[3] = ( at( m, 0, 2 ) * at( m, 2, 1 ) - at( m, 0, 1 ) * at( m, 2, 2 ) ) * id;
+		out[4] = ( at( m, 0, 0 ) * at( m, 2, 2 ) - at( m, 0, 2 ) * at( m, 2, 0 ) ) * id;
+		out[5] = ( at( m, 0, 1 ) * at( m, 2, 0 ) - at( m, 0, 0 ) * at( m, 2, 1 ) ) * id;
+		out[6] = ( at( m, 0, 1 ) * at( m, 1, 2 ) - at( m, 0, 2 ) * at( m, 1, 1 ) ) * id;
+		out[7] = ( at( m, 0, 2 ) * at( m, 1, 0 ) - at( m, 0, 0 ) * at( m, 1, 2 ) ) * id;
+		out[8] = ( at( m, 0, 0 ) * at( m, 1, 1 ) - at( m, 0, 1 ) * at( m, 1, 0 ) ) * id;
+		return det;
+	}
+	static T inverse_impl( const T *m, T *out, std::integral_constant<size_t, 4>, bool write = true )
+	{
+		// Laplace expansion by the 2 x 2 minors of the top two and
+		// bottom two rows
+		T a00 = at( m, 0, 0 ), a01 = at( m, 0, 1 ), a02 = at( m, 0, 2 ), a03 = at( m, 0, 3 );
+		T a10 = at( m, 1, 0 ), a11 = at( m, 1, 1 ), a12 = at( m, 1, 2 ), a13 = at( m, 1, 3 );
+		T a20 = at( m, 2, 0 ), a21 = at( m, 2, 1 ), a22 = at( m, 2, 2 ), a23 = at( m, 2, 3 );
+		T a30 = at( m, 3, 0 ), a31 = at( m, 3, 1 ), a32 = at( m, 3, 2 ), a33 = at( m, 3, 3 );
+
+		T s0 = a00 * a11 - a10 * a01;
+		T s1 = a00 * a12 - a10 * a02;
+		T s2 = a00 * a13 - a10 * a03;
+		T s3 = a01 * a12 - a11 * a02;
+		T s4 = a01 * a13 - a11 * a03;
+		T s5 = a02 * a13 - a12 * a03;
+
+		T c5 = a22 * a33 - a32 * a23;
+		T c4 = a21 * a33 - a31 * a23;
+		T c3 = a21 * a32 - a31 * a22;
+		T c2 = a20 * a33 - a30 * a23;
+		T c1 = a20 * a32 - a30 * a22;
+		T c0 = a20 * a31 - a30 * a21;
+
+		T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if ( ! write || det == T( 0 ) )
+			return det;
+
+		T id = T( 1 ) / det;
+		T *o = out;
+		// column 0
+		o[0] = ( a11 * c5 - a12 * c4 + a13 * c3 ) * id;
+		o[1] = ( -a10 * c5 + a12 * c2 - a13 * c1 ) * id;
+		o[2] = ( a10 * c4 - a11 * c2 + a13 * c0 ) * id;
+		o[3] = ( -a10 * c3 + a11 * c1 - a12 * c0 ) * id;
+		// column 1
+		o[4] = ( -a01 * c5 + a02 * c4 - a03 * c3 ) * id;
+		o[5] = ( a00 * c5 - a02 * c2 + a03 * c1 ) * id;
+		o[6] = ( -a00 * c4 + a01 * c2 - a03 * c0 ) * id;
+		o[7] = ( a00 * c3 - a01 * c1 + a02 * c0 ) * id;
+		// column 2
+		o[8] = ( a31 * s5 - a32 * s4 + a33 * s3 ) * id;
+		o[9] = ( -a30 * s5 + a32 * s2 - a33 * s1 ) * id;
+		o[10] = ( a30 * s4 - a31 * s2 + a33 * s0 ) * id;
+		o[11] = ( -a30 * s3 + a31 * s1 - a32 * s0 ) * id;
+		// column 3
+		o[12] = ( -a21 * s5 + a22 * s4 - a23 * s3 ) * id;
+		o[13] = ( a20 * s5 - a22 * s2 + a23 * s1 ) * id;
+		o[14] = ( -a20 * s4 + a21 * s2 - a23 * s0 ) * id;
+		o[15] = ( a20 * s3 - a21 * s1 + a22 * s0 ) * id;
+		return det;
+	}
+	/// without write only the determinant is wanted, so only the
+	/// rows below the pivot (which decide the pivots) are reduced
+	template <size_t N>
+	static T inverse_impl( const T *m, T *out, std::integral_constant<size_t, N>, bool write = true )
+	{
+		// Gauss-Jordan with partial pivoting on [ m | I ]
+		T a[dim * dim];
+		T inv[dim * dim];
+		std::copy( m, m + dim * dim, a );
+		std::fill( inv, inv + dim * dim, T( 0 ) );
+		for ( size_t i = 0; i != dim; ++i )
+			inv[i * dim + i] = T( 1 );
+
+		T det = T( 1 );
+		for ( size_t k = 0; k != dim; ++k )
+		{
+			size_t p = k;
+			for ( size_t r = k + 1; r != dim; ++r )
+				if ( std::abs( a[k * dim + r] ) > std::abs( a[k * dim + p] ) )
+					p = r;
+			if ( a[k * dim + p] == T( 0 ) )
+				return T( 0 );
+			if ( p != k )
+			{
+				for ( size_t c = 0; c != dim; ++c )
+				{
+					std::swap( a[c * dim + p], a[c * dim + k] );
+					std::swap( inv[c * dim + p], inv[c * dim + k] );
+				}
+				det = -det;
+			}
+			T piv = a[k * dim + k];
+			det *= piv;
+			T ip = T( 1 ) / piv;
+			for ( size_t c = 0; c != dim; ++c )
+			{
+				a[c * dim + k] *= ip;
+				inv[c * dim + k] *= ip;
+			}
+			for ( size_t r = write ? 0 : k + 1; r != dim; ++r )
+			{
+				if ( r == k )
+					continue;
+				T f = a[k * dim + r];
+				if ( f == T( 0 ) )
+					continue;
+				for ( size_t c = 0; c != dim; ++c )
+				{
+					a[c * dim + r] -= f * a[c * dim + k];
+					inv[c * dim + r] -= f * inv[c * dim + k];
+				}
+			}
+		}
+		if ( write )
+			std::copy( inv, inv + dim * dim, out );
+		return det;
+	}
+};
+
+template <typename T, size_t dim>
+struct matrix_ops : public matrix_ops_scalar<T, dim>
+{
+};
+
+#ifdef YACO_VECTOR_SSE2
+
+/// 4 x 4 float, a column per register
+template <>
+struct matrix_ops<float, 4>
+{
+	static void multiply( const float *a, const float *b, float *out )
+	{
+		__m128 a0 = _mm_load_ps( a ), a1 = _mm_load_ps( a + 4 );
+		__m128 a2 = _mm_load_ps( a + 8 ), a3 = _mm_load_ps( a + 12 );
+		for ( size_t c = 0; c != 4; ++c )
+			_mm_store_ps( out + c * 4, combine( a0, a1, a2, a3, _mm_load_ps( b + c * 4 ) ) );
+	}
+
+	static void transform( const float *m, const float *v, float *out )
+	{
+		_mm_store_ps( out, combine( _mm_load_ps( m ), _mm_load_ps( m + 4 ),
+									_mm_load_ps( m + 8 ), _mm_load_ps( m + 12 ),
+									_mm_load_ps( v ) ) );
+	}
+
+	static void transpose( const float *m, float *out )
+	{
+		__m128 c0 = _mm_load_ps( m ), c1 = _mm_load_ps( m + 4 );
+		__m128 c2 = _mm_load_ps( m + 8 ), c3 = _mm_load_ps( m + 12 );
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+		_mm_store_ps( out, c0 );
+		_mm_store_ps( out + 4, c1 );
+		_mm_store_ps( out + 8, c2 );
+		_mm_store_ps( out + 12, c3 );
+	}
+
+	static float determinant( const float *m )
+	{
+		float det = block_inverse( m, nullptr, false );
+		return negligible_determinant<float, 4>( m, det ) ? 0.F : det;
+	}
+
+	static float inverse( const float *m, float *out )
+	{
+		float det = block_inverse( m, out, true );
+		return negligible_determinant<float, 4>( m, det ) ? 0.F : det;
+	}
+
+private:
+	/// a0 * v.x + a1 * v.y + a2 * v.z + a3 * v.w
+	static __m128 combine( __m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 v )
+	{
+		__m128 r = _mm_mul_ps( a0, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+		r = _mm_add_ps( r, _mm_mul_ps( a1, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+		r = _mm_add_ps( r, _mm_mul_ps( a2, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+		return _mm_add_ps( r, _mm_mul_ps( a3, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+	}
+
+	// 2 x 2 matrices packed in a register as ( m00, m01, m10, m11 )
+#define YACO_SWZ( v, x, y, z, w ) _mm_shuffle_ps( v, v, _MM_SHUFFLE( w, z, y, x ) )
+	/// a * b
+	static __m128 mul2( __m128 a, __m128 b )
+	{
+		return _mm_add_ps( _mm_mul_ps( a, YACO_SWZ( b, 0, 3, 0, 3 ) ),
+						   _mm_mul_ps( YACO_SWZ( a, 1, 0, 3, 2 ), YACO_SWZ( b, 2, 1, 2, 1 ) ) );
+	}
+	/// adjugate( a ) * b
+	static __m128 adj_mul2( __m128 a, __m128 b )
+	{
+		return _mm_sub_ps( _mm_mul_ps( YACO_SWZ( a, 3, 3, 0, 0 ), b ),
+						   _mm_mul_ps( YACO_SWZ( a, 1, 1, 2, 2 ), YACO_SWZ( b, 2, 3, 0, 1 ) ) );
+	}
+	/// a * adjugate( b )
+	static __m128 mul_adj2( __m128 a, __m128 b )
+	{
+		return _mm_sub_ps( _mm_mul_ps( a, YACO_SWZ( b, 3, 0, 3, 0 ) ),
+						   _mm_mul_ps( YACO_SWZ( a, 1, 0, 3, 2 ), YACO_SWZ( b, 2, 1, 2, 1 ) ) );
+	}
+
+	/// @brief Inverse by 2 x 2 blocks
+	///
+	/// With M = | A B | the inverse is 1 / |M| * | X Y |, where
+	///          | C D |                          | Z W |
+	/// X# = |D| A - B ( D# C ), W# = |A| D - C ( A# B ),
+	/// Y# = |B| C - D ( A# B )#, Z# = |C| B - A ( D# C )#
+	/// and |M| = |A| |D| + |B| |C| - tr( ( A# B ) ( D# C ) ),
+	/// # being the adjugate. The columns are treated as rows, which
+	/// inverts the transpose, whose rows are the inverse's columns.
+	static float block_inverse( const float *m, float *out, bool write )
+	{
+		__m128 r0 = _mm_load_ps( m ), r1 = _mm_load_ps( m + 4 );
+		__m128 r2 = _mm_load_ps( m + 8 ), r3 = _mm_load_ps( m + 12 );
+
+		__m128 A = _mm_movelh_ps( r0, r1 );
+		__m128 B = _mm_movehl_ps( r1, r0 );
+		__m128 C = _mm_movelh_ps( r2, r3 );
+		__m128 D = _mm_movehl_ps( r3, r2 );
+
+		// ( |A|, |B|, |C|, |D| )
+		__m128 detSub = _mm_sub_ps(
+			_mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+						_mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+			_mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 3, 1, 3, 1 ) ),
+						_mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ) );
+		__m128 detA = YACO_SWZ( detSub, 0, 0, 0, 0 );
+		__m128 detB = YACO_SWZ( detSub, 1, 1, 1, 1 );
+		__m128 detC = YACO_SWZ( detSub, 2, 2, 2, 2 );
+		__m128 detD = YACO_SWZ( detSub, 3, 3, 3, 3 );
+
+		__m128 D_C = adj_mul2( D, C );
+		__m128 A_B = adj_mul2( A, B );
+
+		__m128 tr = _mm_mul_ps( A_B, YACO_SWZ( D_C, 0, 2, 1, 3 ) );
+		tr = _mm_add_ps( tr, _mm_movehl_ps( tr, tr ) );
+		tr = _mm_add_ss( tr, YACO_SWZ( tr, 1, 1, 1, 1 ) );
+		tr = YACO_SWZ( tr, 0, 0, 0, 0 );
+
+		__m128 detM = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) ), tr );
+		float det = _mm_cvtss_f32( detM );
+		if ( ! write || det == 0.F )
+			return det;
+
+		__m128 X_ = _mm_sub_ps( _mm_mul_ps( detD, A ), mul2( B, D_C ) );
+		__m128 W_ = _mm_sub_ps( _mm_mul_ps( detA, D ), mul2( C, A_B ) );
+		__m128 Y_ = _mm_sub_ps( _mm_mul_ps( detB, C ), mul_adj2( D, A_B ) );
+		__m128 Z_ = _mm_sub_ps( _mm_mul_ps( detC, B ), mul_adj2( A, D_C ) );
+
+		// ( 1/|M|, -1/|M|, -1/|M|, 1/|M| ) applies the adjugate signs
+		__m128 rDetM = _mm_div_ps( _mm_setr_ps( 1.F, -1.F, -1.F, 1.F ), detM );
+		X_ = _mm_mul_ps( X_, rDetM );
+		Y_ = _mm_mul_ps( Y_, rDetM );
+		Z_ = _mm_mul_ps( Z_, rDetM );
+		W_ = _mm_mul_ps( W_, rDetM );
+
+		// the adjugate swap and the store layout in one shuffle
+		_mm_store_ps( out, _mm_shuffle_ps( X_, Y_, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+		_mm_store_ps( out + 4, _mm_shuffle_ps( X_, Y_, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+		_mm_store_ps( out + 8, _mm_shuffle_ps( Z_, W_, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+		_mm_store_ps( out + 12, _mm_shuffle_ps( Z_, W_, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+		return det;
+	}
+#undef YACO_SWZ
+};
+
+/// 4 x 4 double, a column per AVX register (or pair of SSE2
+/// registers), the rest is the scalar version
+template <>
+struct matrix_ops<double, 4> : public matrix_ops_scalar<double, 4>
+{
+	static void multiply( const double *a, const double *b, double *out )
+	{
+		for ( size_t c = 0; c != 4; ++c )
+			transform( a, b + c * 4, out + c * 4 );
+	}
+
+#ifdef YACO_VECTOR_AVX
+	static void transform( const double *m, const double *v, double *out )
+	{
+		__m256d r = _mm256_mul_pd( _mm256_loadu_pd( m ), _mm256_broadcast_sd( v ) );
+		r = _mm256_add_pd( r, _mm256_mul_pd( _mm256_loadu_pd( m + 4 ), _mm256_broadcast_sd( v + 1 ) ) );
+		r = _mm256_add_pd( r, _mm256_mul_pd( _mm256_loadu_pd( m + 8 ), _mm256_broadcast_sd( v + 2 ) ) );
+		r = _mm256_add_pd( r, _mm256_mul_pd( _mm256_loadu_pd( m + 12 ), _mm256_broadcast_sd( v + 3 ) ) );
+		_mm256_storeu_pd( out, r );
+	}
+#else
+	static void transform( const double *m, const double *v, double *out )
+	{
+		__m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+		for ( size_t k = 0; k != 4; ++k )
+		{
+			__m128d s = _mm_set1_pd( v[k] );
+			lo = _mm_add_pd( lo, _mm_mul_pd( _mm_load_pd( m + k * 4 ), s ) );
+			hi = _mm_add_pd( hi, _mm_mul_pd( _mm_load_pd( m + k * 4 + 2 ), s ) );
+		}
+		_mm_store_pd( out, lo );
+		_mm_store_pd( out + 2, hi );
+	}
+#endif
+};
+
+#endif // YACO_VECTOR_SSE2
+
+} // namespace __priv
+
+} // namespace yaco
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
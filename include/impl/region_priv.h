@@ -0,0 +1,855 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <thread>
+
+#include "config.h"
+#include "../small_vector.h"
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief The properties of a coordinate type the region code uses:
+/// the sentinels for infinite regions and the neighboring values
+///
+/// Regions include both their left and right edge. For integers
+/// the neighbors are +/- 1 and the sentinels the limits of the
+/// type, for floating point the neighbors are the next
+/// representable values and the sentinels the infinities, so the
+/// same inclusive arithmetic works for both.
+template <typename T, bool = std::is_integral<T>::value>
+struct region_coord
+{
+	static constexpr T lowest( void ) { return std::numeric_limits<T>::min(); }
+	static constexpr T highest( void ) { return std::numeric_limits<T>::max(); }
+	/// size of a region whose left and right are the same
+	static constexpr T unit( void ) { return T( 1 ); }
+	static constexpr T next( T x ) { return T( x + 1 ); }
+	static constexpr T prev( T x ) { return T( x - 1 ); }
+};
+
+template <typename T>
+struct region_coord<T, false>
+{
+	static_assert( std::numeric_limits<T>::has_infinity, "region coordinates must be integral or have an infinity" );
+
+	static constexpr T lowest( void ) { return -std::numeric_limits<T>::infinity(); }
+	static constexpr T highest( void ) { return std::numeric_limits<T>::infinity(); }
+	static constexpr T unit( void ) { return T( 0 ); }
+	static T next( T x ) { return std::nextafter( x, highest() ); }
+	static T prev( T x ) { return std::nextafter( x, lowest() ); }
+};
+
+/// horizontal edge of an input region, entering (bottom) or
+/// leaving (one past the top) the sweep
+template <typename V>
+struct region_edge
+{
+	V left, right, y;
+	int inA, inB;
+	bool out;
+
+	region_edge( V l, V r, V p, int a, int b, bool o )
+			: left( l ), right( r ), y( p ), inA( a ), inB( b ), out( o )
+	{}
+
+	bool operator<( const region_edge &o ) const { return y < o.y; }
+};
+
+/// total order on edges, so sorting gives the same result every
+/// time without needing a (buffer allocating) stable sort
+template <typename V>
+inline bool
+region_edge_order( const region_edge<V> &a, const region_edge<V> &b )
+{
+	if ( a.y != b.y )
+		return a.y < b.y;
+	if ( a.out != b.out )
+		return b.out;
+	if ( a.left != b.left )
+		return a.left < b.left;
+	if ( a.right != b.right )
+		return a.right < b.right;
+	return a.inA < b.inA;
+}
+
+/// span of the sweep line, with the count of regions from each
+/// list covering it, and the y where that coverage started
+template <typename V>
+struct region_span
+{
+	V left, right, y;
+	int inA, inB;
+
+	region_span( V l, V r, V p, int a, int b )
+			: left( l ), right( r ), y( p ), inA( a ), inB( b )
+	{}
+};
+
+/// working storage for the sweep and canonicalization
+template <typename Region>
+struct region_sweep_scratch
+{
+	typedef typename Region::value_type value_type;
+
+	std::vector<region_edge<value_type>> edges;
+	std::vector<region_span<value_type>> sweep;
+	/// the input to region_canonicalize_input
+	std::vector<Region> input;
+	std::vector<Region> regions, regions2;
+	std::vector<size_t> runs, nruns;
+};
+
+/// per thread scratch so the capacity is reused from one
+/// operation to the next
+template <typename Region>
+inline region_sweep_scratch<Region> &
+region_local_scratch( void )
+{
+	static thread_local region_sweep_scratch<Region> theScratch;
+	return theScratch;
+}
+
+/// the region covering [b, t) of a span (t being the y of the
+/// edge that ended it)
+template <typename Region>
+inline Region
+region_from_span( typename Region::value_type l,
+				  typename Region::value_type r,
+				  typename Region::value_type b,
+				  typename Region::value_type t )
+{
+	typedef region_coord<typename Region::value_type> coord;
+	typename Region::value_type nt = t;
+	if ( nt != coord::highest() )
+		nt = coord::prev( nt );
+
+	return Region( l, r, b, nt );
+}
+
+template <typename Region>
+inline void
+region_add_edges( std::vector<region_edge<typename Region::value_type>> &edges,
+				  const Region &r, int inA, int inB )
+{
+	typedef typename Region::value_type value_type;
+	typedef region_edge<value_type> edge;
+
+	if ( ! r.empty() )
+	{
+		value_type t = r.top();
+		if ( t != region_coord<value_type>::highest() )
+			t = region_coord<value_type>::next( t );
+
+		edges.push_back( edge( r.left(), r.right(), t, inA, inB, true ) );
+		edges.push_back( edge( r.left(), r.right(), r.bottom(), inA, inB, false ) );
+	}
+}
+
+template <typename Region>
+inline void
+region_add_edges( std::vector<region_edge<typename Region::value_type>> &edges,
+				  const std::vector<Region> &l, int inA, int inB )
+{
+	for ( auto i = l.begin(); i != l.end(); ++i )
+		region_add_edges( edges, *i, inA, inB );
+}
+
+template <typename Region, size_t N>
+inline void
+region_add_edges( std::vector<region_edge<typename Region::value_type>> &edges,
+				  const small_vector<Region, N> &l, int inA, int inB )
+{
+	for ( auto i = l.begin(); i != l.end(); ++i )
+		region_add_edges( edges, *i, inA, inB );
+}
+
+template <typename Region>
+inline size_t region_count( const Region & ) { return 1; }
+template <typename Region>
+inline size_t region_count( const std::vector<Region> &l ) { return l.size(); }
+template <typename Region, size_t N>
+inline size_t region_count( const small_vector<Region, N> &l ) { return l.size(); }
+
+/// joins the span at index s with the previous one if they
+/// have the same coverage, returning the (new) index of s
+template <typename V, typename Emit, typename Pred>
+inline size_t
+region_merge_sweep( Emit &emit,
+					std::vector<region_span<V>> &sweep,
+					size_t s, const Pred &op )
+{
+	auto &cur = sweep[s];
+	auto &o = sweep[s - 1];
+
+	if ( cur.inA == o.inA && cur.inB == o.inB )
+	{
+		if ( op( cur.inA, cur.inB ) )
+		{
+			// emit whichever part has been covered longer, so
+			// the merged span starts at the later y
+			if ( cur.y < o.y )
+			{
+				emit( cur.left, cur.right, cur.y, o.y );
+				cur.y = o.y;
+			}
+			else if ( cur.y > o.y )
+				emit( o.left, o.right, o.y, cur.y );
+		}
+
+		cur.left = o.left;
+		sweep.erase( sweep.begin() + static_cast<std::ptrdiff_t>( s - 1 ) );
+		return s - 1;
+	}
+	return s;
+}
+
+/// fills scratch.edges with the sorted edges of la and lb
+template <typename Region, typename A, typename B>
+inline void
+region_sweep_edges( const A &la, const B &lb, region_sweep_scratch<Region> &scratch )
+{
+	auto &edges = scratch.edges;
+	edges.clear();
+	edges.reserve( ( region_count( la ) + region_count( lb ) ) * 2 );
+	region_add_edges( edges, la, 1, 0 );
+	region_add_edges( edges, lb, 0, 1 );
+	std::sort( edges.begin(), edges.end(), region_edge_order<typename Region::value_type> );
+}
+
+/// @brief Sweep line engine behind all the region boolean operations
+///
+/// Walks the edges in scratch.edges (see region_sweep_edges) bottom
+/// to top, keeping a count of how many regions of each list cover
+/// each span of the sweep line, and calls visit( region ) whenever
+/// op( countA, countB ) stops being true for a span. The regions
+/// visited are disjoint, but not merged or sorted. If visit returns
+/// false the sweep stops there and this returns false.
+template <typename Region, typename Pred, typename Visit>
+bool
+region_sweep_run( region_sweep_scratch<Region> &scratch,
+				  const Pred &op,
+				  Visit &&visit )
+{
+	typedef typename Region::value_type value_type;
+	typedef region_span<value_type> span;
+	typedef region_coord<value_type> coord;
+	constexpr value_type neg_inf = coord::lowest();
+	constexpr value_type pos_inf = coord::highest();
+
+	const auto &edges = scratch.edges;
+	auto &sweep = scratch.sweep;
+
+	bool stopped = false;
+	auto emit = [&]( value_type l, value_type r, value_type b, value_type t )
+	{
+		if ( ! stopped && ! visit( region_from_span<Region>( l, r, b, t ) ) )
+			stopped = true;
+	};
+
+	sweep.clear();
+	sweep.push_back( span( neg_inf, pos_inf, neg_inf, 0, 0 ) );
+
+	for ( const auto &e: edges )
+	{
+		// spans are contiguous and sorted, so find the first one
+		// that touches the edge
+		size_t s = static_cast<size_t>(
+			std::lower_bound( sweep.begin(), sweep.end(), e.left,
+							  []( const span &sp, value_type x ) { return sp.right < x; } ) - sweep.begin() );
+
+		// intersect the edge with the sweep line and
+		// create any regions
+		while ( s < sweep.size() && e.right >= sweep[s].left )
+		{
+			span *cur = &sweep[s];
+			if ( op( cur->inA, cur->inB ) && cur->y < e.y )
+			{
+				emit( cur->left, cur->right, cur->y, e.y );
+				if ( stopped )
+					return false;
+				cur->y = e.y;
+			}
+
+			value_type nl = std::max( e.left, cur->left );
+			value_type nr = std::min( e.right, cur->right );
+			size_t nsplit = ( nl != cur->left ? 1 : 0 ) + ( nr != cur->right ? 1 : 0 );
+
+			if ( nsplit > 0 )
+			{
+				if ( nl != cur->left && nl == neg_inf )
+					throw std::runtime_error( "Negative infinity when trying to split edges" );
+				if ( nr != cur->right && nr == pos_inf )
+					throw std::runtime_error( "Positive infinity when trying to split edges" );
+
+				span orig = *cur;
+				sweep.insert( sweep.begin() + static_cast<std::ptrdiff_t>( s ), nsplit, orig );
+
+				// split beginning
+				if ( nl != orig.left )
+				{
+					sweep[s].right = coord::prev( nl );
+					++s;
+				}
+				sweep[s].left = nl;
+				sweep[s].right = nr;
+				// split end
+				if ( nr != orig.right )
+				{
+					sweep[s + 1].left = coord::next( nr );
+					sweep[s + 1].right = orig.right;
+				}
+				cur = &sweep[s];
+			}
+
+			// update flags
+			if ( e.out )
+			{
+				cur->inA -= e.inA;
+				cur->inB -= e.inB;
+				if ( cur->inA < 0 )
+					throw std::runtime_error( "Invalid edge count for a list" );
+				if ( cur->inB < 0 )
+					throw std::runtime_error( "Invalid edge count for b list" );
+			}
+			else
+			{
+				cur->inA += e.inA;
+				cur->inB += e.inB;
+			}
+
+			// new y
+			cur->y = e.y;
+
+			if ( s > 0 )
+			{
+				s = region_merge_sweep( emit, sweep, s, op );
+				if ( stopped )
+					return false;
+			}
+
+			++s;
+		}
+
+		// after trying to intersect, see if we can join the next edge
+		if ( s < sweep.size() )
+		{
+			region_merge_sweep( emit, sweep, s, op );
+			if ( stopped )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+/// @brief Runs the sweep over la and lb, collecting into retval
+///
+/// la and lb are each either a list or a single region, and
+/// retval may be the same as either. The output is not merged or
+/// sorted. Once the scratch and retval have grown to fit, this
+/// does not allocate.
+template <typename Region, typename List, typename A, typename B, typename Pred>
+void
+region_sweep( List &retval,
+			  const A &la,
+			  const B &lb,
+			  const Pred &op,
+			  region_sweep_scratch<Region> &scratch )
+{
+	region_sweep_edges( la, lb, scratch );
+
+	// retval may be one of the inputs, but all we need from them
+	// is in the edge list now
+	retval.clear();
+	region_sweep_run( scratch, op,
+					  [&retval]( const Region &r ) { retval.push_back( r ); return true; } );
+}
+
+
+
+////////////////////////////////////////
+// Y-X banded form
+//
+// A list of regions is in banded form when it is sorted into
+// horizontal bands (all the regions in a band share the same bottom
+// and top), the regions within a band are sorted by left and neither
+// overlap nor touch, and no two vertically adjacent bands have the
+// same set of spans (they would be merged into one band). This is the
+// same layout X11 and pixman use, and is unique for a given coverage,
+// so two banded lists cover the same area iff they are equal.
+////////////////////////////////////////
+
+
+/// returns the end of the band starting at b
+template <typename Region>
+inline const Region *
+region_band_end( const Region *b, const Region *end )
+{
+	const Region *e = b + 1;
+	while ( e != end && e->bottom() == b->bottom() )
+		++e;
+	return e;
+}
+
+/// @brief Combines the spans of two bands (either may be empty)
+/// according to pred( inA, inB ), appending the result as regions
+/// covering [yb, yt]
+///
+/// pred( false, false ) must be false
+template <typename List, typename Region, typename Pred>
+inline void
+region_band_spans( List &out,
+				   const Region *a, const Region *aend,
+				   const Region *b, const Region *bend,
+				   typename Region::value_type yb,
+				   typename Region::value_type yt,
+				   const Pred &pred )
+{
+	typedef typename Region::value_type value_type;
+	typedef region_coord<value_type> coord;
+	constexpr value_type pos_inf = coord::highest();
+
+	if ( a == aend && b == bend )
+		return;
+
+	size_t first = out.size();
+	value_type x;
+	if ( a == aend )
+		x = b->left();
+	else if ( b == bend )
+		x = a->left();
+	else
+		x = std::min( a->left(), b->left() );
+
+	while ( true )
+	{
+		while ( a != aend && a->right() < x )
+			++a;
+		while ( b != bend && b->right() < x )
+			++b;
+		if ( a == aend && b == bend )
+			break;
+
+		bool inA = a != aend && a->left() <= x;
+		bool inB = b != bend && b->left() <= x;
+
+		// inclusive end of the interval where inA and inB are constant
+		value_type e = pos_inf;
+		if ( a != aend )
+			e = std::min( e, inA ? a->right() : coord::prev( a->left() ) );
+		if ( b != bend )
+			e = std::min( e, inB ? b->right() : coord::prev( b->left() ) );
+
+		if ( pred( inA, inB ) )
+		{
+			if ( out.size() > first && out.back().right() == coord::prev( x ) )
+				out.back() = Region( out.back().left(), e, yb, yt );
+			else
+				out.push_back( Region( x, e, yb, yt ) );
+		}
+
+		if ( e == pos_inf )
+			break;
+		x = coord::next( e );
+	}
+}
+
+/// @brief If the band starting at cur is directly above the band
+/// starting at prev and has the same spans, merges it into prev
+template <typename List>
+inline void
+region_band_coalesce( List &out, size_t prev, size_t cur )
+{
+	typedef typename List::value_type Region;
+	size_t n = out.size() - cur;
+	if ( n == 0 || ( cur - prev ) != n )
+		return;
+	typedef region_coord<typename Region::value_type> coord;
+	if ( out[prev].top() == coord::highest() ||
+		 coord::next( out[prev].top() ) != out[cur].bottom() )
+		return;
+
+	for ( size_t i = 0; i != n; ++i )
+	{
+		if ( out[prev + i].left() != out[cur + i].left() ||
+			 out[prev + i].right() != out[cur + i].right() )
+			return;
+	}
+
+	auto t = out[cur].top();
+	for ( size_t i = 0; i != n; ++i )
+	{
+		const Region &p = out[prev + i];
+		out[prev + i] = Region( p.left(), p.right(), p.bottom(), t );
+	}
+	out.resize( cur );
+}
+
+/// @brief Band by band boolean operation of two lists in banded
+/// form, appending the (banded) result to out
+///
+/// Runs in time linear in the size of the inputs and output.
+/// pred( inA, inB ) decides whether an area is kept, and must be
+/// false for ( false, false ).
+template <typename List, typename Region, typename Pred>
+void
+region_band_op( List &out,
+				const Region *a, const Region *aend,
+				const Region *b, const Region *bend,
+				const Pred &pred )
+{
+	typedef typename Region::value_type value_type;
+	typedef region_coord<value_type> coord;
+	constexpr value_type neg_inf = coord::lowest();
+	constexpr value_type pos_inf = coord::highest();
+
+	const bool keepA = pred( true, false );
+	const bool keepB = pred( false, true );
+	const size_t npos = static_cast<size_t>( -1 );
+
+	size_t prevBand = npos;
+	auto emit = [&]( const Region *sa, const Region *sae, const Region *sb, const Region *sbe, value_type yb, value_type yt )
+	{
+		size_t curBand = out.size();
+		region_band_spans( out, sa, sae, sb, sbe, yb, yt, pred );
+		if ( out.size() == curBand )
+			return;
+		if ( prevBand != npos )
+			region_band_coalesce( out, prevBand, curBand );
+		if ( out.size() > curBand )
+			prevBand = curBand;
+	};
+
+	// next y that has not been processed
+	value_type ylo = neg_inf;
+	bool done = false;
+
+	while ( a != aend && b != bend )
+	{
+		const Region *ae = region_band_end( a, aend );
+		const Region *be = region_band_end( b, bend );
+		value_type ab = std::max( a->bottom(), ylo );
+		value_type bb = std::max( b->bottom(), ylo );
+		value_type t;
+
+		if ( ab < bb )
+		{
+			t = std::min( a->top(), coord::prev( bb ) );
+			if ( keepA )
+				emit( a, ae, b, b, ab, t );
+		}
+		else if ( bb < ab )
+		{
+			t = std::min( b->top(), coord::prev( ab ) );
+			if ( keepB )
+				emit( a, a, b, be, bb, t );
+		}
+		else
+		{
+			t = std::min( a->top(), b->top() );
+			emit( a, ae, b, be, ab, t );
+		}
+
+		if ( t == pos_inf )
+		{
+			done = true;
+			break;
+		}
+		ylo = coord::next( t );
+		if ( a->top() < ylo )
+			a = ae;
+		if ( b->top() < ylo )
+			b = be;
+	}
+
+	if ( done )
+		return;
+
+	if ( keepA )
+	{
+		while ( a != aend )
+		{
+			const Region *ae = region_band_end( a, aend );
+			emit( a, ae, b, b, std::max( a->bottom(), ylo ), a->top() );
+			a = ae;
+		}
+	}
+	if ( keepB )
+	{
+		while ( b != bend )
+		{
+			const Region *be = region_band_end( b, bend );
+			emit( a, a, b, be, std::max( b->bottom(), ylo ), b->top() );
+			b = be;
+		}
+	}
+}
+
+/// @brief Converts an arbitrary list of regions into banded form
+///
+/// Each region is a (trivially banded) run, runs are then unioned
+/// pairwise, bottom up like a merge sort, for O(n log n) in the
+/// number of regions (plus the size of the output). The list to
+/// convert is ss.input (which is reordered), the merges ping-pong
+/// between the two other scratch buffers, and only the result is
+/// copied to out, so a short result doesn't make out grow.
+template <typename List, typename Region>
+void
+region_canonicalize_input( List &out, region_sweep_scratch<Region> &ss )
+{
+	auto orp = []( bool inA, bool inB ) { return inA || inB; };
+
+	auto &a = ss.input;
+	a.erase( std::remove_if( a.begin(), a.end(), []( const Region &r ) { return r.empty(); } ), a.end() );
+	if ( a.size() <= 1 )
+	{
+		out.assign( a.begin(), a.end() );
+		return;
+	}
+
+	// starting the runs sorted by y means most of the early
+	// merges are between bands that don't overlap
+	std::sort( a.begin(), a.end() );
+
+	auto &runs = ss.runs;
+	auto &nruns = ss.nruns;
+	runs.clear();
+	runs.reserve( a.size() + 1 );
+	for ( size_t i = 0; i <= a.size(); ++i )
+		runs.push_back( i );
+
+	auto &src = ss.regions;
+	auto &dst = ss.regions2;
+	const Region *base = a.data();
+	while ( runs.size() > 2 )
+	{
+		dst.clear();
+		dst.reserve( a.size() );
+		nruns.clear();
+		nruns.push_back( 0 );
+
+		size_t r = 0;
+		for ( ; ( r + 2 ) < runs.size(); r += 2 )
+		{
+			region_band_op( dst,
+							base + runs[r], base + runs[r + 1],
+							base + runs[r + 1], base + runs[r + 2],
+							orp );
+			nruns.push_back( dst.size() );
+		}
+		if ( ( r + 1 ) < runs.size() )
+		{
+			dst.insert( dst.end(), base + runs[r], base + runs[r + 1] );
+			nruns.push_back( dst.size() );
+		}
+
+		src.swap( dst );
+		base = src.data();
+		runs.swap( nruns );
+	}
+	out.assign( src.begin(), src.end() );
+}
+
+/// @brief Converts a into banded form in place
+template <typename List, typename Region>
+inline void
+region_canonicalize( List &a, region_sweep_scratch<Region> &ss )
+{
+	ss.input.assign( a.begin(), a.end() );
+	region_canonicalize_input( a, ss );
+}
+
+
+////////////////////////////////////////
+
+
+/// @brief Runs region_sweep + region_canonicalize over horizontal
+/// slabs in parallel and stitches the result
+///
+/// The slab boundaries are chosen from the distribution of region
+/// bottoms so each slab has roughly the same number of input
+/// regions. The inputs are clipped to each slab, swept and
+/// canonicalized independently (each thread using its own scratch),
+/// and the slab results appended in order, joining the bands either
+/// side of a slab boundary when they have the same spans. Since the
+/// banded form is unique, the result is identical to the sequential
+/// one.
+template <typename List, typename Pred>
+void
+region_parallel_sweep( List &retval,
+					   const List &la,
+					   const List &lb,
+					   const Pred &op, size_t nslabs )
+{
+	typedef typename List::value_type Region;
+	typedef typename Region::value_type value_type;
+	typedef region_coord<value_type> coord;
+	constexpr value_type neg_inf = coord::lowest();
+	constexpr value_type pos_inf = coord::highest();
+
+	std::vector<value_type> ys;
+	ys.reserve( la.size() + lb.size() );
+	for ( const Region &r: la )
+		if ( ! r.empty() )
+			ys.push_back( r.bottom() );
+	for ( const Region &r: lb )
+		if ( ! r.empty() )
+			ys.push_back( r.bottom() );
+
+	// slab i covers [starts[i], starts[i+1] - 1]
+	std::vector<value_type> starts;
+	starts.push_back( neg_inf );
+	if ( ! ys.empty() )
+	{
+		std::sort( ys.begin(), ys.end() );
+		for ( size_t i = 1; i < nslabs; ++i )
+		{
+			value_type y = ys[( ys.size() * i ) / nslabs];
+			if ( y > starts.back() )
+				starts.push_back( y );
+		}
+	}
+
+	const size_t n = starts.size();
+	if ( n == 1 )
+	{
+		region_sweep_scratch<Region> &scratch = region_local_scratch<Region>();
+		region_sweep( scratch.input, la, lb, op, scratch );
+		region_canonicalize_input( retval, scratch );
+		return;
+	}
+
+	std::vector<List> results( n );
+	std::vector<std::exception_ptr> errors( n );
+
+	auto work = [&]( size_t i )
+	{
+		try
+		{
+			Region slab( neg_inf, pos_inf, starts[i],
+						 ( i + 1 ) < n ? coord::prev( starts[i + 1] ) : pos_inf );
+			std::vector<Region> ca, cb;
+			for ( const Region &r: la )
+			{
+				if ( r.intersects( slab ) )
+				{
+					ca.push_back( r );
+					ca.back().intersect( slab );
+				}
+			}
+			for ( const Region &r: lb )
+			{
+				if ( r.intersects( slab ) )
+				{
+					cb.push_back( r );
+					cb.back().intersect( slab );
+				}
+			}
+
+			region_sweep_scratch<Region> &scratch = region_local_scratch<Region>();
+			region_sweep( scratch.input, ca, cb, op, scratch );
+			region_canonicalize_input( results[i], scratch );
+		}
+		catch ( ... )
+		{
+			errors[i] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve( n - 1 );
+	for ( size_t i = 1; i < n; ++i )
+		threads.emplace_back( work, i );
+	work( 0 );
+	for ( auto &t: threads )
+		t.join();
+
+	for ( auto &e: errors )
+		if ( e )
+			std::rethrow_exception( e );
+
+	size_t total = 0;
+	for ( auto &r: results )
+		total += r.size();
+
+	retval.clear();
+	retval.reserve( total );
+	size_t lastBand = 0;
+	for ( auto &r: results )
+	{
+		if ( r.empty() )
+			continue;
+
+		// first band of this slab, check if it continues the last
+		// band of the previous one
+		size_t cur = retval.size();
+		const Region *rb = r.data();
+		const Region *re = rb + r.size();
+		const Region *firstEnd = region_band_end( rb, re );
+		retval.insert( retval.end(), rb, firstEnd );
+		if ( cur > 0 )
+			region_band_coalesce( retval, lastBand, cur );
+		if ( retval.size() > cur )
+			lastBand = cur;
+
+		if ( firstEnd != re )
+		{
+			retval.insert( retval.end(), firstEnd, re );
+			// find the start of the last band
+			lastBand = retval.size() - 1;
+			while ( lastBand > 0 && retval[lastBand - 1].bottom() == retval.back().bottom() )
+				--lastBand;
+		}
+	}
+}
+
+} // namespace __priv
+
+} // namespace yaco
+
+
+////////////////////////////////////////
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
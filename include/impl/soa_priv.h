@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "config.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define YACO_SOA_SSE2 1
+#endif
+#if defined(__AVX__)
+# include <immintrin.h>
+# define YACO_SOA_AVX 1
+#endif
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief The SIMD lanes the batch kernels are written against
+///
+/// A batch kernel is written once against a lane of width values
+/// and run with the widest SIMD lane the compiler targets (picked at
+/// compile time, as vector_pack does), then with the scalar lane for
+/// the last few entries. Every lane does the same operations in the
+/// same order, so the results don't depend on where the tail starts.
+template <typename T>
+struct scalar_lane
+{
+	typedef T type;
+	static constexpr size_t width = 1;
+
+	static type load( const T *p ) { return *p; }
+	static void store( T *p, type a ) { *p = a; }
+	/// unaligned
+	/// @{
+	static type loadu( const T *p ) { return *p; }
+	static void storeu( T *p, type a ) { *p = a; }
+	/// @}
+	static type set1( T s ) { return s; }
+	static type add( type a, type b ) { return a + b; }
+	static type sub( type a, type b ) { return a - b; }
+	static type mul( type a, type b ) { return a * b; }
+	static type div( type a, type b ) { return a / b; }
+	static type min( type a, type b ) { return b < a ? b : a; }
+	static type max( type a, type b ) { return a < b ? b : a; }
+	static type sqrt( type a ) { return std::sqrt( a ); }
+	/// a > b ? x : y
+	static type select_gt( type a, type b, type x, type y ) { return a > b ? x : y; }
+	/// a, negated where the sign bit of s is set
+	static type mulsign( type a, type s ) { return std::signbit( s ) ? -a : a; }
+	/// bit k set when lane k of a >= b (so never for a NaN)
+	static unsigned mask_ge( type a, type b ) { return a >= b ? 1U : 0U; }
+};
+
+template <typename T>
+struct simd_lane : public scalar_lane<T>
+{
+};
+
+#if defined(YACO_SOA_AVX)
+
+template <>
+struct simd_lane<float>
+{
+	typedef __m256 type;
+	static constexpr size_t width = 8;
+
+	static type load( const float *p ) { return _mm256_load_ps( p ); }
+	static void store( float *p, type a ) { _mm256_store_ps( p, a ); }
+	static type loadu( const float *p ) { return _mm256_loadu_ps( p ); }
+	static void storeu( float *p, type a ) { _mm256_storeu_ps( p, a ); }
+	static type set1( float s ) { return _mm256_set1_ps( s ); }
+	static type add( type a, type b ) { return _mm256_add_ps( a, b ); }
+	static type sub( type a, type b ) { return _mm256_sub_ps( a, b ); }
+	static type mul( type a, type b ) { return _mm256_mul_ps( a, b ); }
+	static type div( type a, type b ) { return _mm256_div_ps( a, b ); }
+	static type min( type a, type b ) { return _mm256_min_ps( b, a ); }
+	static type max( type a, type b ) { return _mm256_max_ps( b, a ); }
+	static type sqrt( type a ) { return _mm256_sqrt_ps( a ); }
+	static type select_gt( type a, type b, type x, type y ) { return _mm256_blendv_ps( y, x, _mm256_cmp_ps( a, b, _CMP_GT_OQ ) ); }
+	static type mulsign( type a, type s ) { return _mm256_xor_ps( a, _mm256_and_ps( s, _mm256_set1_ps( -0.0f ) ) ); }
+	static unsigned mask_ge( type a, type b ) { return unsigned( _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_GE_OQ ) ) ); }
+};
+
+template <>
+struct simd_lane<double>
+{
+	typedef __m256d type;
+	static constexpr size_t width = 4;
+
+	static type load( const double *p ) { return _mm256_load_pd( p ); }
+	static void store( double *p, type a ) { _mm256_store_pd( p, a ); }
+	static type loadu( const double *p ) { return _mm256_loadu_pd( p ); }
+	static void storeu( double *p, type a ) { _mm256_storeu_pd( p, a ); }
+	static type set1( double s ) { return _mm256_set1_pd( s ); }
+	static type add( type a, type b ) { return _mm256_add_pd( a, b ); }
+	static type sub( type a, type b ) { return _mm256_sub_pd( a, b ); }
+	static type mul( type a, type b ) { return _mm256_mul_pd( a, b ); }
+	static type div( type a, type b ) { return _mm256_div_pd( a, b ); }
+	static type min( type a, type b ) { return _mm256_min_pd( b, a ); }
+	static type max( type a, type b ) { return _mm256_max_pd( b, a ); }
+	static type sqrt( type a ) { return _mm256_sqrt_pd( a ); }
+	static type select_gt( type a, type b, type x, type y ) { return _mm256_blendv_pd( y, x, _mm256_cmp_pd( a, b, _CMP_GT_OQ ) ); }
+	static type mulsign( type a, type s ) { return _mm256_xor_pd( a, _mm256_and_pd( s, _mm256_set1_pd( -0.0 ) ) ); }
+	static unsigned mask_ge( type a, type b ) { return unsigned( _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_GE_OQ ) ) ); }
+};
+
+#elif defined(YACO_SOA_SSE2)
+
+template <>
+struct simd_lane<float>
+{
+	typedef __m128 type;
+	static constexpr size_t width = 4;
+
+	static type load( const float *p ) { return _mm_load_ps( p ); }
+	static void store( float *p, type a ) { _mm_store_ps( p, a ); }
+	static type loadu( const float *p ) { return _mm_loadu_ps( p ); }
+	static void storeu( float *p, type a ) { _mm_storeu_ps( p, a ); }
+	static type set1( float s ) { return _mm_set1_ps( s ); }
+	static type add( type a, type b ) { return _mm_add_ps( a, b ); }
+	static type sub( type a, type b ) { return _mm_sub_ps( a, b ); }
+	static type mul( type a, type b ) { return _mm_mul_ps( a, b ); }
+	static type div( type a, type b ) { return _mm_div_ps( a, b ); }
+	static type min( type a, type b ) { return _mm_min_ps( b, a ); }
+	static type max( type a, type b ) { return _mm_max_ps( b, a ); }
+	static type sqrt( type a ) { return _mm_sqrt_ps( a ); }
+	static type select_gt( type a, type b, type x, type y )
+	{
+		__m128 m = _mm_cmpgt_ps( a, b );
+		return _mm_or_ps( _mm_and_ps( m, x ), _mm_andnot_ps( m, y ) );
+	}
+	static type mulsign( type a, type s ) { return _mm_xor_ps( a, _mm_and_ps( s, _mm_set1_ps( -0.0f ) ) ); }
+	static unsigned mask_ge( type a, type b ) { return unsigned( _mm_movemask_ps( _mm_cmpge_ps( a, b ) ) ); }
+};
+
+template <>
+struct simd_lane<double>
+{
+	typedef __m128d type;
+	static constexpr size_t width = 2;
+
+	static type load( const double *p ) { return _mm_load_pd( p ); }
+	static void store( double *p, type a ) { _mm_store_pd( p, a ); }
+	static type loadu( const double *p ) { return _mm_loadu_pd( p ); }
+	static void storeu( double *p, type a ) { _mm_storeu_pd( p, a ); }
+	static type set1( double s ) { return _mm_set1_pd( s ); }
+	static type add( type a, type b ) { return _mm_add_pd( a, b ); }
+	static type sub( type a, type b ) { return _mm_sub_pd( a, b ); }
+	static type mul( type a, type b ) { return _mm_mul_pd( a, b ); }
+	static type div( type a, type b ) { return _mm_div_pd( a, b ); }
+	static type min( type a, type b ) { return _mm_min_pd( b, a ); }
+	static type max( type a, type b ) { return _mm_max_pd( b, a ); }
+	static type sqrt( type a ) { return _mm_sqrt_pd( a ); }
+	static type select_gt( type a, type b, type x, type y )
+	{
+		__m128d m = _mm_cmpgt_pd( a, b );
+		return _mm_or_pd( _mm_and_pd( m, x ), _mm_andnot_pd( m, y ) );
+	}
+	static type mulsign( type a, type s ) { return _mm_xor_pd( a, _mm_and_pd( s, _mm_set1_pd( -0.0 ) ) ); }
+	static unsigned mask_ge( type a, type b ) { return unsigned( _mm_movemask_pd( _mm_cmpge_pd( a, b ) ) ); }
+};
+
+#endif
+
+
+////////////////////////////////////////
+
+
+/// entries per piece when splitting n entries across nthreads
+/// threads (all of them when n is below parallel_min), a multiple
+/// of 64 so the aligned SIMD loads stay aligned
+inline size_t
+piece_size( size_t n, size_t nthreads, size_t parallel_min )
+{
+	if ( n < parallel_min )
+		return n;
+	if ( nthreads == 0 )
+		nthreads = std::max( 1U, std::thread::hardware_concurrency() );
+	return ( ( ( n + nthreads - 1 ) / nthreads ) + 63 ) & ~size_t( 63 );
+}
+
+inline size_t
+piece_count( size_t n, size_t chunk )
+{
+	return n == 0 ? 1 : ( n + chunk - 1 ) / chunk;
+}
+
+/// calls work( piece, begin, end ) for each chunk sized piece of
+/// [0, n), the first on the calling thread and the rest on their own
+template <typename F>
+inline void
+parallel_for( size_t n, size_t chunk, F work )
+{
+	if ( chunk >= n )
+	{
+		work( 0, 0, n );
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve( piece_count( n, chunk ) - 1 );
+	size_t piece = 1;
+	for ( size_t b = chunk; b < n; b += chunk, ++piece )
+		threads.emplace_back( work, piece, b, std::min( n, b + chunk ) );
+	work( 0, 0, chunk );
+	for ( auto &t: threads )
+		t.join();
+}
+
+} // namespace __priv
+
+} // namespace yaco
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
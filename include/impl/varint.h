@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief maps signed values to unsigned so small magnitudes of
+/// either sign are small: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+inline uint64_t
+zigzag_encode( uint64_t v )
+{
+	return ( v << 1 ) ^ ( 0 - ( v >> 63 ) );
+}
+
+inline uint64_t
+zigzag_decode( uint64_t v )
+{
+	return ( v >> 1 ) ^ ( 0 - ( v & 1 ) );
+}
+
+/// @brief appends v 7 bits at a time, low bits first, the top bit
+/// of each byte set if more follow (LEB128)
+inline void
+varint_write( std::vector<uint8_t> &out, uint64_t v )
+{
+	while ( v >= 0x80 )
+	{
+		out.push_back( uint8_t( v | 0x80 ) );
+		v >>= 7;
+	}
+	out.push_back( uint8_t( v ) );
+}
+
+/// @brief reads a value written by varint_write, advancing p
+///
+/// throws if the value runs past end or is too long for 64 bits
+inline uint64_t
+varint_read( const uint8_t *&p, const uint8_t *end )
+{
+	if ( p != end && *p < 0x80 )
+		return *p++;
+
+	uint64_t v = 0;
+	for ( unsigned shift = 0; shift < 64; shift += 7 )
+	{
+		if ( p == end )
+			throw std::runtime_error( "Truncated variable length integer" );
+		uint8_t c = *p++;
+		v |= uint64_t( c & 0x7f ) << shift;
+		if ( ! ( c & 0x80 ) )
+			return v;
+	}
+	throw std::runtime_error( "Variable length integer too long" );
+}
+
+} // namespace __priv
+
+} // namespace yaco
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
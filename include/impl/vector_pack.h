@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+
+#include "config.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define YACO_VECTOR_SSE2 1
+#endif
+#if defined(__AVX__)
+# include <immintrin.h>
+# define YACO_VECTOR_AVX 1
+#endif
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace __priv
+{
+
+/// @brief The storage and arithmetic of a math::vector, a whole
+/// vector at a time
+///
+/// type holds all the elements of a vector (in registers, for the
+/// SIMD versions), and storage is how many T a vector keeps in
+/// memory, which can be more than dim so a whole SIMD register can
+/// be loaded. The padding lanes hold unspecified values and are
+/// ignored by sum. Loads and stores don't need more than 16 byte
+/// alignment, so vectors can go in a std::vector.
+///
+/// This is the scalar version, used for the types and sizes without
+/// SIMD support.
+template <typename T, size_t dim>
+struct vector_pack
+{
+	static constexpr size_t storage = dim;
+	static constexpr size_t alignment = alignof(T);
+
+	struct type { T v[dim]; };
+
+	static type load( const T *p ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = p[i]; return r; }
+	static void store( T *p, const type &a ) { for ( size_t i = 0; i != dim; ++i ) p[i] = a.v[i]; }
+	static type set1( T s ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = s; return r; }
+
+	static type add( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = a.v[i] + b.v[i]; return r; }
+	static type sub( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = a.v[i] - b.v[i]; return r; }
+	static type mul( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = a.v[i] * b.v[i]; return r; }
+	static type div( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = a.v[i] / b.v[i]; return r; }
+	static type min( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return r; }
+	static type max( const type &a, const type &b ) { type r; for ( size_t i = 0; i != dim; ++i ) r.v[i] = a.v[i] < b.v[i] ? b.v[i] : a.v[i]; return r; }
+
+	/// sum of the dim lanes
+	static T sum( const type &a ) { T r = a.v[0]; for ( size_t i = 1; i != dim; ++i ) r += a.v[i]; return r; }
+
+	/// only for dim 3
+	static type cross( const type &a, const type &b )
+	{
+		type r;
+		r.v[0] = a.v[1] * b.v[2] - a.v[2] * b.v[1];
+		r.v[1] = a.v[2] * b.v[0] - a.v[0] * b.v[2];
+		r.v[2] = a.v[0] * b.v[1] - a.v[1] * b.v[0];
+		return r;
+	}
+};
+
+#ifdef YACO_VECTOR_SSE2
+
+/// float vectors of 2 to 4 elements all go in one __m128
+template <size_t dim>
+struct vector_pack_ps
+{
+	typedef __m128 type;
+
+	static type set1( float s ) { return _mm_set1_ps( s ); }
+	static type add( type a, type b ) { return _mm_add_ps( a, b ); }
+	static type sub( type a, type b ) { return _mm_sub_ps( a, b ); }
+	static type mul( type a, type b ) { return _mm_mul_ps( a, b ); }
+	static type div( type a, type b ) { return _mm_div_ps( a, b ); }
+	static type min( type a, type b ) { return _mm_min_ps( b, a ); }
+	static type max( type a, type b ) { return _mm_max_ps( b, a ); }
+
+	static float sum( type a )
+	{
+		// x + y, then + z and + w as needed
+		__m128 r = _mm_add_ss( a, _mm_shuffle_ps( a, a, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+		if ( dim > 2 )
+			r = _mm_add_ss( r, _mm_movehl_ps( a, a ) );
+		if ( dim > 3 )
+			r = _mm_add_ss( r, _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+		return _mm_cvtss_f32( r );
+	}
+};
+
+template <>
+struct vector_pack<float, 2> : public vector_pack_ps<2>
+{
+	static constexpr size_t storage = 2;
+	static constexpr size_t alignment = 8;
+
+	static type load( const float *p ) { return _mm_loadl_pi( _mm_setzero_ps(), reinterpret_cast<const __m64 *>( p ) ); }
+	static void store( float *p, type a ) { _mm_storel_pi( reinterpret_cast<__m64 *>( p ), a ); }
+};
+
+template <>
+struct vector_pack<float, 3> : public vector_pack_ps<3>
+{
+	static constexpr size_t storage = 4;
+	static constexpr size_t alignment = 16;
+
+	static type load( const float *p ) { return _mm_load_ps( p ); }
+	static void store( float *p, type a ) { _mm_store_ps( p, a ); }
+
+	static type cross( type a, type b )
+	{
+		// a.yzx * b.zxy - a.zxy * b.yzx
+		__m128 ayzx = _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+		__m128 bzxy = _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+		__m128 azxy = _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+		__m128 byzx = _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+		return _mm_sub_ps( _mm_mul_ps( ayzx, bzxy ), _mm_mul_ps( azxy, byzx ) );
+	}
+};
+
+template <>
+struct vector_pack<float, 4> : public vector_pack_ps<4>
+{
+	static constexpr size_t storage = 4;
+	static constexpr size_t alignment = 16;
+
+	static type load( const float *p ) { return _mm_load_ps( p ); }
+	static void store( float *p, type a ) { _mm_store_ps( p, a ); }
+};
+
+template <>
+struct vector_pack<double, 2>
+{
+	static constexpr size_t storage = 2;
+	static constexpr size_t alignment = 16;
+
+	typedef __m128d type;
+
+	static type load( const double *p ) { return _mm_load_pd( p ); }
+	static void store( double *p, type a ) { _mm_store_pd( p, a ); }
+	static type set1( double s ) { return _mm_set1_pd( s ); }
+	static type add( type a, type b ) { return _mm_add_pd( a, b ); }
+	static type sub( type a, type b ) { return _mm_sub_pd( a, b ); }
+	static type mul( type a, type b ) { return _mm_mul_pd( a, b ); }
+	static type div( type a, type b ) { return _mm_div_pd( a, b ); }
+	static type min( type a, type b ) { return _mm_min_pd( b, a ); }
+	static type max( type a, type b ) { return _mm_max_pd( b, a ); }
+	static double sum( type a ) { return _mm_cvtsd_f64( _mm_add_sd( a, _mm_unpackhi_pd( a, a ) ) ); }
+};
+
+# ifdef YACO_VECTOR_AVX
+
+/// double vectors of 3 and 4 elements go in one __m256d
+template <size_t dim>
+struct vector_pack_pd4
+{
+	static constexpr size_t storage = 4;
+	static constexpr size_t alignment = 16;
+
+	typedef __m256d type;
+
+	static type load( const double *p ) { return _mm256_loadu_pd( p ); }
+	static void store( double *p, type a ) { _mm256_storeu_pd( p, a ); }
+	static type set1( double s ) { return _mm256_set1_pd( s ); }
+	static type add( type a, type b ) { return _mm256_add_pd( a, b ); }
+	static type sub( type a, type b ) { return _mm256_sub_pd( a, b ); }
+	static type mul( type a, type b ) { return _mm256_mul_pd( a, b ); }
+	static type div( type a, type b ) { return _mm256_div_pd( a, b ); }
+	static type min( type a, type b ) { return _mm256_min_pd( b, a ); }
+	static type max( type a, type b ) { return _mm256_max_pd( b, a ); }
+
+	static double sum( type a )
+	{
+		__m128d lo = _mm256_castpd256_pd128( a );
+		__m128d hi = _mm256_extractf128_pd( a, 1 );
+		__m128d r = _mm_add_sd( lo, _mm_unpackhi_pd( lo, lo ) );
+		r = _mm_add_sd( r, hi );
+		if ( dim > 3 )
+			r = _mm_add_sd( r, _mm_unpackhi_pd( hi, hi ) );
+		return _mm_cvtsd_f64( r );
+	}
+};
+
+# else
+
+/// double vectors of 3 and 4 elements as a pair of __m128d
+template <size_t dim>
+struct vector_pack_pd4
+{
+	static constexpr size_t storage = 4;
+	static constexpr size_t alignment = 16;
+
+	struct type { __m128d lo, hi; };
+
+	static type load( const double *p ) { return type{ _mm_load_pd( p ), _mm_load_pd( p + 2 ) }; }
+	static void store( double *p, const type &a ) { _mm_store_pd( p, a.lo ); _mm_store_pd( p + 2, a.hi ); }
+	static type set1( double s ) { __m128d v = _mm_set1_pd( s ); return type{ v, v }; }
+	static type add( const type &a, const type &b ) { return type{ _mm_add_pd( a.lo, b.lo ), _mm_add_pd( a.hi, b.hi ) }; }
+	static type sub( const type &a, const type &b ) { return type{ _mm_sub_pd( a.lo, b.lo ), _mm_sub_pd( a.hi, b.hi ) }; }
+	static type mul( const type &a, const type &b ) { return type{ _mm_mul_pd( a.lo, b.lo ), _mm_mul_pd( a.hi, b.hi ) }; }
+	static type div( const type &a, const type &b ) { return type{ _mm_div_pd( a.lo, b.lo ), _mm_div_pd( a.hi, b.hi ) }; }
+	static type min( const type &a, const type &b ) { return type{ _mm_min_pd( b.lo, a.lo ), _mm_min_pd( b.hi, a.hi ) }; }
+	static type max( const type &a, const type &b ) { return type{ _mm_max_pd( b.lo, a.lo ), _mm_max_pd( b.hi, a.hi ) }; }
+
+	static double sum( const type &a )
+	{
+		__m128d r = _mm_add_sd( a.lo, _mm_unpackhi_pd( a.lo, a.lo ) );
+		r = _mm_add_sd( r, a.hi );
+		if ( dim > 3 )
+			r = _mm_add_sd( r, _mm_unpackhi_pd( a.hi, a.hi ) );
+		return _mm_cvtsd_f64( r );
+	}
+};
+
+# endif
+
+template <>
+struct vector_pack<double, 3> : public vector_pack_pd4<3>
+{
+	static type cross( const type &a, const type &b )
+	{
+		alignas(16) double x[4], y[4];
+		store( x, a );
+		store( y, b );
+		alignas(16) double r[4] = {
+			x[1] * y[2] - x[2] * y[1],
+			x[2] * y[0] - x[0] * y[2],
+			x[0] * y[1] - x[1] * y[0],
+			0.0 };
+		return load( r );
+	}
+};
+
+template <>
+struct vector_pack<double, 4> : public vector_pack_pd4<4>
+{
+};
+
+#endif // YACO_VECTOR_SSE2
+
+} // namespace __priv
+
+} // namespace yaco
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+#include "impl/config.h"
+
+namespace yaco
+{
+
+/// @brief Accumulated statistics for all locks sharing a name
+///
+/// Hold times are recorded in a log2 histogram of nanoseconds,
+/// bucket i counting holds in [2^i, 2^(i+1)) ns (bucket 0 also
+/// takes holds under 1ns).
+struct lock_stats
+{
+	static const size_t histogram_buckets = 40;
+
+	explicit lock_stats( const std::string &n );
+
+	const std::string name;
+	std::atomic<uint64_t> acquisitions;
+	std::atomic<uint64_t> contended;
+	std::atomic<uint64_t> wait_ns;
+	std::atomic<uint64_t> hold_ns;
+	std::atomic<uint64_t> hold_histogram[histogram_buckets];
+
+	void reset( void );
+
+	void record_hold( uint64_t ns )
+	{
+		size_t b = 0;
+		while ( ns > 1 && b < ( histogram_buckets - 1 ) )
+		{
+			ns >>= 1;
+			++b;
+		}
+		hold_histogram[b].fetch_add( 1, std::memory_order_relaxed );
+	}
+};
+
+/// @brief Plain copy of a lock_stats, suitable for reporting
+struct lock_profile_entry
+{
+	std::string name;
+	uint64_t acquisitions;
+	uint64_t contended;
+	uint64_t wait_ns;
+	uint64_t hold_ns;
+	std::vector<uint64_t> hold_histogram;
+};
+
+/// @brief Returns the (shared) statistics block for a given lock name,
+/// creating it if this is the first lock with that name
+std::shared_ptr<lock_stats> register_lock_stats( const std::string &name );
+
+/// @brief Returns a copy of all the registered lock statistics, sorted
+/// by total time spent waiting (descending), so the locks most
+/// likely to be serializing the program come first
+std::vector<lock_profile_entry> lock_profile_snapshot( void );
+
+/// @brief Writes a human readable table of lock_profile_snapshot
+void dump_lock_profile( std::ostream &out );
+
+/// @brief Zeros all the registered counters, to profile a specific
+/// portion of a run
+void reset_lock_profile( void );
+
+/// @brief Wraps a mutex, recording usage statistics under a name
+///
+/// Records the number of acquisitions, how many of those had to
+/// wait (the try_lock fast path failed), total time spent waiting,
+/// and a histogram of how long the lock was held. All locks created
+/// with the same name contribute to the same statistics, so one
+/// can tag, for example, all the per-object locks of a class.
+///
+/// Satisfies the same Lockable requirements as the wrapped mutex, so
+/// can be used with std::lock_guard, std::unique_lock, unlock_guard
+/// and as the mutex of a locked_queue.
+template <typename Mutex = std::mutex>
+class profiled_mutex
+{
+public:
+	typedef Mutex mutex_type;
+	typedef std::chrono::steady_clock clock;
+
+	explicit profiled_mutex( const std::string &name )
+			: myStats( register_lock_stats( name ) )
+	{
+	}
+
+	void lock( void )
+	{
+		if ( ! myMutex.try_lock() )
+		{
+			clock::time_point start = clock::now();
+			myMutex.lock();
+			myAcquired = clock::now();
+			myStats->contended.fetch_add( 1, std::memory_order_relaxed );
+			myStats->wait_ns.fetch_add( elapsed( start, myAcquired ), std::memory_order_relaxed );
+		}
+		else
+			myAcquired = clock::now();
+		myStats->acquisitions.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	bool try_lock( void )
+	{
+		if ( myMutex.try_lock() )
+		{
+			myAcquired = clock::now();
+			myStats->acquisitions.fetch_add( 1, std::memory_order_relaxed );
+			return true;
+		}
+		return false;
+	}
+
+	void unlock( void )
+	{
+		uint64_t held = elapsed( myAcquired, clock::now() );
+		myMutex.unlock();
+		myStats->hold_ns.fetch_add( held, std::memory_order_relaxed );
+		myStats->record_hold( held );
+	}
+
+	const lock_stats &stats( void ) const { return *myStats; }
+	mutex_type &native( void ) { return myMutex; }
+
+private:
+	profiled_mutex( const profiled_mutex & ) = delete;
+	profiled_mutex &operator=( const profiled_mutex & ) = delete;
+
+	static uint64_t elapsed( clock::time_point a, clock::time_point b )
+	{
+		return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( b - a ).count() );
+	}
+
+	mutex_type myMutex;
+	// only touched while myMutex is held
+	clock::time_point myAcquired;
+	std::shared_ptr<lock_stats> myStats;
+};
+
+} // namespace yaco
+
+
+////////////////////////////////////////
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -24,7 +24,10 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <type_traits>
 #include <stdexcept>
+#include <deque>
+#include <utility>
 
 
 ////////////////////////////////////////
@@ -39,49 +42,61 @@ namespace yaco
 /// some of the functions similar to std::deque.
 /// As an exception, one can swap two locked_queues safely, but not
 /// using std::swap
-template <typename T>
+///
+/// The mutex type can be changed (i.e. to a profiled_mutex), in which
+/// case a std::condition_variable_any is used for the blocking pop.
+template <typename T, typename Mutex = std::mutex>
 class locked_queue
 {
 public:
 	typedef T entry_type;
+	typedef Mutex mutex_type;
 
 	locked_queue( void ) {}
+	/// arguments are passed to the mutex constructor
+	template <typename Arg, typename... Args>
+	explicit locked_queue( Arg &&a, Args &&... args )
+			: myLock( std::forward<Arg>( a ), std::forward<Args>( args )... )
+	{}
 	~locked_queue( void ) {}
 
 	void push( const entry_type &e )
 	{
-		std::lock_guard<std::mutex> sg( myLock );
-		myEntries.push_back( e );
+		{
+			std::lock_guard<mutex_type> sg( myLock );
+			myEntries.push_back( e );
+		}
+		myCond.notify_one();
 	}
 	
 	void push( entry_type &&e )
 	{
-		std::lock_guard<std::mutex> sg( myLock );
-		myEntries.emplace_back( std::move( e ) );
+		{
+			std::lock_guard<mutex_type> sg( myLock );
+			myEntries.emplace_back( std::move( e ) );
+		}
+		myCond.notify_one();
 	}
 
 	entry_type pop( void )
 	{
-		std::unique_lock<std::mutex> sg( myLock );
+		std::unique_lock<mutex_type> sg( myLock );
 
 		// does every compiler we care about have lambda functions?
 //		myCond.wait( sg, [this](){ return !myEntries.empty(); } );
 		while ( myEntries.empty() )
 			myCond.wait( sg );
 
-		// function scope, not global, but if contained
-		// element is more complex and has a specific swap
-		// override or move semantics, will be more efficient
-		using std::swap;
-		entry_type ret;
-		swap( myEntries.front(), ret );
+		// move construct, so a default constructed scalar is never
+		// left uninitialized, and heavier elements aren't copied
+		entry_type ret( std::move( myEntries.front() ) );
 		myEntries.pop_front();
 		return ret;
 	}
 
 	entry_type try_pop( const entry_type &emptyVal = entry_type() )
 	{
-		std::lock_guard<std::mutex> sg( myLock );
+		std::lock_guard<mutex_type> sg( myLock );
 
 		// function scope, not global, but if contained
 		// element is more complex and has a specific swap
@@ -98,21 +113,21 @@ public:
 		return ret;
 	}
 
-	bool clear( void ) const
+	void clear( void )
 	{
-		std::lock_guard<std::mutex> sg( myLock );
-		return myEntries.clear();
+		std::lock_guard<mutex_type> sg( myLock );
+		myEntries.clear();
 	}
 
 	bool empty( void ) const
 	{
-		std::lock_guard<std::mutex> sg( myLock );
+		std::lock_guard<mutex_type> sg( myLock );
 		return myEntries.empty();
 	}
 
 	size_t size( void ) const
 	{
-		std::lock_guard<std::mutex> sg( myLock );
+		std::lock_guard<mutex_type> sg( myLock );
 		return myEntries.size();
 	}
 
@@ -121,8 +136,8 @@ public:
 		if ( &o == this )
 			throw std::logic_error( "attempt to swap locked_queue with itself" );
 
-		std::lock_guard<std::mutex> sg( myLock );
-		std::lock_guard<std::mutex> so( o.myLock );
+		std::lock_guard<mutex_type> sg( myLock );
+		std::lock_guard<mutex_type> so( o.myLock );
 		myEntries.swap( o.myEntries );
 	}
 
@@ -133,13 +148,17 @@ public:
 	locked_queue &operator=( locked_queue && ) = delete;
 private:
 
-	std::condition_variable myCond;
-	std::mutex myLock;
+	typedef typename std::conditional<std::is_same<mutex_type, std::mutex>::value,
+									  std::condition_variable,
+									  std::condition_variable_any>::type cond_type;
+
+	cond_type myCond;
+	mutable mutex_type myLock;
 	std::deque<entry_type> myEntries;
 };
 
-template <typename T>
-swap( locked_queue<T> &x, locked_queue<T> &y )
+template <typename T, typename M>
+void swap( locked_queue<T, M> &x, locked_queue<T, M> &y )
 {
 	x.swap( y );
 }
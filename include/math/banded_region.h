@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <initializer_list>
+
+#include "region.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief A set of pixels kept in canonical Y-X banded form
+///
+/// The rectangles are stored sorted into horizontal bands (same
+/// bottom and top), with disjoint, non-touching spans sorted left to
+/// right within a band and no two adjacent bands with the same spans
+/// (see canonicalize). Because both operands are already in this
+/// form, the boolean operations merge them band by band in time
+/// linear in the size of the inputs, without the sort the
+/// region_list operators have to do, so many operations can be
+/// chained cheaply. The form is unique, so comparison is exact
+/// coverage equality.
+class banded_region
+{
+public:
+	typedef region::value_type value_type;
+	typedef region_list::const_iterator const_iterator;
+
+	banded_region( void ) {}
+	banded_region( const region &r ) { if ( ! r.empty() ) myRects.push_back( r ); }
+	/// converts an arbitrary list, in O(n log n)
+	explicit banded_region( region_list l ) : myRects( std::move( l ) ) { canonicalize( myRects ); }
+	banded_region( std::initializer_list<region> l ) : myRects( l ) { canonicalize( myRects ); }
+
+	bool empty( void ) const { return myRects.empty(); }
+	size_t size( void ) const { return myRects.size(); }
+	void clear( void ) { myRects.clear(); }
+	void swap( banded_region &o ) { myRects.swap( o.myRects ); }
+
+	const_iterator begin( void ) const { return myRects.begin(); }
+	const_iterator end( void ) const { return myRects.end(); }
+	const region &operator[]( size_t i ) const { return myRects[i]; }
+
+	/// the rectangles, in banded order
+	const region_list &rects( void ) const { return myRects; }
+	/// same as rects, for symmetry with the constructor
+	region_list to_list( void ) const { return myRects; }
+
+	/// @brief smallest region containing everything
+	region bounds( void ) const;
+
+	/// @brief number of bands
+	size_t band_count( void ) const;
+
+	/// @brief point query, O(log n)
+	bool contains( value_type x, value_type y ) const;
+
+	bool operator==( const banded_region &o ) const { return myRects == o.myRects; }
+	bool operator!=( const banded_region &o ) const { return myRects != o.myRects; }
+
+	banded_region &operator&=( const banded_region &o );
+	banded_region &operator|=( const banded_region &o );
+	banded_region &operator^=( const banded_region &o );
+	/// removes o from this
+	banded_region &subtract( const banded_region &o );
+
+	/// @brief Wraps a list that is known to already be in banded form
+	/// (i.e. the result of canonicalize or of the region_list
+	/// operators) without re-sorting it. This is not checked.
+	static banded_region adopt( region_list l );
+
+private:
+	region_list myRects;
+};
+
+std::ostream &operator<<( std::ostream &out, const banded_region &r );
+
+/// Same semantics as the region_list operators, but linear time
+/// since the operands are already banded. A region converts
+/// implicitly to a banded_region.
+/// @{
+banded_region operator&( const banded_region &a, const banded_region &b );
+banded_region operator|( const banded_region &a, const banded_region &b );
+banded_region operator^( const banded_region &a, const banded_region &b );
+banded_region operator~( const banded_region &a );
+banded_region not_in( const banded_region &a, const banded_region &b );
+/// @}
+
+inline void swap( banded_region &a, banded_region &b ) { a.swap( b ); }
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -0,0 +1,386 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "../variadic.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Fixed size vector whose arithmetic can be done in a
+/// constant expression
+///
+/// vector keeps its values in SIMD registers and loops over them,
+/// none of which the compiler can evaluate while compiling, so this
+/// is the compile time counterpart, a plain aggregate that the
+/// constexpr functions below build a new one of for every
+/// operation. The result is turned into a vector (in a constant
+/// expression as well) once it is computed:
+///
+/// constexpr fvec3 up = fvec3( cross( const_fvec3{ { 1, 0, 0 } }, const_fvec3{ { 0, 1, 0 } } ) );
+template <typename T, size_t dim>
+struct const_vector
+{
+	static_assert( dim > 0, "vector dimension of 0 is non-sensical" );
+
+	typedef T value_type;
+	static const size_t size = dim;
+
+	constexpr value_type operator[]( size_t i ) const { return v[i]; }
+	constexpr value_type at( size_t i ) const { return i < dim ? v[i] : throw std::out_of_range( "vector index out of range" ); }
+
+	T v[dim];
+};
+
+/// @brief Fixed size matrix whose arithmetic can be done in a
+/// constant expression
+///
+/// Stored column major, as square_matrix is, and converts to one
+/// the same way a const_vector converts to a vector. The values are
+/// written as the columns when initialized as an aggregate, use
+/// from_rows to write them out a row at a time:
+///
+/// constexpr fmat3 toXYZ = fmat3( inverse( const_fmat3::from_rows( ... ) ) );
+template <typename T, size_t dim>
+struct const_matrix
+{
+	static_assert( dim > 0, "matrix dimension of 0 is non-sensical" );
+
+	typedef T value_type;
+	typedef const_vector<T, dim> vector_type;
+	static const size_t size = dim;
+
+	static constexpr const_matrix identity( void )
+	{
+		return make_identity( typename gen_sequence<dim * dim>::type() );
+	}
+	/// the values a row at a time, there must be dim x dim of them
+	template <typename... V>
+	static constexpr const_matrix from_rows( V... vals )
+	{
+		static_assert( sizeof...(V) == dim * dim, "from_rows needs every value of the matrix" );
+		return transposed( const_matrix{ { T( vals )... } }, typename gen_sequence<dim * dim>::type() );
+	}
+
+	constexpr value_type operator()( size_t row, size_t col ) const { return v[col * dim + row]; }
+	constexpr value_type at( size_t row, size_t col ) const
+	{
+		return row < dim && col < dim ? v[col * dim + row] : throw std::out_of_range( "matrix index out of range" );
+	}
+
+	T v[dim * dim];
+
+private:
+	template <size_t... I>
+	static constexpr const_matrix make_identity( unpack_sequence<I...> )
+	{
+		return const_matrix{ { T( I % ( dim + 1 ) == 0 ? 1 : 0 )... } };
+	}
+	template <size_t... I>
+	static constexpr const_matrix transposed( const const_matrix &r, unpack_sequence<I...> )
+	{
+		return const_matrix{ { r.v[( I % dim ) * dim + I / dim]... } };
+	}
+};
+
+template <typename T, size_t dim>
+const size_t const_vector<T, dim>::size;
+template <typename T, size_t dim>
+const size_t const_matrix<T, dim>::size;
+
+
+////////////////////////////////////////
+
+
+}
+
+namespace __priv
+{
+
+// C++11 constexpr functions are a single return, so everything is
+// written as a pack expansion over the element indices, with sums
+// added up left to right the way the loops in vector and
+// square_matrix do
+
+template <typename T>
+constexpr T const_sum( T a ) { return a; }
+template <typename T, typename... R>
+constexpr T const_sum( T a, T b, R... r ) { return const_sum( T( a + b ), r... ); }
+
+constexpr bool const_all( void ) { return true; }
+template <typename... R>
+constexpr bool const_all( bool a, R... r ) { return a && const_all( r... ); }
+
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> vec_add( const math::const_vector<T, dim> &a, const math::const_vector<T, dim> &b, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { T( a.v[I] + b.v[I] )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> vec_sub( const math::const_vector<T, dim> &a, const math::const_vector<T, dim> &b, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { T( a.v[I] - b.v[I] )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> vec_neg( const math::const_vector<T, dim> &a, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { T( -a.v[I] )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> vec_mul( const math::const_vector<T, dim> &a, T s, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { T( a.v[I] * s )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> vec_div( const math::const_vector<T, dim> &a, T s, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { T( a.v[I] / s )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr T vec_dot( const math::const_vector<T, dim> &a, const math::const_vector<T, dim> &b, unpack_sequence<I...> )
+{ return const_sum( T( a.v[I] * b.v[I] )... ); }
+template <typename T, size_t dim, size_t... I>
+constexpr bool vec_equal( const math::const_vector<T, dim> &a, const math::const_vector<T, dim> &b, unpack_sequence<I...> )
+{ return const_all( a.v[I] == b.v[I]... ); }
+
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim> mat_add( const math::const_matrix<T, dim> &a, const math::const_matrix<T, dim> &b, unpack_sequence<I...> )
+{ return math::const_matrix<T, dim>{ { T( a.v[I] + b.v[I] )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim> mat_sub( const math::const_matrix<T, dim> &a, const math::const_matrix<T, dim> &b, unpack_sequence<I...> )
+{ return math::const_matrix<T, dim>{ { T( a.v[I] - b.v[I] )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim> mat_scale( const math::const_matrix<T, dim> &a, T s, unpack_sequence<I...> )
+{ return math::const_matrix<T, dim>{ { T( a.v[I] * s )... } }; }
+template <typename T, size_t dim, size_t... I>
+constexpr bool mat_equal( const math::const_matrix<T, dim> &a, const math::const_matrix<T, dim> &b, unpack_sequence<I...> )
+{ return const_all( a.v[I] == b.v[I]... ); }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim> mat_transpose( const math::const_matrix<T, dim> &a, unpack_sequence<I...> )
+{ return math::const_matrix<T, dim>{ { a.v[( I % dim ) * dim + I / dim]... } }; }
+
+template <typename T, size_t dim, size_t... K>
+constexpr T mat_mul_elem( const math::const_matrix<T, dim> &a, const math::const_matrix<T, dim> &b, size_t r, size_t c, unpack_sequence<K...> )
+{ return const_sum( T( a( r, K ) * b( K, c ) )... ); }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim> mat_mul( const math::const_matrix<T, dim> &a, const math::const_matrix<T, dim> &b, unpack_sequence<I...> )
+{ return math::const_matrix<T, dim>{ { mat_mul_elem( a, b, I % dim, I / dim, typename gen_sequence<dim>::type() )... } }; }
+
+template <typename T, size_t dim, size_t... K>
+constexpr T mat_vec_elem( const math::const_matrix<T, dim> &m, const math::const_vector<T, dim> &v, size_t r, unpack_sequence<K...> )
+{ return const_sum( T( m( r, K ) * v.v[K] )... ); }
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_vector<T, dim> mat_vec( const math::const_matrix<T, dim> &m, const math::const_vector<T, dim> &v, unpack_sequence<I...> )
+{ return math::const_vector<T, dim>{ { mat_vec_elem( m, v, I, typename gen_sequence<dim>::type() )... } }; }
+
+/// m without row r and column c
+template <typename T, size_t dim, size_t... I>
+constexpr math::const_matrix<T, dim - 1> mat_minor( const math::const_matrix<T, dim> &m, size_t r, size_t c, unpack_sequence<I...> )
+{
+	return math::const_matrix<T, dim - 1>{ { m( I % ( dim - 1 ) + ( I % ( dim - 1 ) >= r ? 1 : 0 ),
+										  I / ( dim - 1 ) + ( I / ( dim - 1 ) >= c ? 1 : 0 ) )... } };
+}
+
+/// expands the determinant along the top row
+template <typename T, size_t dim>
+struct const_det
+{
+	static constexpr T cofactor( const math::const_matrix<T, dim> &m, size_t r, size_t c )
+	{
+		return T( ( r + c ) % 2 ? -1 : 1 ) *
+			const_det<T, dim - 1>::eval( mat_minor( m, r, c, typename gen_sequence<( dim - 1 ) * ( dim - 1 )>::type() ) );
+	}
+	template <size_t... K>
+	static constexpr T expand( const math::const_matrix<T, dim> &m, unpack_sequence<K...> )
+	{
+		return const_sum( T( m( 0, K ) * cofactor( m, 0, K ) )... );
+	}
+	static constexpr T eval( const math::const_matrix<T, dim> &m )
+	{
+		return expand( m, typename gen_sequence<dim>::type() );
+	}
+};
+
+template <typename T>
+struct const_det<T, 2>
+{
+	static constexpr T eval( const math::const_matrix<T, 2> &m )
+	{
+		return T( m( 0, 0 ) * m( 1, 1 ) - m( 0, 1 ) * m( 1, 0 ) );
+	}
+};
+
+template <typename T>
+struct const_det<T, 1>
+{
+	static constexpr T cofactor( const math::const_matrix<T, 1> &, size_t, size_t ) { return T( 1 ); }
+	static constexpr T eval( const math::const_matrix<T, 1> &m ) { return m.v[0]; }
+};
+
+template <typename T, size_t dim>
+struct const_adjugate
+{
+	/// the transpose of the cofactors, divided by d
+	template <size_t... I>
+	static constexpr math::const_matrix<T, dim> eval( const math::const_matrix<T, dim> &m, T d, unpack_sequence<I...> )
+	{
+		return math::const_matrix<T, dim>{ { T( cofactor( m, I / dim, I % dim ) / d )... } };
+	}
+	static constexpr T cofactor( const math::const_matrix<T, dim> &m, size_t r, size_t c )
+	{
+		return const_det<T, dim>::cofactor( m, r, c );
+	}
+};
+
+template <typename T>
+struct const_adjugate<T, 2>
+{
+	template <size_t... I>
+	static constexpr math::const_matrix<T, 2> eval( const math::const_matrix<T, 2> &m, T d, unpack_sequence<I...> )
+	{
+		return math::const_matrix<T, 2>{ { T( m.v[3] / d ), T( -m.v[1] / d ), T( -m.v[2] / d ), T( m.v[0] / d ) } };
+	}
+};
+
+template <typename T, size_t dim>
+constexpr math::const_matrix<T, dim> mat_inverse( const math::const_matrix<T, dim> &m, T d )
+{
+	return d == T( 0 ) ? throw std::runtime_error( "Unable to invert singular matrix" ) :
+		const_adjugate<T, dim>::eval( m, d, typename gen_sequence<dim * dim>::type() );
+}
+
+} // namespace __priv
+
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator+( const const_vector<T, dim> &a, const const_vector<T, dim> &b )
+{ return __priv::vec_add( a, b, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator-( const const_vector<T, dim> &a, const const_vector<T, dim> &b )
+{ return __priv::vec_sub( a, b, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator-( const const_vector<T, dim> &a )
+{ return __priv::vec_neg( a, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator*( const const_vector<T, dim> &a, T s )
+{ return __priv::vec_mul( a, s, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator*( T s, const const_vector<T, dim> &a )
+{ return __priv::vec_mul( a, s, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator/( const const_vector<T, dim> &a, T s )
+{ return __priv::vec_div( a, s, typename gen_sequence<dim>::type() ); }
+
+template <typename T, size_t dim>
+constexpr bool operator==( const const_vector<T, dim> &a, const const_vector<T, dim> &b )
+{ return __priv::vec_equal( a, b, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr bool operator!=( const const_vector<T, dim> &a, const const_vector<T, dim> &b )
+{ return !( a == b ); }
+
+template <typename T, size_t dim>
+constexpr T dot( const const_vector<T, dim> &a, const const_vector<T, dim> &b )
+{ return __priv::vec_dot( a, b, typename gen_sequence<dim>::type() ); }
+template <typename T, size_t dim>
+constexpr T mag_squared( const const_vector<T, dim> &a )
+{ return dot( a, a ); }
+template <typename T>
+constexpr const_vector<T, 3> cross( const const_vector<T, 3> &a, const const_vector<T, 3> &b )
+{
+	return const_vector<T, 3>{ { T( a.v[1] * b.v[2] - a.v[2] * b.v[1] ),
+								 T( a.v[2] * b.v[0] - a.v[0] * b.v[2] ),
+								 T( a.v[0] * b.v[1] - a.v[1] * b.v[0] ) } };
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> operator+( const const_matrix<T, dim> &a, const const_matrix<T, dim> &b )
+{ return __priv::mat_add( a, b, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> operator-( const const_matrix<T, dim> &a, const const_matrix<T, dim> &b )
+{ return __priv::mat_sub( a, b, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> operator*( const const_matrix<T, dim> &a, T s )
+{ return __priv::mat_scale( a, s, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> operator*( T s, const const_matrix<T, dim> &a )
+{ return __priv::mat_scale( a, s, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> operator*( const const_matrix<T, dim> &a, const const_matrix<T, dim> &b )
+{ return __priv::mat_mul( a, b, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr const_vector<T, dim> operator*( const const_matrix<T, dim> &m, const const_vector<T, dim> &v )
+{ return __priv::mat_vec( m, v, typename gen_sequence<dim>::type() ); }
+
+template <typename T, size_t dim>
+constexpr bool operator==( const const_matrix<T, dim> &a, const const_matrix<T, dim> &b )
+{ return __priv::mat_equal( a, b, typename gen_sequence<dim * dim>::type() ); }
+template <typename T, size_t dim>
+constexpr bool operator!=( const const_matrix<T, dim> &a, const const_matrix<T, dim> &b )
+{ return !( a == b ); }
+
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> transpose( const const_matrix<T, dim> &m )
+{ return __priv::mat_transpose( m, typename gen_sequence<dim * dim>::type() ); }
+
+/// by cofactor expansion, which is fine for the sizes of matrix
+/// this is meant for (and there's no cost to it at run time)
+template <typename T, size_t dim>
+constexpr T determinant( const const_matrix<T, dim> &m )
+{ return __priv::const_det<T, dim>::eval( m ); }
+
+/// the adjugate over the determinant, throwing std::runtime_error
+/// (which fails the compile in a constant expression) when the
+/// matrix is singular
+template <typename T, size_t dim>
+constexpr const_matrix<T, dim> inverse( const const_matrix<T, dim> &m )
+{ return __priv::mat_inverse( m, determinant( m ) ); }
+
+typedef const_vector<float, 2> const_fvec2;
+typedef const_vector<float, 3> const_fvec3;
+typedef const_vector<float, 4> const_fvec4;
+typedef const_vector<double, 2> const_vec2;
+typedef const_vector<double, 3> const_vec3;
+typedef const_vector<double, 4> const_vec4;
+
+typedef const_matrix<float, 2> const_fmat2;
+typedef const_matrix<float, 3> const_fmat3;
+typedef const_matrix<float, 4> const_fmat4;
+typedef const_matrix<double, 2> const_mat2;
+typedef const_matrix<double, 3> const_mat3;
+typedef const_matrix<double, 4> const_mat4;
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "region.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Collects dirty rectangles, keeping the list small
+///
+/// Meant to replace repeatedly or-ing rectangles into a region_list
+/// every frame. Added rectangles are buffered and folded into the
+/// list in batches (each time the buffer grows as large as the
+/// already processed list), so an add costs amortized O(log n). A
+/// batch drops rectangles covered by another one and joins pairs
+/// whose union is exactly a rectangle. The result is not disjoint:
+/// rectangles may still overlap, it only guarantees to cover
+/// everything added.
+///
+/// If a maximum rectangle count is set, it is enforced by replacing
+/// nearby pairs with their bounding box, cheapest first, where the
+/// cost is the area the box covers that neither rectangle did. The
+/// total of that cost is reported by overdraw_area, so callers can
+/// choose how much precision to trade for fewer, larger rectangles.
+///
+/// rects, size and overdraw_area flush the pending batch, so unlike
+/// most const members they modify the object: an accumulator shared
+/// between threads needs external locking even for const access.
+class damage_accumulator
+{
+public:
+	/// max_rects of 0 means no limit
+	explicit damage_accumulator( size_t max_rects = 0 ) : myMax( max_rects ) {}
+
+	/// takes effect at the next flush
+	void set_max_rects( size_t m ) { myMax = m; }
+	size_t max_rects( void ) const { return myMax; }
+
+	void add( const region &r );
+	void add( const region_list &l );
+	damage_accumulator &operator|=( const region &r ) { add( r ); return *this; }
+	damage_accumulator &operator|=( const region_list &l ) { add( l ); return *this; }
+
+	void clear( void );
+	bool empty( void ) const { return myRects.empty(); }
+
+	/// @brief processes any buffered rectangles now
+	///
+	/// const because it does not change what the accumulator covers,
+	/// but it rewrites the internal list (see the class notes on
+	/// threads)
+	void flush( void ) const;
+
+	/// @brief the damaged area, flushed
+	const region_list &rects( void ) const { flush(); return myRects; }
+	size_t size( void ) const { flush(); return myRects.size(); }
+
+	/// @brief returns the rectangles and resets the accumulator
+	region_list take( void );
+
+	/// @brief smallest region containing everything added
+	const region &bounds( void ) const { return myBounds; }
+
+	/// @brief sum of the areas of rects(), i.e. what it costs to
+	/// repaint them (overlapping areas are counted twice)
+	double area( void ) const;
+
+	/// @brief area added by coalescing to honor max_rects, since the
+	/// last clear
+	///
+	/// Each merge counts the area of the bounding box not covered by
+	/// either rectangle of the pair, so this is an upper bound on
+	/// the extra, undamaged, area being repainted.
+	double overdraw_area( void ) const { flush(); return myOverdraw; }
+
+private:
+	mutable region_list myRects;
+	// myRects[0, myClean) has been processed
+	mutable size_t myClean = 0;
+	mutable double myOverdraw = 0.0;
+	region myBounds;
+	size_t myMax;
+};
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "../impl/aligned_allocator.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief A dense matrix whose size is set at run time
+///
+/// Elements are stored row major, each row directly after the
+/// previous one. The products (gemm, gemv and operator*) are
+/// provided for float and double; the rest works for any arithmetic
+/// type. Size mismatches throw std::invalid_argument.
+template <typename T>
+class dense_matrix
+{
+public:
+	typedef T value_type;
+	typedef std::vector<T, __priv::aligned_allocator<T, 32>> array_type;
+
+	dense_matrix( void ) : myRows( 0 ), myCols( 0 ) {}
+	dense_matrix( size_t rows, size_t cols, T fill = T( 0 ) )
+		: myRows( rows ), myCols( cols ), myV( rows * cols, fill )
+	{
+	}
+	/// values are given row by row, as written
+	dense_matrix( size_t rows, size_t cols, std::initializer_list<T> values )
+		: myRows( rows ), myCols( cols ), myV( values.begin(), values.end() )
+	{
+		if ( values.size() != rows * cols )
+			throw std::invalid_argument( "dense_matrix initializer size mismatch" );
+	}
+
+	static dense_matrix identity( size_t n )
+	{
+		dense_matrix r( n, n );
+		for ( size_t i = 0; i != n; ++i )
+			r( i, i ) = T( 1 );
+		return r;
+	}
+
+	size_t rows( void ) const { return myRows; }
+	size_t cols( void ) const { return myCols; }
+	bool empty( void ) const { return myV.empty(); }
+
+	/// resizes to rows x cols, with every element set to fill
+	void assign( size_t rows, size_t cols, T fill = T( 0 ) )
+	{
+		myRows = rows;
+		myCols = cols;
+		myV.assign( rows * cols, fill );
+	}
+
+	T &operator()( size_t r, size_t c ) { return myV[r * myCols + c]; }
+	T operator()( size_t r, size_t c ) const { return myV[r * myCols + c]; }
+
+	T &at( size_t r, size_t c ) { check( r, c ); return myV[r * myCols + c]; }
+	T at( size_t r, size_t c ) const { check( r, c ); return myV[r * myCols + c]; }
+
+	T *data( void ) { return myV.data(); }
+	const T *data( void ) const { return myV.data(); }
+	T *row( size_t r ) { return myV.data() + r * myCols; }
+	const T *row( size_t r ) const { return myV.data() + r * myCols; }
+
+	bool operator==( const dense_matrix &o ) const { return myRows == o.myRows && myCols == o.myCols && myV == o.myV; }
+	bool operator!=( const dense_matrix &o ) const { return !( *this == o ); }
+
+	dense_matrix transposed( void ) const
+	{
+		dense_matrix r( myCols, myRows );
+		for ( size_t i = 0; i != myRows; ++i )
+			for ( size_t j = 0; j != myCols; ++j )
+				r( j, i ) = ( *this )( i, j );
+		return r;
+	}
+
+	dense_matrix &operator+=( const dense_matrix &o )
+	{
+		check_same( o );
+		for ( size_t i = 0; i != myV.size(); ++i )
+			myV[i] += o.myV[i];
+		return *this;
+	}
+	dense_matrix &operator-=( const dense_matrix &o )
+	{
+		check_same( o );
+		for ( size_t i = 0; i != myV.size(); ++i )
+			myV[i] -= o.myV[i];
+		return *this;
+	}
+	dense_matrix &operator*=( T s )
+	{
+		for ( T &v: myV )
+			v *= s;
+		return *this;
+	}
+
+private:
+	void check( size_t r, size_t c ) const
+	{
+		if ( r >= myRows || c >= myCols )
+			throw std::out_of_range( "dense_matrix index out of range" );
+	}
+	void check_same( const dense_matrix &o ) const
+	{
+		if ( myRows != o.myRows || myCols != o.myCols )
+			throw std::invalid_argument( "dense_matrix size mismatch" );
+	}
+
+	size_t myRows, myCols;
+	array_type myV;
+};
+
+
+////////////////////////////////////////
+
+
+/// how a matrix argument of gemm / gemv is used
+enum class mat_op
+{
+	none,
+	transpose
+};
+
+/// Products of at least dense_matrix_parallel_min multiply-adds are
+/// split across nthreads threads (0 meaning one per hardware
+/// thread), smaller ones run on the calling thread.
+static const size_t dense_matrix_parallel_min = size_t( 1 ) << 21;
+
+/// @brief c = alpha * op( a ) * op( b ) + beta * c
+///
+/// The product is computed a cache sized block at a time, from
+/// copies of the blocks laid out for the SIMD inner kernel, so the
+/// transposed forms cost the same as the plain one. When beta is 0,
+/// c is only written (and may be empty, it's resized), otherwise it
+/// must already have the size of the product. c may not be a or b.
+template <typename T>
+void gemm( mat_op opa, mat_op opb, T alpha, const dense_matrix<T> &a, const dense_matrix<T> &b,
+		   T beta, dense_matrix<T> &c, size_t nthreads = 0 );
+
+/// @brief y = alpha * op( a ) * x + beta * y
+///
+/// As with gemm, y may be empty when beta is 0. y may not be x.
+template <typename T>
+void gemv( mat_op opa, T alpha, const dense_matrix<T> &a, const std::vector<T> &x,
+		   T beta, std::vector<T> &y, size_t nthreads = 0 );
+
+template <typename T>
+inline dense_matrix<T>
+operator*( const dense_matrix<T> &a, const dense_matrix<T> &b )
+{
+	dense_matrix<T> r;
+	gemm( mat_op::none, mat_op::none, T( 1 ), a, b, T( 0 ), r );
+	return r;
+}
+
+template <typename T>
+inline std::vector<T>
+operator*( const dense_matrix<T> &a, const std::vector<T> &x )
+{
+	std::vector<T> r;
+	gemv( mat_op::none, T( 1 ), a, x, T( 0 ), r );
+	return r;
+}
+
+template <typename T>
+inline dense_matrix<T>
+operator+( dense_matrix<T> a, const dense_matrix<T> &b )
+{
+	a += b;
+	return a;
+}
+
+template <typename T>
+inline dense_matrix<T>
+operator-( dense_matrix<T> a, const dense_matrix<T> &b )
+{
+	a -= b;
+	return a;
+}
+
+template <typename T>
+inline dense_matrix<T>
+operator*( dense_matrix<T> a, T s )
+{
+	a *= s;
+	return a;
+}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -20,12 +20,20 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <vector>
 
-#include "../impl/config.h"
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "../impl/aligned_allocator.h"
 
 namespace yaco
 {
@@ -33,26 +41,450 @@ namespace yaco
 namespace math
 {
 
-// hrm. vector4 is really only
-// needed for points (i.e. w == 1)
-// in computer graphics speak
-// should we call them points vs. normals
-// or just vectors in the generic sense?
-class vector3;
-class vector4;
+/// The graphics names are thin layers over vector and
+/// square_matrix: vector3, vector4, matrix3 and matrix4 are those
+/// types, and point and normal are 3 element vectors that know how
+/// a 4 x 4 transform applies to them (a point has w = 1 and a
+/// normal goes through the inverse transpose), everything else
+/// being the plain vector arithmetic.
+template <typename T> using vector3 = vector<T, 3>;
+template <typename T> using vector4 = vector<T, 4>;
+template <typename T> using matrix3 = square_matrix<T, 3>;
+template <typename T> using matrix4 = square_matrix<T, 4>;
+
+/// @brief A position in 2D
+template <typename T>
+class point2 : public vector<T, 2>
+{
+public:
+	point2( void ) {}
+	point2( T x, T y ) : vector<T, 2>{ x, y } {}
+	template <typename E>
+	point2( const vector_expr<E, T, 2> &e ) : vector<T, 2>( e ) {}
+};
+
+/// @brief A position in 3D
+template <typename T>
+class point : public vector<T, 3>
+{
+public:
+	point( void ) {}
+	point( T x, T y, T z ) : vector<T, 3>{ x, y, z } {}
+	template <typename E>
+	point( const vector_expr<E, T, 3> &e ) : vector<T, 3>( e ) {}
+};
+
+/// @brief A surface normal
+template <typename T>
+class normal : public vector<T, 3>
+{
+public:
+	normal( void ) {}
+	normal( T x, T y, T z ) : vector<T, 3>{ x, y, z } {}
+	template <typename E>
+	normal( const vector_expr<E, T, 3> &e ) : vector<T, 3>( e ) {}
+};
+
+/// m * p with w = 1, divided by the resulting w
+template <typename T>
+inline point<T>
+transform( const matrix4<T> &m, const point<T> &p )
+{
+	return transform_point( m, p );
+}
+
+/// m * v with w = 0
+template <typename T>
+inline vector3<T>
+transform( const matrix4<T> &m, const vector3<T> &v )
+{
+	return transform_vector( m, v );
+}
+
+/// the inverse transpose of the upper 3 x 3 of m times n,
+/// renormalized, throwing if that is singular. This inverts the
+/// matrix every call, transform_normals on a vector_soa doesn't.
+template <typename T>
+inline normal<T>
+transform( const matrix4<T> &m, const normal<T> &n )
+{
+	matrix3<T> u{ m( 0, 0 ), m( 0, 1 ), m( 0, 2 ),
+				  m( 1, 0 ), m( 1, 1 ), m( 1, 2 ),
+				  m( 2, 0 ), m( 2, 1 ), m( 2, 2 ) };
+	normal<T> r( u.inverse().transposed() * n );
+	r.normalize();
+	return r;
+}
+
+
+////////////////////////////////////////
+
+
+/// @brief The points p for which dot( n, p ) + d == 0
+///
+/// distance is signed, positive on the side n faces, and is a true
+/// distance once the plane is normalized (otherwise it is scaled by
+/// the length of n).
+template <typename T>
+class plane
+{
+public:
+	typedef T value_type;
+
+	/// z = 0, facing +z
+	plane( void ) : myN{ T( 0 ), T( 0 ), T( 1 ) }, myD( 0 ) {}
+	plane( const vector3<T> &n, T d ) : myN( n ), myD( d ) {}
+	/// through p, facing n
+	plane( const vector3<T> &n, const point<T> &p ) : myN( n ), myD( -dot( n, p ) ) {}
+
+	/// through a, b and c, facing the side from which they go
+	/// counter clockwise
+	static plane through( const point<T> &a, const point<T> &b, const point<T> &c )
+	{
+		vector3<T> n = cross( b - a, c - a );
+		n.normalize();
+		return plane( n, a );
+	}
+
+	const vector3<T> &n( void ) const { return myN; }
+	T d( void ) const { return myD; }
+
+	T distance( const point<T> &p ) const { return dot( myN, p ) + myD; }
+
+	/// scales n to unit length (and d along with it), leaving a
+	/// plane with a 0 length n alone
+	void normalize( void )
+	{
+		T l = myN.magnitude();
+		if ( l > T( 0 ) )
+		{
+			myN /= l;
+			myD /= l;
+		}
+	}
+
+	/// the same plane facing the other way
+	plane flipped( void ) const { return plane( -myN, -myD ); }
+
+private:
+	vector3<T> myN;
+	T myD;
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Axis aligned bounding box
+///
+/// A default constructed box is empty (a min of +inf and a max of
+/// -inf), so extending it by anything gives the bounds of that.
+/// Boxes are expected to be finite otherwise.
+template <typename T>
+class aabb
+{
+public:
+	typedef T value_type;
+
+	aabb( void )
+		: myMin( std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity() ),
+		  myMax( -std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity() )
+	{
+	}
+	aabb( const point<T> &lo, const point<T> &hi ) : myMin( lo ), myMax( hi ) {}
+
+	bool empty( void ) const
+	{
+		return !( myMin[0] <= myMax[0] && myMin[1] <= myMax[1] && myMin[2] <= myMax[2] );
+	}
+
+	const point<T> &min( void ) const { return myMin; }
+	const point<T> &max( void ) const { return myMax; }
+	point<T> center( void ) const { return ( myMin + myMax ) * T( 0.5 ); }
+	/// half the size
+	vector3<T> extent( void ) const { return ( myMax - myMin ) * T( 0.5 ); }
+
+	void extend( const point<T> &p )
+	{
+		myMin = math::min( myMin, p );
+		myMax = math::max( myMax, p );
+	}
+	void extend( const aabb &b )
+	{
+		myMin = math::min( myMin, b.myMin );
+		myMax = math::max( myMax, b.myMax );
+	}
+
+	bool contains( const point<T> &p ) const
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			if ( !( myMin[c] <= p[c] && p[c] <= myMax[c] ) )
+				return false;
+		}
+		return true;
+	}
+	bool intersects( const aabb &b ) const
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			if ( !( myMin[c] <= b.myMax[c] && b.myMin[c] <= myMax[c] ) )
+				return false;
+		}
+		return true;
+	}
+
+	/// the box around this one transformed by the affine m, which
+	/// is Arvo's method: each row of m moves each bound by whichever
+	/// of the min or max gives the smaller (or larger) value
+	aabb transformed( const matrix4<T> &m ) const
+	{
+		if ( empty() )
+			return *this;
+
+		point<T> lo, hi;
+		for ( size_t r = 0; r != 3; ++r )
+		{
+			lo[r] = hi[r] = m( r, 3 );
+			for ( size_t c = 0; c != 3; ++c )
+			{
+				T a = m( r, c ) * myMin[c], b = m( r, c ) * myMax[c];
+				lo[r] += std::min( a, b );
+				hi[r] += std::max( a, b );
+			}
+		}
+		return aabb( lo, hi );
+	}
+
+private:
+	point<T> myMin, myMax;
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Bounding sphere
+template <typename T>
+class sphere
+{
+public:
+	typedef T value_type;
+
+	sphere( void ) : myR( 0 ) {}
+	sphere( const point<T> &c, T r ) : myC( c ), myR( r ) {}
+
+	const point<T> &center( void ) const { return myC; }
+	T radius( void ) const { return myR; }
+
+	bool contains( const point<T> &p ) const
+	{
+		vector3<T> d = p - myC;
+		return d.mag_squared() <= myR * myR;
+	}
+	bool intersects( const sphere &s ) const
+	{
+		vector3<T> d = s.myC - myC;
+		T r = myR + s.myR;
+		return d.mag_squared() <= r * r;
+	}
+	/// by the distance to the closest point of the box
+	bool intersects( const aabb<T> &b ) const
+	{
+		vector3<T> d = myC - math::min( math::max( myC, b.min() ), b.max() );
+		return ! b.empty() && d.mag_squared() <= myR * myR;
+	}
+
+	aabb<T> bounds( void ) const
+	{
+		vector3<T> r{ myR, myR, myR };
+		return aabb<T>( myC - r, myC + r );
+	}
+
+private:
+	point<T> myC;
+	T myR;
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Six planes facing inwards, in the order left, right,
+/// bottom, top, near and far
+///
+/// The planes are kept normalized. The visibility tests are
+/// conservative, something is only reported as not visible when it
+/// is entirely outside one of the planes, so a few things just
+/// beyond the corners are reported visible. A default constructed
+/// frustum has planes that everything is inside.
+template <typename T>
+class frustum
+{
+public:
+	typedef T value_type;
+
+	/// the depth range of clip space for the projection
+	enum class clip_depth
+	{
+		minus_one_to_one, ///< -w <= z <= w (OpenGL)
+		zero_to_one ///< 0 <= z <= w (Direct3D, Vulkan)
+	};
+
+	frustum( void )
+	{
+		for ( auto &p: myP )
+			p = plane<T>( vector3<T>{ T( 0 ), T( 0 ), T( 0 ) }, T( 1 ) );
+	}
+
+	/// the planes of the clip volume of m, typically projection *
+	/// view, and then in the space the view maps from (Gribb and
+	/// Hartmann's extraction: each plane is the bottom row of m plus
+	/// or minus one of the others)
+	explicit frustum( const matrix4<T> &m, clip_depth depth = clip_depth::minus_one_to_one )
+	{
+		myP[0] = row_plane( m, 3, 0, T( 1 ) );
+		myP[1] = row_plane( m, 3, 0, T( -1 ) );
+		myP[2] = row_plane( m, 3, 1, T( 1 ) );
+		myP[3] = row_plane( m, 3, 1, T( -1 ) );
+		if ( depth == clip_depth::zero_to_one )
+			myP[4] = row_plane( m, 2, 0, T( 0 ) );
+		else
+			myP[4] = row_plane( m, 3, 2, T( 1 ) );
+		myP[5] = row_plane( m, 3, 2, T( -1 ) );
+		for ( auto &p: myP )
+			p.normalize();
+	}
+
+	const plane<T> &operator[]( size_t i ) const { return myP[i]; }
+	/// stores p, normalized, as plane i
+	void set( size_t i, const plane<T> &p )
+	{
+		myP[i] = p;
+		myP[i].normalize();
+	}
+
+	bool visible( const point<T> &p ) const
+	{
+		for ( auto &pl: myP )
+		{
+			if ( !( pl.distance( p ) >= T( 0 ) ) )
+				return false;
+		}
+		return true;
+	}
+
+	bool visible( const sphere<T> &s ) const
+	{
+		for ( auto &pl: myP )
+		{
+			if ( !( pl.distance( s.center() ) >= -s.radius() ) )
+				return false;
+		}
+		return true;
+	}
+
+	/// gives the same answer as cull does for the box, an empty box
+	/// is never visible
+	bool visible( const aabb<T> &b ) const
+	{
+		T c[3], e[3];
+		for ( size_t k = 0; k != 3; ++k )
+		{
+			c[k] = ( b.min()[k] + b.max()[k] ) * T( 0.5 );
+			e[k] = ( b.max()[k] - b.min()[k] ) * T( 0.5 );
+		}
+		// the center's distance plus the box's extent along n
+		for ( auto &pl: myP )
+		{
+			const vector3<T> &n = pl.n();
+			T dist = n[0] * c[0] + n[1] * c[1] + n[2] * c[2] + pl.d();
+			T r = std::abs( n[0] ) * e[0] + std::abs( n[1] ) * e[1] + std::abs( n[2] ) * e[2];
+			if ( !( dist + r >= T( 0 ) ) )
+				return false;
+		}
+		return true;
+	}
+
+private:
+	static plane<T> row_plane( const matrix4<T> &m, size_t a, size_t b, T s )
+	{
+		return plane<T>( vector3<T>{ m( a, 0 ) + s * m( b, 0 ), m( a, 1 ) + s * m( b, 1 ), m( a, 2 ) + s * m( b, 2 ) },
+						 m( a, 3 ) + s * m( b, 3 ) );
+	}
+
+	plane<T> myP[6];
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Structure of arrays storage of many boxes for cull
+///
+/// Each bound of each axis is its own 32 byte aligned array, as in
+/// vector_soa.
+template <typename T>
+class aabb_soa
+{
+public:
+	typedef T value_type;
+	typedef std::vector<T, __priv::aligned_allocator<T, 32>> array_type;
+
+	size_t size( void ) const { return myMin[0].size(); }
+	bool empty( void ) const { return myMin[0].empty(); }
+
+	void reserve( size_t n ) { for ( size_t c = 0; c != 3; ++c ) { myMin[c].reserve( n ); myMax[c].reserve( n ); } }
+	void clear( void ) { for ( size_t c = 0; c != 3; ++c ) { myMin[c].clear(); myMax[c].clear(); } }
+
+	void push_back( const aabb<T> &b )
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			myMin[c].push_back( b.min()[c] );
+			myMax[c].push_back( b.max()[c] );
+		}
+	}
+
+	aabb<T> operator[]( size_t i ) const
+	{
+		return aabb<T>( point<T>( myMin[0][i], myMin[1][i], myMin[2][i] ),
+						point<T>( myMax[0][i], myMax[1][i], myMax[2][i] ) );
+	}
+
+	/// the arrays holding the min (or max) of axis c of every box
+	/// @{
+	const T *min_component( size_t c ) const { return myMin[c].data(); }
+	const T *max_component( size_t c ) const { return myMax[c].data(); }
+	/// @}
 
-class matrix3;
-class matrix4;
+private:
+	array_type myMin[3], myMax[3];
+};
 
-class point2;
-class point;
-class normal;
-class matrix;
+/// batches of at least this many boxes are split across threads
+static const size_t cull_parallel_min = 65536;
 
-class quaternion;
+/// @brief f.visible( box ) for each of the boxes, a SIMD register's
+/// worth of boxes at a time
+///
+/// Sets bit i of word i / 64 of visible (resized to cover every box)
+/// for the boxes that are visible, returning how many are. Provided
+/// for float and double, with nthreads as for the vector_soa
+/// kernels.
+template <typename T>
+size_t cull( const frustum<T> &f, const aabb_soa<T> &boxes, std::vector<uint64_t> &visible, size_t nthreads = 0 );
 
-// normal + distance
-class plane;
+// the plain names are the templates, so double is point<double>
+// and so on
+typedef point2<float> fpoint2;
+typedef point<float> fpoint;
+typedef normal<float> fnormal;
+typedef plane<float> fplane;
+typedef aabb<float> faabb;
+typedef sphere<float> fsphere;
+typedef frustum<float> ffrustum;
+typedef aabb_soa<float> faabb_soa;
 
 }
 
@@ -22,41 +22,292 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cmath>
+#include <algorithm>
+#include <initializer_list>
 #include <type_traits>
+#include <stdexcept>
 #include <vector>
 
+#include "vector.h"
+#include "../impl/matrix_kernels.h"
+
 namespace yaco
 {
 
 namespace math
 {
 
+/// @brief dim x dim matrix of floating point values
+///
+/// Stored column major, 16 byte aligned, and multiplying a vector
+/// is m * v (the vector is a column). The 4 x 4 float and double
+/// products and transforms, and the float inverse and determinant,
+/// use SSE (AVX for double when built for it), everything else
+/// plain loops or closed forms.
 template <typename Storage, size_t dim>
 class square_matrix
 {
+	static_assert( dim > 0, "matrix dimension of 0 is non-sensical" );
+	static_assert( std::is_floating_point<Storage>::value, "square_matrix is for floating point values" );
+
 public:
 	typedef Storage value_type;
+	typedef vector<Storage, dim> vector_type;
+	typedef __priv::matrix_ops<Storage, dim> ops;
 	static const size_t size = dim;
 
+	/// the identity
+	square_matrix( void ) { set_identity(); }
+	/// the values a row at a time, as they would be written out,
+	/// any left over are 0
+	square_matrix( std::initializer_list<value_type> rows )
+	{
+		std::fill( myV, myV + dim * dim, value_type( 0 ) );
+		size_t i = 0;
+		for ( auto v = rows.begin(); v != rows.end() && i < dim * dim; ++v, ++i )
+			(*this)( i / dim, i % dim ) = *v;
+	}
+	template <typename O>
+	explicit square_matrix( const square_matrix<O, dim> &o )
+	{
+		for ( size_t i = 0; i != dim * dim; ++i )
+			myV[i] = static_cast<value_type>( o.data()[i] );
+	}
+	/// usable in a constant expression, see const_matrix
+	constexpr square_matrix( const const_matrix<value_type, dim> &c )
+		: square_matrix( c, typename gen_sequence<dim * dim>::type() )
+	{
+	}
+
+	static square_matrix identity( void ) { return square_matrix(); }
+	static square_matrix zero( void )
+	{
+		square_matrix r;
+		std::fill( r.myV, r.myV + dim * dim, value_type( 0 ) );
+		return r;
+	}
+
+	void set_identity( void )
+	{
+		for ( size_t c = 0; c != dim; ++c )
+			for ( size_t r = 0; r != dim; ++r )
+				myV[c * dim + r] = value_type( r == c ? 1 : 0 );
+	}
+
+	value_type &operator()( size_t row, size_t col ) { return myV[col * dim + row]; }
+	constexpr value_type operator()( size_t row, size_t col ) const { return myV[col * dim + row]; }
+
+	value_type &at( size_t row, size_t col ) { check( row, col ); return (*this)( row, col ); }
+	value_type at( size_t row, size_t col ) const { check( row, col ); return (*this)( row, col ); }
+
+	/// column major
+	/// @{
+	value_type *data( void ) { return myV; }
+	const value_type *data( void ) const { return myV; }
+	/// @}
+
+	vector_type column( size_t c ) const
+	{
+		vector_type r;
+		for ( size_t i = 0; i != dim; ++i )
+			r[i] = (*this)( i, c );
+		return r;
+	}
+	vector_type row( size_t r ) const
+	{
+		vector_type v;
+		for ( size_t i = 0; i != dim; ++i )
+			v[i] = (*this)( r, i );
+		return v;
+	}
+	void set_column( size_t c, const vector_type &v )
+	{
+		for ( size_t i = 0; i != dim; ++i )
+			(*this)( i, c ) = v[i];
+	}
+	void set_row( size_t r, const vector_type &v )
+	{
+		for ( size_t i = 0; i != dim; ++i )
+			(*this)( r, i ) = v[i];
+	}
+
+	bool operator==( const square_matrix &o ) const { return std::equal( myV, myV + dim * dim, o.myV ); }
+	bool operator!=( const square_matrix &o ) const { return !( *this == o ); }
+
+	/// this = this * o
+	square_matrix &operator*=( const square_matrix &o )
+	{
+		square_matrix r{ no_init() };
+		ops::multiply( myV, o.myV, r.myV );
+		return *this = r;
+	}
+	square_matrix &operator*=( value_type s )
+	{
+		for ( auto &v: myV )
+			v *= s;
+		return *this;
+	}
+	square_matrix &operator+=( const square_matrix &o )
+	{
+		for ( size_t i = 0; i != dim * dim; ++i )
+			myV[i] += o.myV[i];
+		return *this;
+	}
+	square_matrix &operator-=( const square_matrix &o )
+	{
+		for ( size_t i = 0; i != dim * dim; ++i )
+			myV[i] -= o.myV[i];
+		return *this;
+	}
+
+	square_matrix transposed( void ) const
+	{
+		square_matrix r{ no_init() };
+		ops::transpose( myV, r.myV );
+		return r;
+	}
+	void transpose( void ) { *this = transposed(); }
+
+	/// 0 when it is within rounding error of 0 (relative to the
+	/// size of the rows), so that it is 0 exactly when inverse
+	/// throws
+	value_type determinant( void ) const { return ops::determinant( myV ); }
+
+	/// throws if the matrix is singular
+	square_matrix inverse( void ) const
+	{
+		square_matrix r{ no_init() };
+		value_type d = ops::inverse( myV, r.myV );
+		if ( d == value_type( 0 ) || ! std::isfinite( d ) )
+			throw std::runtime_error( "Unable to invert singular matrix" );
+		return r;
+	}
+	/// stores the inverse in out and returns true, or returns
+	/// false (leaving out alone) if the matrix is singular
+	bool invert( square_matrix &out ) const
+	{
+		square_matrix r{ no_init() };
+		value_type d = ops::inverse( myV, r.myV );
+		if ( d == value_type( 0 ) || ! std::isfinite( d ) )
+			return false;
+		out = r;
+		return true;
+	}
+
+	/// m * v
+	template <typename E>
+	vector_type transform( const vector_expr<E, value_type, dim> &e ) const
+	{
+		vector_type v( e ), r;
+		ops::transform( myV, v.data(), r.data() );
+		return r;
+	}
+
 private:
-	value_type myV[size][size];
+	struct no_init {};
+	explicit square_matrix( no_init ) {}
+	template <size_t... I>
+	constexpr square_matrix( const const_matrix<value_type, dim> &c, unpack_sequence<I...> )
+		: myV{ c.v[I]... }
+	{
+	}
+
+	void check( size_t row, size_t col ) const
+	{
+		if ( row >= dim || col >= dim )
+			throw std::out_of_range( "matrix index out of range" );
+	}
+
+	alignas(16) value_type myV[dim * dim];
 };
 
-template <typename Storage>
-class square_matrix<Storage, 2>
+template <typename Storage, size_t dim>
+const size_t square_matrix<Storage, dim>::size;
+
+
+////////////////////////////////////////
+
+
+template <typename T, size_t dim>
+inline square_matrix<T, dim>
+operator*( const square_matrix<T, dim> &a, const square_matrix<T, dim> &b )
 {
-};
+	square_matrix<T, dim> r( a );
+	r *= b;
+	return r;
+}
 
-template <typename Storage>
-class square_matrix<Storage, 3>
+template <typename T, size_t dim, typename E>
+inline vector<T, dim>
+operator*( const square_matrix<T, dim> &m, const vector_expr<E, T, dim> &v )
 {
-};
+	return m.transform( v );
+}
 
-template <typename Storage>
-class square_matrix<Storage, 4>
+template <typename T, size_t dim>
+inline square_matrix<T, dim>
+operator*( const square_matrix<T, dim> &a, typename square_matrix<T, dim>::value_type s )
 {
-};
+	square_matrix<T, dim> r( a );
+	r *= s;
+	return r;
+}
+
+template <typename T, size_t dim>
+inline square_matrix<T, dim>
+operator*( typename square_matrix<T, dim>::value_type s, const square_matrix<T, dim> &a )
+{
+	return a * s;
+}
+
+template <typename T, size_t dim>
+inline square_matrix<T, dim>
+operator+( const square_matrix<T, dim> &a, const square_matrix<T, dim> &b )
+{
+	square_matrix<T, dim> r( a );
+	r += b;
+	return r;
+}
+
+template <typename T, size_t dim>
+inline square_matrix<T, dim>
+operator-( const square_matrix<T, dim> &a, const square_matrix<T, dim> &b )
+{
+	square_matrix<T, dim> r( a );
+	r -= b;
+	return r;
+}
+
+template <typename T, size_t dim>
+inline square_matrix<T, dim> transpose( const square_matrix<T, dim> &m ) { return m.transposed(); }
+template <typename T, size_t dim>
+inline T determinant( const square_matrix<T, dim> &m ) { return m.determinant(); }
+template <typename T, size_t dim>
+inline square_matrix<T, dim> inverse( const square_matrix<T, dim> &m ) { return m.inverse(); }
+
+/// @brief Applies a 4 x 4 transform to a 3D point (w = 1),
+/// dividing by the resulting w
+template <typename T, typename E>
+inline vector<T, 3>
+transform_point( const square_matrix<T, 4> &m, const vector_expr<E, T, 3> &p )
+{
+	vector<T, 3> v( p );
+	vector<T, 4> r = m * vector<T, 4>{ v[0], v[1], v[2], T( 1 ) };
+	T iw = T( 1 ) / r[3];
+	return vector<T, 3>{ r[0] * iw, r[1] * iw, r[2] * iw };
+}
+
+/// @brief Applies a 4 x 4 transform to a 3D direction (w = 0)
+template <typename T, typename E>
+inline vector<T, 3>
+transform_vector( const square_matrix<T, 4> &m, const vector_expr<E, T, 3> &d )
+{
+	vector<T, 3> v( d );
+	vector<T, 4> r = m * vector<T, 4>{ v[0], v[1], v[2], T( 0 ) };
+	return vector<T, 3>{ r[0], r[1], r[2] };
+}
 
 typedef square_matrix<float, 2> fmat2;
 typedef square_matrix<float, 3> fmat3;
@@ -91,4 +342,3 @@ private:
 // mode: C++
 // End:
 // vim:ft=cpp:
-
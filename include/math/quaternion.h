@@ -20,9 +20,14 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+
 #pragma once
 
 #include <cmath>
+#include <complex>
+#include <limits>
+#include <utility>
+#include <stdexcept>
 #include <type_traits>
 
 #include "vector.h"
@@ -34,120 +39,285 @@ namespace yaco
 namespace math
 {
 
-template <typename T, class Enable = void>
-class quaternion;
-
+/// @brief A quaternion a + b i + c j + d k
+///
+/// Unit quaternions represent rotations, composed by multiplying
+/// them (a * b rotates by b, then by a), and applied with rotate or
+/// to_matrix. The components are indexed in the order of the
+/// constructor, so q[0] is the real part.
 template <typename StorageType = double>
-class quaternion<StorageType, typename std::enable_if<std::is_floating_point<T>::value >::type>
+class quaternion
 {
+	static_assert( std::is_floating_point<StorageType>::value, "quaternion requires a floating point type" );
+
 public:
 	typedef StorageType value_type;
-	typedef typename std::complex<value_type> complex_type;
-	typedef typename vector<Storage> vector_type;
-	typedef typename square_matrix<Storage, 3> matrix_type;
+	typedef std::complex<value_type> complex_type;
+	typedef vector<value_type, 3> vector_type;
+	typedef square_matrix<value_type, 3> matrix_type;
 
-	quaternion( void );
 	quaternion( const value_type &a = static_cast<value_type>( 0 ),
 				const value_type &b = static_cast<value_type>( 0 ),
 				const value_type &c = static_cast<value_type>( 0 ),
-				const value_type &d = static_cast<value_type>( 0 ) );
+				const value_type &d = static_cast<value_type>( 0 ) )
+		: myV{ a, b, c, d }
+	{
+	}
+	/// c1 + c2 j
 	quaternion( const complex_type &c1,
-				const complex_type &c2 = complex_type() );
+				const complex_type &c2 = complex_type() )
+		: myV{ c1.real(), c1.imag(), c2.real(), c2.imag() }
+	{
+	}
+	quaternion( const value_type &real, const vector_type &unreal )
+		: myV{ real, unreal[0], unreal[1], unreal[2] }
+	{
+	}
 	template <class OS>
-	quaternion( const quaternion<OS> &o );
-	~quaternion( void );
+	explicit quaternion( const quaternion<OS> &o )
+		: myV{ static_cast<value_type>( o[0] ), static_cast<value_type>( o[1] ),
+			   static_cast<value_type>( o[2] ), static_cast<value_type>( o[3] ) }
+	{
+	}
+
+	static quaternion identity( void ) { return quaternion( value_type( 1 ) ); }
+
+	/// @brief The rotation by angle (radians, counter clockwise
+	/// looking down the axis) about axis, which need not be unit length
+	static quaternion from_rotation( value_type angle, const vector_type &axis )
+	{
+		vector_type u( axis );
+		u.normalize();
+		value_type h = angle / value_type( 2 );
+		value_type s = std::sin( h );
+		return quaternion( std::cos( h ), s * u[0], s * u[1], s * u[2] );
+	}
 
-	bool operator==( const quaternion &o );
-	bool operator!=( const quaternion &o );
+	value_type operator[]( size_t i ) const { return myV[i]; }
+	value_type &operator[]( size_t i ) { return myV[i]; }
 
-	quaternion &operator+=( const value_type &o );
-	quaternion &operator+=( const complex_type &o );
+	value_type real( void ) const { return myV[0]; }
+	vector_type unreal( void ) const { return vector_type{ myV[1], myV[2], myV[3] }; }
+
+	bool operator==( const quaternion &o ) const
+	{
+		return myV[0] == o.myV[0] && myV[1] == o.myV[1] && myV[2] == o.myV[2] && myV[3] == o.myV[3];
+	}
+	bool operator!=( const quaternion &o ) const { return !( *this == o ); }
+
+	quaternion &operator+=( const value_type &o ) { myV[0] += o; return *this; }
+	quaternion &operator+=( const complex_type &o ) { myV[0] += o.real(); myV[1] += o.imag(); return *this; }
 	template <typename OtherStorage>
-	quaternion &operator+=( const quaternion<OtherStorage> &o );
+	quaternion &operator+=( const quaternion<OtherStorage> &o )
+	{
+		for ( size_t i = 0; i != 4; ++i )
+			myV[i] += static_cast<value_type>( o[i] );
+		return *this;
+	}
 
-	quaternion &operator-=( const value_type &o );
-	quaternion &operator-=( const complex_type &o );
+	quaternion &operator-=( const value_type &o ) { myV[0] -= o; return *this; }
+	quaternion &operator-=( const complex_type &o ) { myV[0] -= o.real(); myV[1] -= o.imag(); return *this; }
 	template <typename OtherStorage>
-	quaternion &operator-=( const quaternion<OtherStorage> &o );
+	quaternion &operator-=( const quaternion<OtherStorage> &o )
+	{
+		for ( size_t i = 0; i != 4; ++i )
+			myV[i] -= static_cast<value_type>( o[i] );
+		return *this;
+	}
 
-	quaternion &operator*=( const value_type &o );
-	quaternion &operator*=( const complex_type &o );
+	quaternion &operator*=( const value_type &o )
+	{
+		for ( value_type &v: myV )
+			v *= o;
+		return *this;
+	}
+	quaternion &operator*=( const complex_type &o ) { return *this *= quaternion( o ); }
+	/// *this = *this * o
 	template <typename OtherStorage>
-	quaternion &operator*=( const quaternion<OtherStorage> &o );
+	quaternion &operator*=( const quaternion<OtherStorage> &o )
+	{
+		const value_type *p = myV;
+		value_type q[4] = { static_cast<value_type>( o[0] ), static_cast<value_type>( o[1] ),
+							static_cast<value_type>( o[2] ), static_cast<value_type>( o[3] ) };
+		value_type r[4] = {
+			p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3],
+			p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2],
+			p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1],
+			p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0] };
+		for ( size_t i = 0; i != 4; ++i )
+			myV[i] = r[i];
+		return *this;
+	}
 
-	quaternion &operator/=( const value_type &o );
-	quaternion &operator/=( const complex_type &o );
+	quaternion &operator/=( const value_type &o )
+	{
+		for ( value_type &v: myV )
+			v /= o;
+		return *this;
+	}
+	quaternion &operator/=( const complex_type &o ) { return *this /= quaternion( o ); }
+	/// *this = *this * o.inverse()
 	template <typename OtherStorage>
-	quaternion &operator/=( const quaternion<OtherStorage> &o );
+	quaternion &operator/=( const quaternion<OtherStorage> &o )
+	{
+		return *this *= quaternion( o ).inverse();
+	}
+
+	value_type mag_squared( void ) const
+	{
+		return myV[0] * myV[0] + myV[1] * myV[1] + myV[2] * myV[2] + myV[3] * myV[3];
+	}
+	value_type magnitude( void ) const { return std::sqrt( mag_squared() ); }
+
+	/// scales to unit length, unless the length is (nearly) 0,
+	/// returning the length
+	value_type normalize( void )
+	{
+		value_type l = magnitude();
+		if ( l > std::numeric_limits<value_type>::epsilon() )
+			*this /= l;
+		return l;
+	}
+
+	quaternion conjugate( void ) const { return quaternion( myV[0], -myV[1], -myV[2], -myV[3] ); }
+
+	/// throws if the quaternion is 0
+	quaternion inverse( void ) const
+	{
+		value_type n = mag_squared();
+		if ( n == value_type( 0 ) )
+			throw std::runtime_error( "Unable to invert zero quaternion" );
+		quaternion r = conjugate();
+		r /= n;
+		return r;
+	}
 
 	/// Returns an angle and axis of rotation
-	std::pair<value_type, vector_type> rotation( void ) const;
+	///
+	/// The angle is in [0, 2 pi]. The identity gives an angle of 0
+	/// about the x axis.
+	std::pair<value_type, vector_type> rotation( void ) const
+	{
+		vector_type u = unreal();
+		value_type s = u.magnitude();
+		if ( s == value_type( 0 ) )
+			return std::make_pair( value_type( 0 ), vector_type{ value_type( 1 ), value_type( 0 ), value_type( 0 ) } );
+		u /= s;
+		return std::make_pair( value_type( 2 ) * std::atan2( s, myV[0] ), u );
+	}
 
 	/// Converts to a matrix representation
-	matrix_type to_matrix( void ) const;
+	///
+	/// The result is the rotation this represents, also when it isn't
+	/// unit length (the scale is divided out). The 0 quaternion gives
+	/// the identity.
+	matrix_type to_matrix( void ) const
+	{
+		value_type n = mag_squared();
+		value_type s = n > value_type( 0 ) ? value_type( 2 ) / n : value_type( 0 );
+		value_type w = myV[0], x = myV[1], y = myV[2], z = myV[3];
+		value_type xs = x * s, ys = y * s, zs = z * s;
+		value_type wx = w * xs, wy = w * ys, wz = w * zs;
+		value_type xx = x * xs, xy = x * ys, xz = x * zs;
+		value_type yy = y * ys, yz = y * zs, zz = z * zs;
+		const value_type one( 1 );
+		return matrix_type{
+			one - ( yy + zz ), xy - wz, xz + wy,
+			xy + wz, one - ( xx + zz ), yz - wx,
+			xz - wy, yz + wx, one - ( xx + yy ) };
+	}
+
+	/// rotates v by this (assumed unit length) quaternion
+	vector_type rotate( const vector_type &v ) const
+	{
+		vector_type u = unreal();
+		vector_type t = cross( u, v ) * value_type( 2 );
+		return v + t * myV[0] + cross( u, t );
+	}
 
 private:
-	type x, y, z, w;
+	value_type myV[4];
 };
 
 template <typename S>
-quaternion<S> operator*( quaternion<S> &&a, quaternion<S> &&b )
-{
-	a *= b;
-	return std::move( a );
-}
+inline quaternion<S> operator*( quaternion<S> a, const quaternion<S> &b ) { a *= b; return a; }
+template <typename S>
+inline quaternion<S> operator*( quaternion<S> a, S s ) { a *= s; return a; }
+template <typename S>
+inline quaternion<S> operator*( S s, quaternion<S> a ) { a *= s; return a; }
 
 template <typename S>
-quaternion<S> operator*( quaternion<S> &&a, const quaternion<S> &b )
-{
-	a *= b;
-	return std::move( a );
-}
+inline quaternion<S> operator/( quaternion<S> a, const quaternion<S> &b ) { a /= b; return a; }
+template <typename S>
+inline quaternion<S> operator/( quaternion<S> a, S s ) { a /= s; return a; }
 
 template <typename S>
-quaternion<S> operator*( const quaternion<S> &a, quaternion<S> &&b )
-{
-	b *= a;
-	return std::move( b );
-}
+inline quaternion<S> operator+( quaternion<S> a, const quaternion<S> &b ) { a += b; return a; }
+template <typename S>
+inline quaternion<S> operator-( quaternion<S> a, const quaternion<S> &b ) { a -= b; return a; }
+template <typename S>
+inline quaternion<S> operator-( const quaternion<S> &a ) { return quaternion<S>( -a[0], -a[1], -a[2], -a[3] ); }
 
 template <typename S>
-quaternion<S> operator*( const quaternion<S> &a, const quaternion<S> &b )
+inline S dot( const quaternion<S> &a, const quaternion<S> &b )
 {
-	quaternion<S> r( a );
-	r *= b;
-	return r;
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
 }
 
 template <typename S>
-quaternion<S> operator+( quaternion<S> &&a, quaternion<S> &&b )
-{
-	a += b;
-	return std::move( a );
-}
+inline quaternion<S> conj( const quaternion<S> &q ) { return q.conjugate(); }
+template <typename S>
+inline S magnitude( const quaternion<S> &q ) { return q.magnitude(); }
+template <typename S>
+inline quaternion<S> inverse( const quaternion<S> &q ) { return q.inverse(); }
 
 template <typename S>
-quaternion<S> operator+( quaternion<S> &&a, const quaternion<S> &b )
+inline quaternion<S>
+normalize( const quaternion<S> &q )
 {
-	a += b;
-	return std::move( a );
+	quaternion<S> r( q );
+	r.normalize();
+	return r;
 }
 
+/// @brief Normalized linear interpolation along the shorter arc
+///
+/// Cheaper than slerp, with the same end points, but doesn't move
+/// at a constant angular speed.
 template <typename S>
-quaternion<S> operator+( const quaternion<S> &a, quaternion<S> &&b )
+inline quaternion<S>
+nlerp( const quaternion<S> &a, const quaternion<S> &b, S t )
 {
-	b += a;
-	return std::move( b );
+	quaternion<S> e = std::signbit( dot( a, b ) ) ? -b : b;
+	quaternion<S> r = a + ( e - a ) * t;
+	r.normalize();
+	return r;
 }
 
+/// @brief Spherical linear interpolation of unit quaternions along
+/// the shorter arc, for t in [0, 1]
 template <typename S>
-quaternion<S> operator+( const quaternion<S> &a, const quaternion<S> &b )
+inline quaternion<S>
+slerp( const quaternion<S> &a, const quaternion<S> &b, S t )
 {
-	quaternion<S> r( a );
-	r += b;
-	return r;
+	quaternion<S> e = std::signbit( dot( a, b ) ) ? -b : b;
+	// the angle between them, accurate for small angles as well,
+	// unlike acos of the dot product
+	S theta = S( 2 ) * std::atan2( magnitude( a - e ), magnitude( a + e ) );
+	S s = std::sin( theta );
+	S wa = S( 1 ) - t, wb = t;
+	if ( s > std::numeric_limits<S>::epsilon() )
+	{
+		wa = std::sin( ( S( 1 ) - t ) * theta ) / s;
+		wb = std::sin( t * theta ) / s;
+	}
+	return a * wa + e * wb;
 }
 
+typedef quaternion<float> fquat;
+typedef quaternion<double> quat;
+typedef quaternion<long double> dquat;
+
 }
 
 }
@@ -156,4 +326,3 @@ quaternion<S> operator+( const quaternion<S> &a, const quaternion<S> &b )
 // mode: C++
 // End:
 // vim:ft=cpp:
-
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "quaternion.h"
+#include "vector_soa.h"
+#include "../impl/aligned_allocator.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Structure of arrays storage of many quaternions for the
+/// batch kernels
+///
+/// As with vector_soa, each component (in quaternion index order,
+/// so component 0 is the real part) is kept in its own 32 byte
+/// aligned array.
+template <typename T>
+class quaternion_soa
+{
+public:
+	typedef T value_type;
+	typedef quaternion<T> quaternion_type;
+	typedef std::vector<T, __priv::aligned_allocator<T, 32>> array_type;
+
+	quaternion_soa( void ) {}
+	explicit quaternion_soa( size_t n ) { resize( n ); }
+
+	size_t size( void ) const { return myC[0].size(); }
+	bool empty( void ) const { return myC[0].empty(); }
+
+	void reserve( size_t n ) { for ( auto &c: myC ) c.reserve( n ); }
+	void resize( size_t n ) { for ( auto &c: myC ) c.resize( n ); }
+	void clear( void ) { for ( auto &c: myC ) c.clear(); }
+
+	void push_back( const quaternion_type &q )
+	{
+		for ( size_t c = 0; c != 4; ++c )
+			myC[c].push_back( q[c] );
+	}
+
+	quaternion_type operator[]( size_t i ) const
+	{
+		return quaternion_type( myC[0][i], myC[1][i], myC[2][i], myC[3][i] );
+	}
+
+	void set( size_t i, const quaternion_type &q )
+	{
+		for ( size_t c = 0; c != 4; ++c )
+			myC[c][i] = q[c];
+	}
+
+	/// the array holding component c of every entry
+	/// @{
+	T *component( size_t c ) { return myC[c].data(); }
+	const T *component( size_t c ) const { return myC[c].data(); }
+	/// @}
+
+private:
+	array_type myC[4];
+};
+
+typedef quaternion_soa<float> fquat_soa;
+typedef quaternion_soa<double> quat_soa;
+
+
+////////////////////////////////////////
+
+
+/// The batch kernels are provided for float and double, and follow
+/// the vector_soa kernels: out is resized to match the input, may be
+/// the same buffer as an input, and large batches are split across
+/// nthreads threads. Except for slerp, each evaluates the same
+/// expression as the corresponding quaternion function does one entry
+/// at a time, so the results agree up to rounding where the compiler
+/// fuses multiply-adds.
+/// @{
+
+/// quaternion::normalize for each entry, in place
+template <typename T>
+void normalize( quaternion_soa<T> &q, size_t nthreads = 0 );
+
+/// out[i] = a[i] * b[i], throwing if the sizes differ
+template <typename T>
+void multiply( const quaternion_soa<T> &a, const quaternion_soa<T> &b, quaternion_soa<T> &out, size_t nthreads = 0 );
+
+/// nlerp( a[i], b[i], t ), throwing if the sizes differ
+template <typename T>
+void nlerp( const quaternion_soa<T> &a, const quaternion_soa<T> &b, T t, quaternion_soa<T> &out, size_t nthreads = 0 );
+
+/// @brief slerp( a[i], b[i], t ) of unit quaternions, for t in
+/// [0, 1], throwing if the sizes differ
+///
+/// The sines and arc cosine have no SIMD form, so this evaluates
+/// the slerp weights as a series in the cosine of the angle
+/// instead (D. Eberly, "A Fast and Accurate Algorithm for Computing
+/// SLERP"), after splitting the arc at its midpoint so the series
+/// converges quickly. The result is within a few ulps of slerp.
+template <typename T>
+void slerp( const quaternion_soa<T> &a, const quaternion_soa<T> &b, T t, quaternion_soa<T> &out, size_t nthreads = 0 );
+
+/// quaternion::to_matrix for each entry, with component c * 3 + r
+/// of out holding element ( r, c ), as in square_matrix::data
+template <typename T>
+void to_matrix( const quaternion_soa<T> &q, vector_soa<T, 9> &out, size_t nthreads = 0 );
+/// @}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -23,12 +23,17 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
 #include <limits>
 #include <vector>
+#include <thread>
+#include <algorithm>
 #include <iosfwd>
 
 #include "../impl/config.h"
+#include "../small_vector.h"
+#include "../impl/region_priv.h"
 
 namespace yaco
 {
@@ -39,25 +44,30 @@ namespace math
 /// @brief Abstracts the concept of a 2-D region (vs. a 3-D volume)
 ///        with appropriate operators on the bounding box
 ///
-/// NB: This is a region defined using integers, primarily intended
-/// for use in dealing with pixel coverage.
-/// A more generic volume class would probably deal with floating point.
-///
-/// Until then, this remains NOT templated.
-class region
+/// The region includes both its left and right (bottom and top)
+/// edge. With integer coordinates (the region typedef) this is
+/// primarily intended for use in dealing with pixel coverage, and
+/// the size is right - left + 1. With floating point coordinates,
+/// a region is the closed box between the edges, with size
+/// right - left, and infinite regions use the infinities. The
+/// boolean operations are provided for int, int64_t, float and
+/// double coordinates.
+template <typename T>
+class region_t
 {
 public:
-	typedef int value_type;
+	typedef T value_type;
+	typedef __priv::region_coord<T> coord;
 
 	struct infinite_tag_t {};
 	constexpr static infinite_tag_t inf = infinite_tag_t();
 
 	/// @brief Create an empty box
-	constexpr region( void ) : myL( 0 ), myR( -1 ), myB( 0 ), myT( -1 ) {}
+	constexpr region_t( void ) : myL( 0 ), myR( -1 ), myB( 0 ), myT( -1 ) {}
 	/// @brief Create a specific region
-	constexpr region( value_type l, value_type r, value_type b, value_type t ) : myL( l ), myR( r ), myB( b ), myT( t ) {}
+	constexpr region_t( value_type l, value_type r, value_type b, value_type t ) : myL( l ), myR( r ), myB( b ), myT( t ) {}
 	/// @brief Create an infinite bounding box
-	constexpr region( infinite_tag_t ) : myL( std::numeric_limits<value_type>::min() ), myR( std::numeric_limits<value_type>::max() ), myB( std::numeric_limits<value_type>::min() ), myT( std::numeric_limits<value_type>::max() ) {}
+	constexpr region_t( infinite_tag_t ) : myL( coord::lowest() ), myR( coord::highest() ), myB( coord::lowest() ), myT( coord::highest() ) {}
 
 	constexpr value_type left( void ) const { return myL; }
 	constexpr value_type right( void ) const { return myR; }
@@ -67,10 +77,10 @@ public:
 	constexpr value_type offset_x( void ) const { return myL; }
 	constexpr value_type offset_y( void ) const { return myB; }
 
-	/// NB: for infinite regions, this will return 0
-	constexpr value_type size_x( void ) const { return myR - myL + 1; }
-	/// NB: for infinite regions, this will return 0
-	constexpr value_type size_y( void ) const { return myT - myB + 1; }
+	/// NB: for infinite integer regions, this will return 0
+	constexpr value_type size_x( void ) const { return myR - myL + coord::unit(); }
+	/// NB: for infinite integer regions, this will return 0
+	constexpr value_type size_y( void ) const { return myT - myB + coord::unit(); }
 
 	void clear( void ) { myL = myB = 0; myR = myT = -1; }
 	void reset( infinite_tag_t );
@@ -78,23 +88,23 @@ public:
 	void reset_by_size( value_type ox, value_type oy, value_type sx, value_type sy );
 
 	/// preserves size
-	void set_offset( int ox, int oy );
+	void set_offset( value_type ox, value_type oy );
 	/// Leaves left, bottom (offset) alone
-	void set_size( int sx, int sy );
+	void set_size( value_type sx, value_type sy );
 
 	constexpr bool empty( void ) const { return myR < myL || myT < myB; }
 	constexpr bool infinite( void ) const { return infinite_x() || infinite_y(); }
 	constexpr bool infinite_x( void ) const { return infinite_l() || infinite_r(); }
 	constexpr bool infinite_y( void ) const { return infinite_b() || infinite_t(); }
-	constexpr bool infinite_l( void ) const { return myL == std::numeric_limits<value_type>::min(); }
-	constexpr bool infinite_r( void ) const { return myR == std::numeric_limits<value_type>::max(); }
-	constexpr bool infinite_b( void ) const { return myB == std::numeric_limits<value_type>::min(); }
-	constexpr bool infinite_t( void ) const { return myT == std::numeric_limits<value_type>::max(); }
-
-	constexpr bool equal( const region &o ) const { return *this == o; }
-	constexpr bool operator==( const region &o ) const { return myL == o.myL && myR == o.myR && myB == o.myB && myT == o.myT; }
-	constexpr bool operator!=( const region &o ) const { return !( *this == o ); }
-	constexpr bool operator<( const region &o ) const
+	constexpr bool infinite_l( void ) const { return myL == coord::lowest(); }
+	constexpr bool infinite_r( void ) const { return myR == coord::highest(); }
+	constexpr bool infinite_b( void ) const { return myB == coord::lowest(); }
+	constexpr bool infinite_t( void ) const { return myT == coord::highest(); }
+
+	constexpr bool equal( const region_t &o ) const { return *this == o; }
+	constexpr bool operator==( const region_t &o ) const { return myL == o.myL && myR == o.myR && myB == o.myB && myT == o.myT; }
+	constexpr bool operator!=( const region_t &o ) const { return !( *this == o ); }
+	constexpr bool operator<( const region_t &o ) const
 	{
 		return ( ( bottom() < o.bottom() ) ||
 				 ( bottom() == o.bottom() && left() < o.left() ) ||
@@ -103,15 +113,15 @@ public:
 	}
 
 	/// @brief returns true if this region is inside the provided region
-	constexpr bool inside( const region &o ) const { return left() >= o.left() && right() <= o.right() && bottom() >= o.bottom() && top() <= o.top(); }
-	constexpr bool intersects( const region &o ) const { return left() <= o.right() && right() >= o.left() && bottom() <= o.top() && top() >= o.bottom(); }
+	constexpr bool inside( const region_t &o ) const { return left() >= o.left() && right() <= o.right() && bottom() >= o.bottom() && top() <= o.top(); }
+	constexpr bool intersects( const region_t &o ) const { return left() <= o.right() && right() >= o.left() && bottom() <= o.top() && top() >= o.bottom(); }
 
 	constexpr bool contains_x( value_type x ) const { return myL <= x && x <= myR; }
 	constexpr bool contains_y( value_type y ) const { return myB <= y && y <= myT; }
 	constexpr bool contains( value_type x, value_type y ) const { return contains_x( x ) && contains_y( y ); }
 
-	void intersect( const region &o );
-	void merge( const region &o );
+	void intersect( const region_t &o );
+	void merge( const region_t &o );
 
 	/// NB: border conditions exist with very large regions
 	///     (real coordinates approaching numeric limits)
@@ -126,15 +136,58 @@ public:
 	/// @}
 
 private:
-	int myL, myR, myB, myT;
+	value_type myL, myR, myB, myT;
 };
 
-typedef std::vector<region> region_list;
+template <typename T>
+constexpr typename region_t<T>::infinite_tag_t region_t<T>::inf;
+
+/// @brief A list of regions
+///
+/// Most lists hold a handful of regions, so the first
+/// region_list_inline of them are kept in the list itself and
+/// only longer lists allocate.
+///
+/// This used to be a std::vector. small_vector converts to and from
+/// one, so most callers are unaffected, but it is a different type:
+/// code that names std::vector<region> in a template argument or
+/// overload, or uses members small_vector lacks (get_allocator) has
+/// to change.
+constexpr size_t region_list_inline = 4;
+template <typename T>
+using region_list_t = small_vector<region_t<T>, region_list_inline>;
 
-std::ostream &operator<<( std::ostream &out, const region &r );
-std::ostream &operator<<( std::ostream &out, const region_list &rl );
+typedef region_t<int> region;
+typedef region_t<int64_t> region64;
+typedef region_t<float> regionf;
+typedef region_t<double> regiond;
+
+typedef region_list_t<int> region_list;
+typedef region_list_t<int64_t> region64_list;
+typedef region_list_t<float> regionf_list;
+typedef region_list_t<double> regiond_list;
+
+template <typename T>
+std::ostream &operator<<( std::ostream &out, const region_t<T> &r );
+template <typename T>
+std::ostream &operator<<( std::ostream &out, const region_list_t<T> &rl );
+
+/// @brief Converts a list into canonical Y-X banded form
+///
+/// The result covers the same area as the input, but is split into
+/// horizontal bands: regions in a band share the same bottom and top,
+/// are sorted left to right and neither overlap nor touch, and
+/// vertically adjacent bands with identical spans are joined. This
+/// form is unique, so two canonical lists cover the same area iff
+/// they compare equal. Runs in O(n log n) (plus the output size).
+template <typename T>
+void canonicalize( region_list_t<T> &a );
 
-void sort_and_merge( region_list &a );	
+/// @brief Sorts and merges overlapping / adjacent regions
+///
+/// Same as canonicalize.
+template <typename T>
+void sort_and_merge( region_list_t<T> &a );
 
 // c is always a region_list, but a and b can be either a region
 // or a region_list
@@ -147,55 +200,196 @@ void sort_and_merge( region_list &a );
 
 /// Computes a set of regions that represents the exact intersection (AND)
 /// of the two inputs, returning the result as a list of regions.
-/// The resulting list of regions will be merged together where possible:
-/// if there are two regions in the list that share a side that are the
-/// same dimension along that side, those regions will be merged into a
-/// larger region.
+/// The result is in canonical Y-X banded form (see canonicalize):
+/// regions are split at every band edge and joined side by side within
+/// a band, but regions stacked vertically are only joined when their
+/// whole bands have identical spans.
 /// @{
-region_list operator&( region_list a, const region_list &b );
-region_list operator&( const region_list &a, const region &b );
-region_list operator&( const region &a, const region_list &b );
-region_list operator&( const region &a, const region &b );
+template <typename T>
+region_list_t<T> operator&( region_list_t<T> a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator&( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+region_list_t<T> operator&( const region_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator&( const region_t<T> &a, const region_t<T> &b );
 /// @}
 	
 /// Computes a set of regions that represents the union (OR)
 /// of the two inputs, returning the result as a list of regions.
-/// The resulting list of regions will be merged together where possible:
-/// if there are two regions in the list that share a side that are the
-/// same dimension along that side, those regions will be merged into a
-/// larger region.
+/// The result is in canonical Y-X banded form (see canonicalize):
+/// regions are split at every band edge and joined side by side within
+/// a band, but regions stacked vertically are only joined when their
+/// whole bands have identical spans.
 /// @{
-region_list operator|( region_list a, const region_list &b );
-region_list operator|( const region_list &a, const region &b );
-region_list operator|( const region &a, const region_list &b );
-region_list operator|( const region &a, const region &b );
+template <typename T>
+region_list_t<T> operator|( region_list_t<T> a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator|( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+region_list_t<T> operator|( const region_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator|( const region_t<T> &a, const region_t<T> &b );
 /// @}
 	
 /// Computes a set of regions that represents the 'exclusive or' (XOR)
 /// of the two inputs, returning the result as a list of regions.
-/// The resulting list of regions will be merged together where possible:
-/// if there are two regions in the list that share a side that are the
-/// same dimension along that side, those regions will be merged into a
-/// larger region.
+/// The result is in canonical Y-X banded form (see canonicalize):
+/// regions are split at every band edge and joined side by side within
+/// a band, but regions stacked vertically are only joined when their
+/// whole bands have identical spans.
 /// @{
-region_list operator^( region_list a, const region_list &b );
-region_list operator^( const region_list &a, const region &b );
-region_list operator^( const region &a, const region_list &b );
-region_list operator^( const region &a, const region &b );
+template <typename T>
+region_list_t<T> operator^( region_list_t<T> a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator^( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+region_list_t<T> operator^( const region_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> operator^( const region_t<T> &a, const region_t<T> &b );
 /// @}
 	
 /// Generates a list of regions that represents the area outside
 /// all of the elements of a (NOT).
 /// @{
-region_list operator~( const region &a );
-region_list operator~( const region_list &a );
+template <typename T>
+region_list_t<T> operator~( const region_t<T> &a );
+template <typename T>
+region_list_t<T> operator~( const region_list_t<T> &a );
 /// @}
 
 /// elements of A NOT in B
 /// @{
-region_list not_in( region_list a, const region_list &b );
-region_list not_in( const region_list &a, const region &b );
-region_list not_in( const region &a, const region_list &b );
+template <typename T>
+region_list_t<T> not_in( region_list_t<T> a, const region_list_t<T> &b );
+template <typename T>
+region_list_t<T> not_in( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+region_list_t<T> not_in( const region_t<T> &a, const region_list_t<T> &b );
+/// @}
+
+/// @brief Computes an arbitrary boolean combination of a and b
+///
+/// pred is called as pred( countA, countB ) with the number of
+/// regions from each list covering a given area, and should return
+/// true if that area is part of the result. For example, the
+/// intersection is
+///
+///   region_combine( a, b, []( int ca, int cb ) { return ca > 0 && cb > 0; } );
+///
+/// The predicate is a template argument so it can be inlined into
+/// the sweep. The result is merged in the same way as the operators.
+template <typename T, typename Pred>
+inline region_list_t<T>
+region_combine( const region_list_t<T> &a, const region_list_t<T> &b, Pred pred )
+{
+	region_list_t<T> retval;
+	__priv::region_sweep( retval, a, b, pred,
+						  __priv::region_local_scratch<region_t<T>>() );
+	sort_and_merge( retval );
+	return retval;
+}
+
+/// @brief Multi-threaded version of region_combine
+///
+/// Splits the plane into up to nthreads horizontal slabs (0 meaning
+/// one per hardware thread), each with about the same number of
+/// input regions, and combines each slab on its own thread. The
+/// result is identical to region_combine. pred( 0, 0 ) must be
+/// false.
+template <typename T, typename Pred>
+inline region_list_t<T>
+region_combine_parallel( const region_list_t<T> &a, const region_list_t<T> &b, Pred pred, size_t nthreads = 0 )
+{
+	if ( nthreads == 0 )
+		nthreads = std::max( 1U, std::thread::hardware_concurrency() );
+
+	region_list_t<T> retval;
+	__priv::region_parallel_sweep( retval, a, b, pred, nthreads );
+	return retval;
+}
+
+/// Parallel versions of the corresponding list operators, with
+/// identical results. Small inputs, where starting threads would
+/// cost more than it saves, are run on the calling thread.
+/// @{
+template <typename T>
+region_list_t<T> parallel_and( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads = 0 );
+template <typename T>
+region_list_t<T> parallel_or( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads = 0 );
+template <typename T>
+region_list_t<T> parallel_xor( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads = 0 );
+template <typename T>
+region_list_t<T> parallel_not_in( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads = 0 );
+/// @}
+
+/// @brief Working memory for the _into operations
+///
+/// Holds the sweep and merge buffers. Once they, and the output
+/// list, have grown to fit the inputs, the _into operations don't
+/// allocate, so per frame code can keep a scratch (per thread, it
+/// must not be shared by threads running at the same time) and
+/// reuse its output lists.
+template <typename T>
+using region_scratch_t = __priv::region_sweep_scratch<region_t<T>>;
+typedef region_scratch_t<int> region_scratch;
+
+/// @brief out = a & b, a | b, a ^ b, not_in( a, b ) and ~a, reusing
+/// the capacity of out and scratch
+///
+/// The results are the same as the operators'. out may be the same
+/// list as an input, and a single region operand is used directly
+/// instead of being copied into a temporary list.
+/// @{
+template <typename T>
+void intersect_into( region_list_t<T> &out, const region_list_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void intersect_into( region_list_t<T> &out, const region_list_t<T> &a, const region_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void union_into( region_list_t<T> &out, const region_list_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void union_into( region_list_t<T> &out, const region_list_t<T> &a, const region_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void xor_into( region_list_t<T> &out, const region_list_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void xor_into( region_list_t<T> &out, const region_list_t<T> &a, const region_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void not_in_into( region_list_t<T> &out, const region_list_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void not_in_into( region_list_t<T> &out, const region_list_t<T> &a, const region_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void not_in_into( region_list_t<T> &out, const region_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch );
+template <typename T>
+void complement_into( region_list_t<T> &out, const region_list_t<T> &a, region_scratch_t<T> &scratch );
+/// @}
+
+/// @brief Queries answered by the sweep directly
+///
+/// These give the same answers as building a & b, not_in( b, a )
+/// or a ^ b and looking at the result, but nothing is stored, and
+/// the sweep stops as soon as the answer is known.
+///
+/// intersection_area is the area covered by both, counting
+/// pixels for integer coordinates, and infinity when the overlap
+/// reaches an infinite edge (for either kind of coordinate).
+/// any_overlap is true if some point is covered by
+/// both, covers if every point covered by b is covered by a, and
+/// equal_coverage if a and b cover exactly the same points.
+/// @{
+template <typename T>
+double intersection_area( const region_list_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+double intersection_area( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+bool any_overlap( const region_list_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+bool any_overlap( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+bool covers( const region_list_t<T> &a, const region_list_t<T> &b );
+template <typename T>
+bool covers( const region_list_t<T> &a, const region_t<T> &b );
+template <typename T>
+bool equal_coverage( const region_list_t<T> &a, const region_list_t<T> &b );
 /// @}
 
 }
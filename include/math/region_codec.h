@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+#include "region.h"
+#include "../impl/varint.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Appends the binary encoding of an integer region list to out
+///
+/// The list is written in banded form (see canonicalize), so lists
+/// covering the same area encode to the same bytes. Everything is a
+/// variable length integer (7 bits a byte), signed deltas zig-zag
+/// encoded so small steps either way take a byte:
+///
+///     rect count
+///     per band:  bottom - top of the previous band (signed),
+///                top - bottom, run count
+///     per run:   first in band: left - first left of the previous
+///                band (signed), others: left - right of the previous
+///                run, then right - left
+///
+/// The deltas are taken modulo 2^64, so infinite regions round trip
+/// too. Only int and int64_t coordinates are supported.
+template <typename T>
+void encode_regions( std::vector<uint8_t> &out, const region_list_t<T> &l );
+
+/// @brief Iterates the regions of an encoded list in place
+///
+/// Nothing is copied or allocated, the regions are decoded from the
+/// buffer (which must outlive the decoder and its iterators) as the
+/// iterator advances, in banded order. Malformed or truncated data
+/// throws std::runtime_error, either here or when advancing.
+template <typename T>
+class region_decoder_t
+{
+	static_assert( std::is_integral<T>::value, "region encoding is for integer coordinates" );
+
+public:
+	typedef region_t<T> region_type;
+
+	class const_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef region_type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const region_type *pointer;
+		typedef const region_type &reference;
+
+		const_iterator( void ) {}
+
+		reference operator*( void ) const { return myRegion; }
+		pointer operator->( void ) const { return &myRegion; }
+
+		const_iterator &operator++( void ) { if ( --myLeft > 0 ) next(); return *this; }
+		const_iterator operator++( int ) { const_iterator r = *this; ++(*this); return r; }
+
+		bool operator==( const const_iterator &o ) const { return myLeft == o.myLeft; }
+		bool operator!=( const const_iterator &o ) const { return !( *this == o ); }
+
+		/// the byte after the last one decoded
+		const uint8_t *position( void ) const { return myP; }
+
+	private:
+		friend class region_decoder_t;
+		const_iterator( const uint8_t *p, const uint8_t *end, size_t n )
+			: myP( p ), myEnd( end ), myLeft( n )
+		{
+			if ( myLeft > 0 )
+				next();
+		}
+
+		inline void next( void );
+		static T value( uint64_t v ) { return static_cast<T>( static_cast<int64_t>( v ) ); }
+
+		const uint8_t *myP = nullptr;
+		const uint8_t *myEnd = nullptr;
+		/// regions left, including the current one
+		size_t myLeft = 0;
+		/// runs left in the current band
+		uint64_t myRuns = 0;
+		uint64_t myBottom = 0;
+		uint64_t myTop = 0;
+		uint64_t myFirstLeft = 0;
+		uint64_t myRight = 0;
+		region_type myRegion;
+	};
+
+	region_decoder_t( void ) {}
+	/// reads the header, throwing if there isn't one
+	region_decoder_t( const uint8_t *data, size_t size )
+		: myData( data ), myEnd( data + size )
+	{
+		mySize = static_cast<size_t>( __priv::varint_read( myData, myEnd ) );
+	}
+	explicit region_decoder_t( const std::vector<uint8_t> &buf )
+		: region_decoder_t( buf.data(), buf.size() )
+	{}
+
+	/// number of regions
+	size_t size( void ) const { return mySize; }
+	bool empty( void ) const { return mySize == 0; }
+
+	const_iterator begin( void ) const { return const_iterator( myData, myEnd, mySize ); }
+	const_iterator end( void ) const { return const_iterator(); }
+
+private:
+	const uint8_t *myData = nullptr;
+	const uint8_t *myEnd = nullptr;
+	size_t mySize = 0;
+};
+
+typedef region_decoder_t<int> region_decoder;
+typedef region_decoder_t<int64_t> region64_decoder;
+
+/// @brief Replaces out with the list encoded in [data, data + size)
+///
+/// Unlike iterating a decoder, this also checks the buffer holds
+/// nothing past the list.
+template <typename T>
+void decode_regions( region_list_t<T> &out, const uint8_t *data, size_t size );
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+inline void
+region_decoder_t<T>::const_iterator::next( void )
+{
+	using __priv::varint_read;
+	using __priv::zigzag_decode;
+
+	if ( myRuns == 0 )
+	{
+		myBottom = myTop + zigzag_decode( varint_read( myP, myEnd ) );
+		myTop = myBottom + varint_read( myP, myEnd );
+		myRuns = varint_read( myP, myEnd );
+		if ( myRuns == 0 )
+			throw std::runtime_error( "Empty band in encoded region list" );
+		myFirstLeft += zigzag_decode( varint_read( myP, myEnd ) );
+		myRight = myFirstLeft;
+	}
+	else
+		myRight += varint_read( myP, myEnd );
+
+	uint64_t left = myRight;
+	myRight = left + varint_read( myP, myEnd );
+	--myRuns;
+	myRegion = region_type( value( left ), value( myRight ), value( myBottom ), value( myTop ) );
+}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
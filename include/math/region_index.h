@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "region.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Static spatial index over a region_list
+///
+/// A bulk loaded, packed R-tree: the (non-empty) regions are sorted
+/// along a Hilbert curve through their centers, then grouped
+/// node_size at a time, bottom up, into parent bounding boxes. All
+/// the nodes live in one flat array, level by level with the leaves
+/// first, so a query walks contiguous memory and there is no per
+/// node allocation. Queries return indices into the list the index
+/// was built from.
+///
+/// The index does not track changes to the list, rebuild it
+/// (O(n log n)) when the list changes.
+class region_index
+{
+public:
+	typedef region::value_type value_type;
+
+	region_index( void ) {}
+	explicit region_index( const region_list &l, size_t node_size = 16 ) { build( l, node_size ); }
+
+	void build( const region_list &l, size_t node_size = 16 );
+	void clear( void );
+
+	/// number of (non-empty) regions indexed
+	size_t size( void ) const { return myLevels.empty() ? 0 : myLevels.front(); }
+	bool empty( void ) const { return size() == 0; }
+	/// bounding box of everything in the index
+	region bounds( void ) const { return myBoxes.empty() ? region() : myBoxes.back(); }
+
+	/// @brief Calls v( index ) for every region intersecting q, in
+	/// no particular order. If v returns false, the search stops.
+	template <typename Visitor>
+	void visit( const region &q, Visitor v ) const;
+
+	/// @brief Indices of all the regions intersecting q (which may
+	/// be a single point), stopping after max_results if provided
+	/// @{
+	size_t query( const region &q, std::vector<uint32_t> &out, size_t max_results = size_t(-1) ) const;
+	size_t query( value_type x, value_type y, std::vector<uint32_t> &out, size_t max_results = size_t(-1) ) const;
+	/// @}
+
+	/// @brief true if any region intersects q
+	bool any( const region &q ) const;
+
+	/// @brief Indices of (up to) the k regions closest to the point,
+	/// closest first. Regions containing the point have distance 0.
+	size_t nearest( value_type x, value_type y, size_t k, std::vector<uint32_t> &out ) const;
+
+private:
+	size_t myNodeSize = 16;
+	// all nodes, level by level, leaves first, the root last
+	std::vector<region> myBoxes;
+	// leaves: index into the source list, others: first child
+	std::vector<uint32_t> myIndex;
+	// end of each level in myBoxes
+	std::vector<size_t> myLevels;
+};
+
+
+////////////////////////////////////////
+
+
+template <typename Visitor>
+inline void
+region_index::visit( const region &q, Visitor v ) const
+{
+	if ( myBoxes.empty() || ! myBoxes.back().intersects( q ) )
+		return;
+
+	struct entry { size_t pos, level; };
+	entry stackbuf[64];
+	std::vector<entry> overflow;
+	size_t depth = 0;
+
+	stackbuf[depth++] = entry{ myBoxes.size() - 1, myLevels.size() - 1 };
+	while ( depth > 0 || ! overflow.empty() )
+	{
+		entry n;
+		if ( ! overflow.empty() )
+		{
+			n = overflow.back();
+			overflow.pop_back();
+		}
+		else
+			n = stackbuf[--depth];
+
+		size_t first = myIndex[n.pos];
+		size_t last = std::min( first + myNodeSize, myLevels[n.level - 1] );
+		for ( size_t c = first; c != last; ++c )
+		{
+			if ( ! myBoxes[c].intersects( q ) )
+				continue;
+			if ( n.level == 1 )
+			{
+				if ( ! v( myIndex[c] ) )
+					return;
+			}
+			else if ( depth < 64 )
+				stackbuf[depth++] = entry{ c, n.level - 1 };
+			else
+				overflow.push_back( entry{ c, n.level - 1 } );
+		}
+	}
+}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
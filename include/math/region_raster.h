@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+
+#include "region.h"
+#include "../impl/aligned_allocator.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief A run of covered pixels [x0, x1) on scanline y
+struct coverage_span
+{
+	int y, x0, x1;
+
+	bool operator==( const coverage_span &o ) const { return y == o.y && x0 == o.x0 && x1 == o.x1; }
+	bool operator!=( const coverage_span &o ) const { return !( *this == o ); }
+};
+
+/// @brief Walks the pixels covered by a region list, a scanline at a
+/// time, without building a mask
+///
+/// The list is clipped to a finite window and brought into banded
+/// form (see canonicalize) once, in O(n log n). The spans are then
+/// generated from the bands: scanlines bottom to top, and on each
+/// scanline sorted, disjoint spans, none of which touch. Overlapping
+/// input regions therefore never produce the same pixel twice.
+class region_spans
+{
+public:
+	class const_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef coverage_span value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const coverage_span *pointer;
+		typedef const coverage_span &reference;
+
+		const_iterator( void ) {}
+
+		reference operator*( void ) const { return mySpan; }
+		pointer operator->( void ) const { return &mySpan; }
+
+		const_iterator &operator++( void );
+		const_iterator operator++( int ) { const_iterator r = *this; ++(*this); return r; }
+
+		bool operator==( const const_iterator &o ) const { return myCur == o.myCur && mySpan.y == o.mySpan.y; }
+		bool operator!=( const const_iterator &o ) const { return !( *this == o ); }
+
+	private:
+		friend class region_spans;
+		const_iterator( const region *b, const region *e );
+		void load( void ) { mySpan.x0 = myCur->left(); mySpan.x1 = myCur->right() + 1; }
+
+		const region *myBand = nullptr;
+		const region *myBandEnd = nullptr;
+		const region *myCur = nullptr;
+		const region *myEnd = nullptr;
+		coverage_span mySpan{ 0, 0, 0 };
+	};
+
+	/// throws if clip is infinite
+	region_spans( const region_list &l, const region &clip );
+
+	const_iterator begin( void ) const { return const_iterator( myBands.data(), myBands.data() + myBands.size() ); }
+	const_iterator end( void ) const { const region *e = myBands.data() + myBands.size(); return const_iterator( e, e ); }
+
+	const region &clip( void ) const { return myClip; }
+	/// the clipped list, in banded form
+	const region_list &bands( void ) const { return myBands; }
+
+	/// @brief calls f( y, x0, x1 ) for every span, in the same order
+	/// as the iterators, with less overhead
+	template <typename F>
+	void for_each( F f ) const;
+
+private:
+	region myClip;
+	region_list myBands;
+};
+
+/// @brief 1 bit per pixel coverage of a rectangular window
+///
+/// Rows go bottom to top, each padded to a multiple of 128 bits and
+/// 16 byte aligned. Bit i of word w in a row is the pixel at
+/// x = bounds().left() + w * 64 + i. Padding bits are always clear.
+class coverage_mask
+{
+public:
+	typedef std::vector<uint64_t, __priv::aligned_allocator<uint64_t, 16>> storage_type;
+
+	coverage_mask( void ) {}
+	/// an empty mask over bounds, which must be finite
+	explicit coverage_mask( const region &bounds );
+	/// rasterizes the part of the list inside bounds
+	coverage_mask( const region_list &l, const region &bounds );
+
+	const region &bounds( void ) const { return myBounds; }
+	int width( void ) const { return myBounds.empty() ? 0 : myBounds.size_x(); }
+	int height( void ) const { return myBounds.empty() ? 0 : myBounds.size_y(); }
+	size_t words_per_row( void ) const { return myStride; }
+
+	uint64_t *row( int y ) { return myBits.data() + size_t( y - myBounds.bottom() ) * myStride; }
+	const uint64_t *row( int y ) const { return myBits.data() + size_t( y - myBounds.bottom() ) * myStride; }
+
+	bool test( int x, int y ) const;
+	void set( int x, int y );
+	/// sets [x0, x1) on scanline y, clipped to the bounds
+	void fill_span( int y, int x0, int x1 );
+	void clear( void );
+
+	/// number of pixels set
+	size_t count( void ) const;
+
+	/// @brief covered area as a list in banded form
+	region_list to_list( void ) const;
+
+	bool operator==( const coverage_mask &o ) const { return myBounds == o.myBounds && myBits == o.myBits; }
+	bool operator!=( const coverage_mask &o ) const { return !( *this == o ); }
+
+private:
+	region myBounds;
+	size_t myStride = 0;
+	storage_type myBits;
+};
+
+/// @brief Run length encoded coverage of a rectangular window
+///
+/// The covered [x0, x1) runs of each scanline, sorted and maximal,
+/// stored in one array with a per scanline offset, so a row's runs
+/// are contiguous.
+class coverage_rle
+{
+public:
+	struct run
+	{
+		int x0, x1;
+
+		bool operator==( const run &o ) const { return x0 == o.x0 && x1 == o.x1; }
+		bool operator!=( const run &o ) const { return !( *this == o ); }
+	};
+
+	coverage_rle( void ) {}
+	/// encodes the part of the list inside clip (which must be finite)
+	coverage_rle( const region_list &l, const region &clip );
+	explicit coverage_rle( const coverage_mask &m );
+
+	const region &bounds( void ) const { return myBounds; }
+	size_t run_count( void ) const { return myRuns.size(); }
+
+	/// runs of scanline y, which must be inside bounds
+	/// @{
+	const run *row_begin( int y ) const { return myRuns.data() + myRows[size_t( y - myBounds.bottom() )]; }
+	const run *row_end( int y ) const { return myRuns.data() + myRows[size_t( y - myBounds.bottom() ) + 1]; }
+	/// @}
+
+	region_list to_list( void ) const;
+	coverage_mask to_mask( void ) const;
+
+	bool operator==( const coverage_rle &o ) const { return myBounds == o.myBounds && myRows == o.myRows && myRuns == o.myRuns; }
+	bool operator!=( const coverage_rle &o ) const { return !( *this == o ); }
+
+private:
+	void start( const region &bounds );
+
+	region myBounds;
+	std::vector<uint32_t> myRows;
+	std::vector<run> myRuns;
+};
+
+
+////////////////////////////////////////
+
+
+template <typename F>
+inline void
+region_spans::for_each( F f ) const
+{
+	const region *b = myBands.data();
+	const region *e = b + myBands.size();
+	while ( b != e )
+	{
+		const region *be = __priv::region_band_end( b, e );
+		for ( int y = b->bottom(); ; ++y )
+		{
+			for ( const region *r = b; r != be; ++r )
+				f( y, r->left(), r->right() + 1 );
+			if ( y == b->top() )
+				break;
+		}
+		b = be;
+	}
+}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
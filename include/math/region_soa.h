@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "region.h"
+#include "../impl/aligned_allocator.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Structure of arrays storage of many regions for batched
+/// queries
+///
+/// The left, right, bottom and top coordinates are kept in separate
+/// 32 byte aligned arrays, so a query can be tested against 4 (SSE2)
+/// or 8 (AVX2, picked at run time when the cpu supports it) regions
+/// per instruction. Each query has the same semantics as the scalar
+/// member of region it is named after, and comes in two flavors:
+/// a bit mask (bit i of word i / 64 set when entry i matches) or a
+/// compacted list of the indices that match, both returning the
+/// number of matches.
+class region_soa
+{
+public:
+	typedef region::value_type value_type;
+	typedef std::vector<value_type, __priv::aligned_allocator<value_type, 32>> array_type;
+
+	region_soa( void ) {}
+	explicit region_soa( const region_list &l );
+
+	size_t size( void ) const { return myL.size(); }
+	bool empty( void ) const { return myL.empty(); }
+	void reserve( size_t n );
+	void clear( void );
+	void push_back( const region &r );
+	void assign( const region_list &l );
+
+	region operator[]( size_t i ) const { return region( myL[i], myR[i], myB[i], myT[i] ); }
+
+	const value_type *left( void ) const { return myL.data(); }
+	const value_type *right( void ) const { return myR.data(); }
+	const value_type *bottom( void ) const { return myB.data(); }
+	const value_type *top( void ) const { return myT.data(); }
+
+	/// entries for which entry.intersects( q )
+	/// @{
+	size_t intersects( const region &q, std::vector<uint64_t> &mask ) const;
+	size_t intersects( const region &q, std::vector<uint32_t> &indices ) const;
+	/// @}
+
+	/// entries for which entry.inside( q )
+	/// @{
+	size_t inside( const region &q, std::vector<uint64_t> &mask ) const;
+	size_t inside( const region &q, std::vector<uint32_t> &indices ) const;
+	/// @}
+
+	/// entries for which q.inside( entry )
+	/// @{
+	size_t contains( const region &q, std::vector<uint64_t> &mask ) const;
+	size_t contains( const region &q, std::vector<uint32_t> &indices ) const;
+	/// @}
+
+	/// entries for which entry.contains( x, y )
+	/// @{
+	size_t contains( value_type x, value_type y, std::vector<uint64_t> &mask ) const;
+	size_t contains( value_type x, value_type y, std::vector<uint32_t> &indices ) const;
+	/// @}
+
+	/// @brief which kernel is in use: "avx2", "sse2" or "scalar"
+	static const char *kernel_name( void );
+
+private:
+	array_type myL, myR, myB, myT;
+};
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
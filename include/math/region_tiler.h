@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include "region.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief One tile with some coverage
+struct region_tile
+{
+	/// tile index: the tile spans [tx * tile width, (tx + 1) * tile width)
+	int tx, ty;
+	/// the tile, clipped to the tiler's window
+	region bounds;
+	/// number of covered pixels in bounds
+	uint64_t covered;
+	/// the covered part of the tile in region_tiler::rects()
+	size_t first, last;
+
+	/// every pixel of bounds is covered
+	bool full( void ) const { return covered == uint64_t( bounds.size_x() ) * uint64_t( bounds.size_y() ); }
+};
+
+/// @brief Splits the area covered by a region list into aligned tiles
+///
+/// The list is clipped to a finite window, banded (see canonicalize)
+/// and cut at multiples of the tile size. Only tiles with some
+/// coverage are kept, in row (ty, then tx) order. Each keeps its
+/// covered pixel count and its own (disjoint, banded) part of the
+/// regions, so a worker handed a tile touches only covered pixels
+/// of a cache sized block.
+///
+/// The parallel drivers hand tiles out to nthreads workers (0
+/// meaning one per hardware thread) one at a time, so uneven tiles
+/// balance out. The callback is called concurrently, but never
+/// twice for the same tile at once. An exception thrown from it is
+/// rethrown on the calling thread once the workers have stopped.
+class region_tiler
+{
+public:
+	typedef std::vector<region_tile>::const_iterator const_iterator;
+
+	/// throws if clip is infinite or a tile size is not positive
+	region_tiler( const region_list &l, const region &clip, int tile_w = 64, int tile_h = 64 );
+
+	int tile_width( void ) const { return myTileW; }
+	int tile_height( void ) const { return myTileH; }
+	const region &clip( void ) const { return myClip; }
+
+	size_t size( void ) const { return myTiles.size(); }
+	bool empty( void ) const { return myTiles.empty(); }
+	const region_tile &operator[]( size_t i ) const { return myTiles[i]; }
+	const_iterator begin( void ) const { return myTiles.begin(); }
+	const_iterator end( void ) const { return myTiles.end(); }
+
+	/// all the tiles' rects, grouped by tile
+	const region_list &rects( void ) const { return myRects; }
+	const region *rects_begin( const region_tile &t ) const { return myRects.data() + t.first; }
+	const region *rects_end( const region_tile &t ) const { return myRects.data() + t.last; }
+
+	/// total number of covered pixels
+	uint64_t covered( void ) const;
+
+	/// @brief calls f( tile, rects_begin, rects_end ) for each tile
+	template <typename F>
+	void for_each_tile( F f, size_t nthreads = 0 ) const;
+
+	/// @brief calls f( y, x0, x1 ) for each covered [x0, x1) span,
+	/// a tile at a time (bottom to top within a tile)
+	template <typename F>
+	void for_each_span( F f, size_t nthreads = 0 ) const;
+
+private:
+	static void run( size_t ntiles, size_t nthreads, const std::function<void ( size_t )> &work );
+
+	region myClip;
+	int myTileW, myTileH;
+	std::vector<region_tile> myTiles;
+	region_list myRects;
+};
+
+/// @brief Visits the spans of l inside clip in parallel, tile by tile
+template <typename F>
+inline void
+for_each_span( const region_list &l, const region &clip, F f,
+			   int tile_w = 64, int tile_h = 64, size_t nthreads = 0 )
+{
+	region_tiler( l, clip, tile_w, tile_h ).for_each_span( f, nthreads );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename F>
+inline void
+region_tiler::for_each_tile( F f, size_t nthreads ) const
+{
+	run( myTiles.size(), nthreads,
+		 [&]( size_t i )
+		 {
+			 const region_tile &t = myTiles[i];
+			 f( t, rects_begin( t ), rects_end( t ) );
+		 } );
+}
+
+template <typename F>
+inline void
+region_tiler::for_each_span( F f, size_t nthreads ) const
+{
+	run( myTiles.size(), nthreads,
+		 [&]( size_t i )
+		 {
+			 const region_tile &t = myTiles[i];
+			 const region *e = rects_end( t );
+			 for ( const region *b = rects_begin( t ); b != e; )
+			 {
+				 const region *be = __priv::region_band_end( b, e );
+				 for ( int y = b->bottom(); ; ++y )
+				 {
+					 for ( const region *r = b; r != be; ++r )
+						 f( y, r->left(), r->right() + 1 );
+					 if ( y == b->top() )
+						 break;
+				 }
+				 b = be;
+			 }
+		 } );
+}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
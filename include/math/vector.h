@@ -24,12 +24,15 @@
 
 #include <cstddef>
 #include <cmath>
-#include <array>
 #include <limits>
 #include <algorithm>
+#include <initializer_list>
 #include <type_traits>
 #include <stdexcept>
 
+#include "../impl/vector_pack.h"
+#include "const_matrix.h"
+
 namespace yaco
 {
 
@@ -37,22 +40,119 @@ namespace math
 {
 
 template <typename Storage, size_t dim>
-class vector<Storage, dim>
+class vector;
+
+/// @brief Base of everything that evaluates to a vector<T, dim>
+///
+/// The arithmetic operators don't compute anything, they return
+/// small nodes describing the expression, and the whole expression
+/// is evaluated when it is assigned to (or used to construct) a
+/// vector. So a * s + b - c is computed in one pass, a SIMD
+/// register at a time where there is a SIMD version of the
+/// vector, with no temporary vectors. The nodes hold the vectors
+/// they use by reference, so an expression must not outlive them
+/// (keeping one in an auto variable is asking for trouble).
+template <typename E, typename T, size_t dim>
+struct vector_expr
+{
+	typedef T value_type;
+	typedef __priv::vector_pack<T, dim> pack_ops;
+	typedef typename pack_ops::type pack_type;
+
+	const E &self( void ) const { return static_cast<const E &>( *this ); }
+	pack_type pack( void ) const { return self().pack(); }
+};
+
+namespace __expr
+{
+
+/// nodes are held by value, vectors by reference
+template <typename E>
+struct ref { typedef const E type; };
+template <typename T, size_t dim>
+struct ref<vector<T, dim>> { typedef const vector<T, dim> &type; };
+
+struct add_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::add( a, b ); } };
+struct sub_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::sub( a, b ); } };
+struct mul_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::mul( a, b ); } };
+struct div_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::div( a, b ); } };
+struct min_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::min( a, b ); } };
+struct max_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::max( a, b ); } };
+struct cross_op { template <typename P, typename A> static A apply( const A &a, const A &b ) { return P::cross( a, b ); } };
+
+template <typename Op, typename L, typename R, typename T, size_t dim>
+struct binary : public vector_expr<binary<Op, L, R, T, dim>, T, dim>
 {
+	typedef __priv::vector_pack<T, dim> pack_ops;
+
+	binary( const L &l, const R &r ) : myL( l ), myR( r ) {}
+	typename pack_ops::type pack( void ) const { return Op::template apply<pack_ops>( myL.pack(), myR.pack() ); }
+
+	typename ref<L>::type myL;
+	typename ref<R>::type myR;
+};
+
+/// a scalar used as a vector with every element s
+template <typename T, size_t dim>
+struct scalar : public vector_expr<scalar<T, dim>, T, dim>
+{
+	typedef __priv::vector_pack<T, dim> pack_ops;
+
+	explicit scalar( T s ) : myS( s ) {}
+	typename pack_ops::type pack( void ) const { return pack_ops::set1( myS ); }
+
+	T myS;
+};
+
+} // namespace __expr
+
+
+////////////////////////////////////////
+
+
+/// @brief Fixed size vector of floating point values
+///
+/// The float and double vectors of 2 to 4 elements are computed
+/// with SSE (or AVX for 3 and 4 doubles when the code is built for
+/// it). A 3 element vector is then stored as 4 elements so it can
+/// be loaded in one go, and the SIMD vectors are 8 or 16 byte
+/// aligned. Other sizes and types use plain loops.
+template <typename Storage, size_t dim>
+class vector : public vector_expr<vector<Storage, dim>, Storage, dim>
+{
+	static_assert( dim > 0, "vector dimension of 0 is non-sensical" );
+	static_assert( std::is_floating_point<Storage>::value, "vector is for floating point values" );
+
 public:
-	typedef typename std::enable_if<std::is_floating_point<Storage>::value>::type value_type;
+	typedef Storage value_type;
+	typedef __priv::vector_pack<Storage, dim> pack_ops;
+	typedef typename pack_ops::type pack_type;
 	static const size_t size = dim;
 
 	vector( void )
 	{
-		static_assert( dim > 0, "vector dimension of 0 is non-sensical" );
-		myV.fill( static_cast<value_type>( 0 ) );
+		std::fill( myV, myV + pack_ops::storage, value_type( 0 ) );
 	}
 	vector( std::initializer_list<value_type> i )
 	{
-		set( std::move( i ) );
+		set( i );
+	}
+	template <typename E>
+	vector( const vector_expr<E, value_type, dim> &e )
+	{
+		assign( e );
+	}
+	template <typename O>
+	explicit vector( const vector<O, dim> &o )
+	{
+		*this = o;
+	}
+	/// usable in a constant expression, so a table computed at
+	/// compile time can be a constexpr vector
+	constexpr vector( const const_vector<value_type, dim> &c )
+		: vector( c, typename gen_sequence<dim>::type() )
+	{
 	}
-	~vector( void ) {}
 
 	template <typename O>
 	vector &operator=( const vector<O, dim> &o )
@@ -61,57 +161,60 @@ public:
 			myV[i] = static_cast<value_type>( o[i] );
 		return *this;
 	}
+	template <typename E>
+	vector &operator=( const vector_expr<E, value_type, dim> &e )
+	{
+		assign( e );
+		return *this;
+	}
 	vector &operator=( std::initializer_list<value_type> i )
 	{
-		set( std::move( i ) );
+		set( i );
 		return *this;
 	}
 
+	/// sets the elements from i, filling any left over with 0
 	void set( std::initializer_list<value_type> i )
 	{
 		auto v = i.begin();
-		size_t i = 0, N = std::min( size, i.size() );
-		for ( i = 0, N = ; i != N; ++i, ++v )
-			myV[i] = v;
-		for ( ; i < size; ++i )
-			myV[i] = static_cast<value_type>( 0 );
+		size_t n = std::min( size, i.size() ), x = 0;
+		for ( ; x != n; ++x, ++v )
+			myV[x] = *v;
+		for ( ; x < pack_ops::storage; ++x )
+			myV[x] = static_cast<value_type>( 0 );
 	}
 
 	value_type magnitude( void ) const { return std::sqrt( mag_squared() ); }
-	value_type mag_squared( void ) const
-	{
-		value_type r = static_cast<value_type>( 0 );
-		for ( size_t i = 0; i != size; ++i )
-		{
-			value_type t = myV[i];
-			r += t * t;
-		}
-		return r;
-	}
+	value_type mag_squared( void ) const { return dot( *this ); }
 
+	/// scales to unit length, unless the length is (nearly) 0,
+	/// returning the length
 	value_type normalize( void )
 	{
 		value_type l = magnitude();
 		if ( l > std::numeric_limits<value_type>::epsilon() )
-		{
-			for ( size_t i = 0; i != size; ++i )
-				myV[i] /= l;
-		}
+			*this /= l;
 		return l;
 	}
 
 	value_type &operator[]( size_t i ) { return myV[i]; }
-	value_type operator[]( size_t i ) const { return myV[i]; }
+	constexpr value_type operator[]( size_t i ) const { return myV[i]; }
+
+	value_type &at( size_t i ) { check( i ); return myV[i]; }
+	value_type at( size_t i ) const { check( i ); return myV[i]; }
 
-	value_type &at( size_t i ) { return myV.at( i ); }
-	value_type at( size_t i ) const { return myV.at( i ); }
+	value_type *data( void ) { return myV; }
+	const value_type *data( void ) const { return myV; }
+	value_type *begin( void ) { return myV; }
+	const value_type *begin( void ) const { return myV; }
+	value_type *end( void ) { return myV + size; }
+	const value_type *end( void ) const { return myV + size; }
 
-	value_type *data( void ) { return myV.data(); }
-	const value_type *data( void ) const { return myV.data(); }
+	pack_type pack( void ) const { return pack_ops::load( myV ); }
 
 	bool operator==( const vector &o ) const
 	{
-		return std::equal( myV.begin(), myV.end(), o.begin() );
+		return std::equal( begin(), end(), o.begin() );
 	}
 
 	bool operator!=( const vector &o ) const
@@ -119,221 +222,146 @@ public:
 		return !( *this == o );
 	}
 
-	vector &operator+=( const value_type &v )
-	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] += v;
-		return *this;
-	}
-	vector &operator-=( const value_type &v )
-	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] -= v;
-		return *this;
-	}
-	vector &operator*=( const value_type &v )
-	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] *= v;
-		return *this;
-	}
-	vector &operator/=( const value_type &v )
+	vector &operator+=( value_type v ) { return *this = *this + v; }
+	vector &operator-=( value_type v ) { return *this = *this - v; }
+	vector &operator*=( value_type v ) { return *this = *this * v; }
+	vector &operator/=( value_type v ) { return *this = *this / v; }
+
+	template <typename E>
+	vector &operator+=( const vector_expr<E, value_type, dim> &e ) { return *this = *this + e; }
+	template <typename E>
+	vector &operator-=( const vector_expr<E, value_type, dim> &e ) { return *this = *this - e; }
+	/// element by element
+	/// @{
+	template <typename E>
+	vector &operator*=( const vector_expr<E, value_type, dim> &e ) { return *this = *this * e; }
+	template <typename E>
+	vector &operator/=( const vector_expr<E, value_type, dim> &e ) { return *this = *this / e; }
+	/// @}
+
+	template <typename E>
+	value_type dot( const vector_expr<E, value_type, dim> &o ) const
 	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] /= v;
-		return *this;
+		return pack_ops::sum( pack_ops::mul( pack(), o.pack() ) );
 	}
 
-	vector &operator+=( const vector &v )
-	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] += v[i];
-		return *this;
-	}
-	vector &operator-=( const vector &v )
+private:
+	template <size_t... I>
+	constexpr vector( const const_vector<value_type, dim> &c, unpack_sequence<I...> )
+		: myV{ c.v[I]... }
 	{
-		for ( size_t i = 0; i != size; ++i )
-			myV[i] -= v[i];
-		return *this;
 	}
 
-	vector cross( const vector &o ) const
+	template <typename E>
+	void assign( const vector_expr<E, value_type, dim> &e )
 	{
+		pack_ops::store( myV, e.pack() );
 	}
 
-	value_type dot( const vector &o ) const
+	void check( size_t i ) const
 	{
-		value_type r = static_cast<value_type>( 0 );
-		for ( size_t i = 0; i != size; ++i )
-		{
-			r += myV[i] * o[i];
-		}
-		return r;
+		if ( i >= size )
+			throw std::out_of_range( "vector index out of range" );
 	}
-private:
-	std::array<value_type, size> myV;
-};
 
+	alignas(pack_ops::alignment) value_type myV[pack_ops::storage];
+};
 
-////////////////////////////////////////
-
-
-template <typename T, size_t dim>
-vector<T, dim> operator-( const vector<T, dim> &a )
-{
-	vector<T, dim> rv( a );
-	rv *= static_cast<T>( -1 );
-	return rv;
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator-( vector<T, dim> &&a )
-{
-	a *= static_cast<T>( -1 );
-	return std::move( a );
-}
-
-
-////////////////////////////////////////
-
-
-template <typename T, size_t dim>
-vector<T, dim> operator+( const vector<T, dim> &a, const T &v )
-{
-	vector<T, dim> rv( a );
-	rv += v;
-	return rv;
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator-( const vector<T, dim> &a, const T &v )
-{
-	vector<T, dim> rv( a );
-	rv -= v;
-	return rv;
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator*( const vector<T, dim> &a, const T &v )
-{
-	vector<T, dim> rv( a );
-	rv *= v;
-	return rv;
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator/( const vector<T, dim> &a, const T &v )
-{
-	vector<T, dim> rv( a );
-	rv /= v;
-	return rv;
-}
+template <typename Storage, size_t dim>
+const size_t vector<Storage, dim>::size;
 
 
 ////////////////////////////////////////
 
 
-template <typename T, size_t dim>
-vector<T, dim> operator+( vector<T, dim> &&a, const T &v )
-{
-	a += v;
-	return std::move( a );
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator-( vector<T, dim> &&a, const T &v )
-{
-	a -= v;
-	return std::move( a );
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator*( vector<T, dim> &&a, const T &v )
+#define YACO_VECTOR_BINARY_OP( op, node ) \
+	template <typename L, typename R, typename T, size_t dim> \
+	inline __expr::binary<__expr::node, L, R, T, dim> \
+	operator op( const vector_expr<L, T, dim> &a, const vector_expr<R, T, dim> &b ) \
+	{ return __expr::binary<__expr::node, L, R, T, dim>( a.self(), b.self() ); } \
+	template <typename L, typename T, size_t dim> \
+	inline __expr::binary<__expr::node, L, __expr::scalar<T, dim>, T, dim> \
+	operator op( const vector_expr<L, T, dim> &a, typename vector_expr<L, T, dim>::value_type s ) \
+	{ return __expr::binary<__expr::node, L, __expr::scalar<T, dim>, T, dim>( a.self(), __expr::scalar<T, dim>( s ) ); } \
+	template <typename R, typename T, size_t dim> \
+	inline __expr::binary<__expr::node, __expr::scalar<T, dim>, R, T, dim> \
+	operator op( typename vector_expr<R, T, dim>::value_type s, const vector_expr<R, T, dim> &b ) \
+	{ return __expr::binary<__expr::node, __expr::scalar<T, dim>, R, T, dim>( __expr::scalar<T, dim>( s ), b.self() ); }
+
+YACO_VECTOR_BINARY_OP( +, add_op )
+YACO_VECTOR_BINARY_OP( -, sub_op )
+/// element by element for two vectors
+YACO_VECTOR_BINARY_OP( *, mul_op )
+YACO_VECTOR_BINARY_OP( /, div_op )
+
+#undef YACO_VECTOR_BINARY_OP
+
+template <typename E, typename T, size_t dim>
+inline __expr::binary<__expr::mul_op, E, __expr::scalar<T, dim>, T, dim>
+operator-( const vector_expr<E, T, dim> &a )
 {
-	a *= v;
-	return std::move( a );
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator/( vector<T, dim> &&a, const T &v )
-{
-	a /= v;
-	return std::move( a );
+	return a * static_cast<T>( -1 );
 }
 
 
 ////////////////////////////////////////
 
 
-template <typename T, size_t dim>
-vector<T, dim> operator+( const T &v, const vector<T, dim> &a )
-{
-	vector<T, dim> rv( a );
-	rv += v;
-	return rv;
-}
-
-template <typename T, size_t dim>
-vector<T, dim> operator-( const T &v, const vector<T, dim> &a )
+template <typename L, typename R, typename T, size_t dim>
+inline T
+dot( const vector_expr<L, T, dim> &a, const vector_expr<R, T, dim> &b )
 {
-	vector<T, dim> rv( a );
-	rv *= static_cast<T>( -1 );
-	rv += v;
-	return rv;
+	typedef __priv::vector_pack<T, dim> P;
+	return P::sum( P::mul( a.pack(), b.pack() ) );
 }
 
-template <typename T, size_t dim>
-vector<T, dim> operator*( const T &v, const vector<T, dim> &a )
+template <typename L, typename R, typename T>
+inline __expr::binary<__expr::cross_op, L, R, T, 3>
+cross( const vector_expr<L, T, 3> &a, const vector_expr<R, T, 3> &b )
 {
-	vector<T, dim> rv( a );
-	rv *= v;
-	return rv;
+	return __expr::binary<__expr::cross_op, L, R, T, 3>( a.self(), b.self() );
 }
 
-
-////////////////////////////////////////
-
-
-template <typename T, size_t dim>
-vector<T, dim> operator+( const T &v, vector<T, dim> &&a )
+/// a + ( b - a ) * t
+template <typename L, typename R, typename T, size_t dim>
+inline auto
+lerp( const vector_expr<L, T, dim> &a, const vector_expr<R, T, dim> &b, typename vector_expr<L, T, dim>::value_type t )
+	-> decltype( a + ( b - a ) * t )
 {
-	a += v;
-	return std::move( a );
+	return a + ( b - a ) * t;
 }
 
-template <typename T, size_t dim>
-vector<T, dim> operator-( const T &v, vector<T, dim> &&a )
+/// element by element minimum and maximum
+/// @{
+template <typename L, typename R, typename T, size_t dim>
+inline __expr::binary<__expr::min_op, L, R, T, dim>
+min( const vector_expr<L, T, dim> &a, const vector_expr<R, T, dim> &b )
 {
-	a *= static_cast<T>( -1 );
-	a += v;
-	return std::move( a );
+	return __expr::binary<__expr::min_op, L, R, T, dim>( a.self(), b.self() );
 }
 
-template <typename T, size_t dim>
-vector<T, dim> operator*( const T &v, vector<T, dim> &&a )
+template <typename L, typename R, typename T, size_t dim>
+inline __expr::binary<__expr::max_op, L, R, T, dim>
+max( const vector_expr<L, T, dim> &a, const vector_expr<R, T, dim> &b )
 {
-	a *= v;
-	return std::move( a );
+	return __expr::binary<__expr::max_op, L, R, T, dim>( a.self(), b.self() );
 }
+/// @}
 
-
-////////////////////////////////////////
-
-
-template <typename T, size_t dim>
-vector<T, dim> operator+( const vector<T, dim> &a, const vector<T, dim> &b )
+template <typename E, typename T, size_t dim>
+inline T
+magnitude( const vector_expr<E, T, dim> &a )
 {
-	vector<T, dim> rv( a );
-	rv += b;
-	return rv;
+	return std::sqrt( dot( a, a ) );
 }
 
-template <typename T, size_t dim>
-vector<T, dim> operator-( const vector<T, dim> &a, const vector<T, dim> &b )
+template <typename E, typename T, size_t dim>
+inline vector<T, dim>
+normalize( const vector_expr<E, T, dim> &a )
 {
-	vector<T, dim> rv( a );
-	rv -= b;
-	return rv;
+	vector<T, dim> r( a );
+	r.normalize();
+	return r;
 }
 
 
@@ -361,4 +389,3 @@ typedef vector<long double, 4> dvec4;
 // mode: C++
 // End:
 // vim:ft=cpp:
-
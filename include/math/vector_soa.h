@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "vector.h"
+#include "matrix.h"
+#include "../impl/aligned_allocator.h"
+
+namespace yaco
+{
+
+namespace math
+{
+
+/// @brief Structure of arrays storage of many vectors for the batch
+/// transforms
+///
+/// Each component is kept in its own 32 byte aligned array, so the
+/// batch kernels can work on a SIMD register's worth of points at a
+/// time without any shuffling. The same storage is used for points,
+/// normals and directions, it's the kernel applied that decides
+/// which they are.
+template <typename T, size_t dim>
+class vector_soa
+{
+public:
+	typedef T value_type;
+	typedef vector<T, dim> vector_type;
+	typedef std::vector<T, __priv::aligned_allocator<T, 32>> array_type;
+
+	vector_soa( void ) {}
+	explicit vector_soa( size_t n ) { resize( n ); }
+
+	size_t size( void ) const { return myC[0].size(); }
+	bool empty( void ) const { return myC[0].empty(); }
+
+	void reserve( size_t n ) { for ( auto &c: myC ) c.reserve( n ); }
+	void resize( size_t n ) { for ( auto &c: myC ) c.resize( n ); }
+	void clear( void ) { for ( auto &c: myC ) c.clear(); }
+
+	void push_back( const vector_type &v )
+	{
+		for ( size_t c = 0; c != dim; ++c )
+			myC[c].push_back( v[c] );
+	}
+
+	vector_type operator[]( size_t i ) const
+	{
+		vector_type r;
+		for ( size_t c = 0; c != dim; ++c )
+			r[c] = myC[c][i];
+		return r;
+	}
+
+	void set( size_t i, const vector_type &v )
+	{
+		for ( size_t c = 0; c != dim; ++c )
+			myC[c][i] = v[c];
+	}
+
+	/// the array holding component c of every entry
+	/// @{
+	T *component( size_t c ) { return myC[c].data(); }
+	const T *component( size_t c ) const { return myC[c].data(); }
+	/// @}
+
+private:
+	array_type myC[dim];
+};
+
+typedef vector_soa<float, 3> fvec3_soa;
+typedef vector_soa<float, 4> fvec4_soa;
+typedef vector_soa<double, 3> vec3_soa;
+typedef vector_soa<double, 4> vec4_soa;
+
+
+////////////////////////////////////////
+
+
+/// The batch kernels are provided for float and double. Each one
+/// resizes out to match in, and gives the same result as applying
+/// the corresponding single vector function one entry at a time, up
+/// to rounding where the compiler contracts multiply-adds.
+/// out may be the same buffer as in.
+///
+/// Batches of at least vector_soa_parallel_min entries are split
+/// across nthreads threads (0 meaning one per hardware thread),
+/// smaller ones run on the calling thread where starting threads
+/// would cost more than it saves.
+/// @{
+static const size_t vector_soa_parallel_min = 65536;
+
+/// transform_point for each entry (w = 1, divided by the resulting
+/// w, which is skipped when the bottom row of m is 0 0 0 1)
+template <typename T>
+void transform_points( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads = 0 );
+
+/// transform_vector for each entry (w = 0)
+template <typename T>
+void transform_vectors( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads = 0 );
+
+/// transforms normals by the inverse transpose of the upper 3 x 3
+/// of m, renormalizing them as vector::normalize does. Throws if
+/// that is singular.
+template <typename T>
+void transform_normals( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads = 0 );
+
+/// the homogeneous m * ( x, y, z, 1 ), i.e. clip space for a
+/// projection matrix, with no divide
+template <typename T>
+void project_points( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 4> &out, size_t nthreads = 0 );
+
+/// ( x, y, z ) / w
+template <typename T>
+void perspective_divide( const vector_soa<T, 4> &in, vector_soa<T, 3> &out, size_t nthreads = 0 );
+
+/// vector::normalize for each entry, in place
+template <typename T>
+void normalize( vector_soa<T, 3> &v, size_t nthreads = 0 );
+
+/// @brief The smallest and largest value of each component
+///
+/// NaN entries are ignored. An empty buffer gives a min of +inf and
+/// a max of -inf.
+template <typename T>
+std::pair<vector<T, 3>, vector<T, 3>> bounding_box( const vector_soa<T, 3> &v, size_t nthreads = 0 );
+/// @}
+
+}
+
+}
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
@@ -23,7 +23,28 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
 #include "impl/config.h"
+#include "impl/aligned_allocator.h"
+
+#ifdef __linux__
+# include <sched.h>
+# include <unistd.h>
+# include <climits>
+# include <sys/syscall.h>
+# include <linux/futex.h>
+#else
+# include <condition_variable>
+#endif
 
 namespace yaco
 {
@@ -54,6 +75,396 @@ private:
 	mutex_type &__m;
 };
 
+
+namespace __priv
+{
+
+/// size used to keep independently updated atomics from sharing a cache line
+constexpr size_t cache_line_size = 64;
+
+/// @brief hint to the processor that we are in a spin-wait loop
+inline _YACO_INLINE void cpu_relax( void )
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__( "yield" );
+#endif
+}
+
+/// @brief returns a small integer identifying the processor the
+/// calling thread is (probably) running on.
+///
+/// This is only a hint used to spread counters around, the thread
+/// may migrate at any time.
+inline unsigned current_cpu_hint( void )
+{
+#ifdef __linux__
+	int c = ::sched_getcpu();
+	if ( c >= 0 )
+		return static_cast<unsigned>( c );
+#endif
+	return static_cast<unsigned>( std::hash<std::thread::id>()( std::this_thread::get_id() ) );
+}
+
+} // namespace __priv
+
+
+////////////////////////////////////////
+
+
+/// @brief Sequence lock protecting a small, trivially copyable value
+///
+/// Readers never write shared memory, so any number of them can take
+/// snapshots without bouncing a cache line between cores. A reader
+/// that races a writer simply retries. Writers are serialized against
+/// each other by the (odd) sequence number.
+///
+/// The writer side also meets the Lockable requirements, so a
+/// std::lock_guard (or unlock_guard) can hold off other writers
+/// across a read-modify-store sequence:
+///
+///   std::lock_guard<seqlock<config>> g( sl );
+///   config c = sl.load_locked();
+///   c.x = 3;
+///   sl.store_locked( c );
+template <typename T>
+class seqlock
+{
+public:
+	typedef T value_type;
+	static_assert( std::is_trivially_copyable<T>::value, "seqlock requires a trivially copyable type" );
+
+	seqlock( void ) : mySeq( 0 ) { put( value_type() ); }
+	explicit seqlock( const value_type &v ) : mySeq( 0 ) { put( v ); }
+
+	/// @brief returns a consistent snapshot of the value
+	value_type load( void ) const
+	{
+		word buf[word_count];
+		unsigned s0, s1;
+		do
+		{
+			s0 = mySeq.load( std::memory_order_acquire );
+			while ( s0 & 1 )
+			{
+				__priv::cpu_relax();
+				s0 = mySeq.load( std::memory_order_acquire );
+			}
+			for ( size_t i = 0; i != word_count; ++i )
+				buf[i] = myValue[i].load( std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_acquire );
+			s1 = mySeq.load( std::memory_order_relaxed );
+		} while ( s0 != s1 );
+
+		value_type ret;
+		std::memcpy( &ret, buf, sizeof(value_type) );
+		return ret;
+	}
+
+	void store( const value_type &v )
+	{
+		lock();
+		put( v );
+		unlock();
+	}
+
+	/// @brief begins a write, blocking other writers and
+	/// invalidating in-flight reads
+	void lock( void )
+	{
+		unsigned s = mySeq.load( std::memory_order_relaxed );
+		while ( true )
+		{
+			if ( ( s & 1 ) == 0 &&
+				 mySeq.compare_exchange_weak( s, s + 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+				break;
+			__priv::cpu_relax();
+			s = mySeq.load( std::memory_order_relaxed );
+		}
+		std::atomic_thread_fence( std::memory_order_release );
+	}
+
+	bool try_lock( void )
+	{
+		unsigned s = mySeq.load( std::memory_order_relaxed );
+		if ( ( s & 1 ) == 0 &&
+			 mySeq.compare_exchange_strong( s, s + 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+		{
+			std::atomic_thread_fence( std::memory_order_release );
+			return true;
+		}
+		return false;
+	}
+
+	void unlock( void ) { mySeq.fetch_add( 1, std::memory_order_release ); }
+
+	/// @brief reads the value, only valid while holding the (writer) lock
+	value_type load_locked( void ) const
+	{
+		word buf[word_count];
+		for ( size_t i = 0; i != word_count; ++i )
+			buf[i] = myValue[i].load( std::memory_order_relaxed );
+		value_type ret;
+		std::memcpy( &ret, buf, sizeof(value_type) );
+		return ret;
+	}
+
+	/// @brief updates the value, only valid while holding the (writer) lock
+	void store_locked( const value_type &v ) { put( v ); }
+
+	/// @brief the current sequence number, incremented twice per write
+	unsigned sequence( void ) const { return mySeq.load( std::memory_order_acquire ); }
+
+private:
+	seqlock( const seqlock & ) = delete;
+	seqlock &operator=( const seqlock & ) = delete;
+
+	// the value is kept as relaxed atomic words so a racing
+	// read is merely discarded rather than undefined
+	typedef std::uintptr_t word;
+	static const size_t word_count = ( sizeof(value_type) + sizeof(word) - 1 ) / sizeof(word);
+
+	void put( const value_type &v )
+	{
+		word buf[word_count] = {};
+		std::memcpy( buf, &v, sizeof(value_type) );
+		for ( size_t i = 0; i != word_count; ++i )
+			myValue[i].store( buf[i], std::memory_order_relaxed );
+	}
+
+	std::atomic<unsigned> mySeq;
+	std::atomic<word> myValue[word_count];
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Reader / writer lock tuned for read-mostly data
+///
+/// Instead of a single reader count that every reader has to
+/// modify (bouncing that cache line between all cores), readers
+/// increment a counter chosen by the cpu they run on, each on its
+/// own cache line. A writer raises a flag and then waits for the sum
+/// of all the counters to drain to zero, so writes are more expensive
+/// than with a traditional rw lock, and writers are preferred over
+/// new readers.
+///
+/// A reader that migrates between lock_shared and unlock_shared
+/// will leave one counter positive and another negative, which is
+/// fine as only the sum matters.
+///
+/// lock / unlock provide exclusive (writer) access and satisfy the
+/// Lockable requirements, so std::lock_guard and unlock_guard work
+/// as usual. Use shared_lock_guard for the reader side.
+class distributed_rw_mutex
+{
+public:
+	explicit distributed_rw_mutex( size_t nslots = 0 )
+			: myWriter( false ),
+			  mySlotCount( nslots ? nslots : std::max( 1U, std::thread::hardware_concurrency() ) ),
+			  mySlots( mySlotCount )
+	{
+	}
+
+	void lock_shared( void )
+	{
+		slot &s = mySlots[__priv::current_cpu_hint() % mySlotCount];
+		while ( true )
+		{
+			s.count.fetch_add( 1, std::memory_order_seq_cst );
+			if ( ! myWriter.load( std::memory_order_seq_cst ) )
+				return;
+			// back out and let the writer through
+			s.count.fetch_sub( 1, std::memory_order_release );
+			while ( myWriter.load( std::memory_order_relaxed ) )
+				__priv::cpu_relax();
+		}
+	}
+
+	bool try_lock_shared( void )
+	{
+		slot &s = mySlots[__priv::current_cpu_hint() % mySlotCount];
+		s.count.fetch_add( 1, std::memory_order_seq_cst );
+		if ( ! myWriter.load( std::memory_order_seq_cst ) )
+			return true;
+		s.count.fetch_sub( 1, std::memory_order_release );
+		return false;
+	}
+
+	void unlock_shared( void )
+	{
+		mySlots[__priv::current_cpu_hint() % mySlotCount].count.fetch_sub( 1, std::memory_order_release );
+	}
+
+	void lock( void )
+	{
+		bool expect = false;
+		while ( ! myWriter.compare_exchange_weak( expect, true, std::memory_order_seq_cst ) )
+		{
+			expect = false;
+			std::this_thread::yield();
+		}
+		while ( readers() != 0 )
+			__priv::cpu_relax();
+	}
+
+	bool try_lock( void )
+	{
+		bool expect = false;
+		if ( ! myWriter.compare_exchange_strong( expect, true, std::memory_order_seq_cst ) )
+			return false;
+		if ( readers() != 0 )
+		{
+			myWriter.store( false, std::memory_order_release );
+			return false;
+		}
+		return true;
+	}
+
+	void unlock( void ) { myWriter.store( false, std::memory_order_release ); }
+
+private:
+	distributed_rw_mutex( const distributed_rw_mutex & ) = delete;
+	distributed_rw_mutex &operator=( const distributed_rw_mutex & ) = delete;
+
+	long readers( void ) const
+	{
+		long r = 0;
+		for ( size_t i = 0; i != mySlotCount; ++i )
+			r += mySlots[i].count.load( std::memory_order_seq_cst );
+		return r;
+	}
+
+	/// each on its own cache line, so readers on different cpus
+	/// don't contend for one
+	struct alignas(__priv::cache_line_size) slot
+	{
+		slot( void ) : count( 0 ) {}
+		std::atomic<long> count;
+	};
+
+	std::atomic<bool> myWriter;
+	size_t mySlotCount;
+	std::vector<slot, __priv::aligned_allocator<slot, __priv::cache_line_size>> mySlots;
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Analog of std::lock_guard for the reader side of a
+/// reader / writer lock (anything with lock_shared / unlock_shared)
+template <typename Mutex>
+class shared_lock_guard
+{
+public:
+	typedef Mutex mutex_type;
+
+	_YACO_INLINE explicit shared_lock_guard( mutex_type &m ) : __m( m ) { __m.lock_shared(); }
+	_YACO_INLINE shared_lock_guard( mutex_type &m, std::adopt_lock_t ) : __m( m ) {}
+	_YACO_INLINE ~shared_lock_guard( void ) { __m.unlock_shared(); }
+
+private:
+	shared_lock_guard( const shared_lock_guard & ) = delete;
+	shared_lock_guard &operator=( const shared_lock_guard & ) = delete;
+
+	mutex_type &__m;
+};
+
+
+////////////////////////////////////////
+
+
+/// @brief Mutex that spins for a while before putting the thread to sleep
+///
+/// Most critical sections guarding small tables are only a few
+/// hundred cycles long, so when the lock is contended it is usually
+/// cheaper to spin briefly than to pay for two context switches.
+/// If the lock is still not available after the spin count is
+/// exhausted, the thread parks on a futex (linux) or a condition
+/// variable (elsewhere). Uncontended lock / unlock is a single
+/// atomic operation each.
+///
+/// State is 0 (unlocked), 1 (locked) or 2 (locked, maybe with
+/// sleeping waiters), as in Drepper's "Futexes Are Tricky".
+class adaptive_mutex
+{
+public:
+	explicit adaptive_mutex( unsigned spin_count = 100 ) : myState( 0 ), mySpin( spin_count ) {}
+
+	void lock( void )
+	{
+		int c = 0;
+		if ( myState.compare_exchange_strong( c, 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+			return;
+
+		for ( unsigned i = 0; i != mySpin; ++i )
+		{
+			__priv::cpu_relax();
+			c = myState.load( std::memory_order_relaxed );
+			if ( c == 0 &&
+				 myState.compare_exchange_weak( c, 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+				return;
+		}
+
+		// slow path, announce we are (going to be) waiting
+		c = myState.exchange( 2, std::memory_order_acquire );
+		while ( c != 0 )
+		{
+			park();
+			c = myState.exchange( 2, std::memory_order_acquire );
+		}
+	}
+
+	bool try_lock( void )
+	{
+		int c = 0;
+		return myState.compare_exchange_strong( c, 1, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void unlock( void )
+	{
+		if ( myState.exchange( 0, std::memory_order_release ) == 2 )
+			wake();
+	}
+
+private:
+	adaptive_mutex( const adaptive_mutex & ) = delete;
+	adaptive_mutex &operator=( const adaptive_mutex & ) = delete;
+
+#ifdef __linux__
+	void park( void )
+	{
+		::syscall( SYS_futex, reinterpret_cast<int *>( &myState ), FUTEX_WAIT_PRIVATE, 2, nullptr, nullptr, 0 );
+	}
+	void wake( void )
+	{
+		::syscall( SYS_futex, reinterpret_cast<int *>( &myState ), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0 );
+	}
+#else
+	void park( void )
+	{
+		std::unique_lock<std::mutex> lk( myParkLock );
+		if ( myState.load( std::memory_order_relaxed ) == 2 )
+			myParkCond.wait( lk );
+	}
+	void wake( void )
+	{
+		std::lock_guard<std::mutex> lk( myParkLock );
+		myParkCond.notify_one();
+	}
+
+	std::mutex myParkLock;
+	std::condition_variable myParkCond;
+#endif
+
+	static_assert( sizeof(std::atomic<int>) == sizeof(int), "futex requires a plain int" );
+	std::atomic<int> myState;
+	unsigned mySpin;
+};
+
 }
 
 
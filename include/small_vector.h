@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <iterator>
+#include <initializer_list>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+/// @brief Class small_vector is a std::vector work-alike that keeps
+/// up to N elements inside the object itself.
+///
+/// Only once it grows past N does it allocate, after which it
+/// behaves like a std::vector (and never moves back inline, unless
+/// shrink_to_fit is called). This is meant for lists that are
+/// nearly always short, where the heap traffic of std::vector
+/// dominates. Elements must be trivially copyable, so they are
+/// moved around with memcpy / memmove; as with std::vector,
+/// inserting or erasing invalidates iterators, and moving a
+/// small_vector with its elements inline copies them.
+template <typename T, size_t N>
+class small_vector
+{
+	static_assert( N > 0, "small_vector needs an inline capacity" );
+#if !defined(__GNUC__) || defined(__clang__) || __GNUC__ >= 5
+	static_assert( std::is_trivially_copyable<T>::value, "small_vector elements must be trivially copyable" );
+#endif
+
+public:
+	typedef T value_type;
+	typedef size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	static constexpr size_t inline_capacity = N;
+
+	small_vector( void ) {}
+	explicit small_vector( size_t n ) { resize( n ); }
+	small_vector( size_t n, const T &v ) { assign( n, v ); }
+	template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	small_vector( It first, It last ) { assign( first, last ); }
+	small_vector( std::initializer_list<T> l ) { assign( l.begin(), l.end() ); }
+	/// implicit, along with the conversion back, so code written
+	/// against a std::vector can pass and receive a small_vector
+	template <typename A>
+	small_vector( const std::vector<T, A> &v ) { assign( v.begin(), v.end() ); }
+	small_vector( const small_vector &o ) { assign( o.begin(), o.end() ); }
+	small_vector( small_vector &&o ) noexcept { steal( o ); }
+	~small_vector( void ) { release(); }
+
+	small_vector &operator=( const small_vector &o )
+	{
+		if ( this != &o )
+			assign( o.begin(), o.end() );
+		return *this;
+	}
+	small_vector &operator=( small_vector &&o ) noexcept
+	{
+		if ( this != &o )
+		{
+			release();
+			steal( o );
+		}
+		return *this;
+	}
+	small_vector &operator=( std::initializer_list<T> l ) { assign( l.begin(), l.end() ); return *this; }
+
+	template <typename A>
+	operator std::vector<T, A>( void ) const { return std::vector<T, A>( begin(), end() ); }
+
+	void assign( size_t n, const T &v )
+	{
+		T tmp = v; // v may be one of ours
+		clear();
+		reserve( n );
+		std::fill_n( myData, n, tmp );
+		mySize = n;
+	}
+	template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	void assign( It first, It last )
+	{
+		clear();
+		insert( end(), first, last );
+	}
+
+	iterator begin( void ) { return myData; }
+	const_iterator begin( void ) const { return myData; }
+	const_iterator cbegin( void ) const { return myData; }
+	iterator end( void ) { return myData + mySize; }
+	const_iterator end( void ) const { return myData + mySize; }
+	const_iterator cend( void ) const { return myData + mySize; }
+	reverse_iterator rbegin( void ) { return reverse_iterator( end() ); }
+	const_reverse_iterator rbegin( void ) const { return const_reverse_iterator( end() ); }
+	reverse_iterator rend( void ) { return reverse_iterator( begin() ); }
+	const_reverse_iterator rend( void ) const { return const_reverse_iterator( begin() ); }
+
+	size_t size( void ) const { return mySize; }
+	bool empty( void ) const { return mySize == 0; }
+	size_t capacity( void ) const { return myCapacity; }
+	size_t max_size( void ) const { return size_t( -1 ) / sizeof(T); }
+	/// true while the elements are stored in the object itself
+	bool is_inline( void ) const { return myData == inline_data(); }
+
+	T *data( void ) { return myData; }
+	const T *data( void ) const { return myData; }
+
+	T &operator[]( size_t i ) { return myData[i]; }
+	const T &operator[]( size_t i ) const { return myData[i]; }
+	T &at( size_t i ) { check( i ); return myData[i]; }
+	const T &at( size_t i ) const { check( i ); return myData[i]; }
+	T &front( void ) { return myData[0]; }
+	const T &front( void ) const { return myData[0]; }
+	T &back( void ) { return myData[mySize - 1]; }
+	const T &back( void ) const { return myData[mySize - 1]; }
+
+	void reserve( size_t n )
+	{
+		if ( n > myCapacity )
+			reallocate( n );
+	}
+	void shrink_to_fit( void )
+	{
+		if ( ! is_inline() && mySize < myCapacity )
+			reallocate( mySize );
+	}
+
+	void clear( void ) { mySize = 0; }
+
+	void resize( size_t n )
+	{
+		reserve( n );
+		for ( size_t i = mySize; i < n; ++i )
+			new ( myData + i ) T();
+		mySize = n;
+	}
+	void resize( size_t n, const T &v )
+	{
+		if ( n > mySize )
+			insert( end(), n - mySize, v );
+		else
+			mySize = n;
+	}
+
+	void push_back( const T &v )
+	{
+		if ( mySize == myCapacity )
+		{
+			T tmp = v; // v may be one of ours
+			grow( mySize + 1 );
+			myData[mySize++] = tmp;
+		}
+		else
+			myData[mySize++] = v;
+	}
+	template <typename... Args>
+	T &emplace_back( Args &&... args )
+	{
+		T tmp( std::forward<Args>( args )... );
+		push_back( tmp );
+		return back();
+	}
+	void pop_back( void ) { --mySize; }
+
+	iterator insert( const_iterator pos, const T &v ) { return insert( pos, size_t( 1 ), v ); }
+	iterator insert( const_iterator pos, size_t n, const T &v )
+	{
+		T tmp = v;
+		iterator p = open( pos, n );
+		std::fill_n( p, n, tmp );
+		return p;
+	}
+	template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	iterator insert( const_iterator pos, It first, It last )
+	{
+		return insert_range( pos, first, last, typename std::iterator_traits<It>::iterator_category() );
+	}
+	iterator insert( const_iterator pos, const T *first, const T *last )
+	{
+		size_t n = size_t( last - first );
+		if ( first >= begin() && first < end() )
+		{
+			// inserting a copy of ourselves
+			small_vector tmp( first, last );
+			return insert( pos, tmp.begin(), tmp.end() );
+		}
+		iterator p = open( pos, n );
+		if ( n > 0 )
+			std::memcpy( static_cast<void *>( p ), first, n * sizeof(T) );
+		return p;
+	}
+	iterator insert( const_iterator pos, T *first, T *last ) { return insert( pos, static_cast<const T *>( first ), static_cast<const T *>( last ) ); }
+	iterator insert( const_iterator pos, std::initializer_list<T> l ) { return insert( pos, l.begin(), l.end() ); }
+
+	iterator erase( const_iterator pos ) { return erase( pos, pos + 1 ); }
+	iterator erase( const_iterator first, const_iterator last )
+	{
+		iterator f = begin() + ( first - begin() );
+		size_t n = size_t( last - first );
+		if ( n > 0 )
+		{
+			std::memmove( static_cast<void *>( f ), last, size_t( end() - last ) * sizeof(T) );
+			mySize -= n;
+		}
+		return f;
+	}
+
+	void swap( small_vector &o ) noexcept
+	{
+		small_vector tmp( std::move( o ) );
+		o = std::move( *this );
+		*this = std::move( tmp );
+	}
+
+private:
+	T *inline_data( void ) { return reinterpret_cast<T *>( &myInline ); }
+	const T *inline_data( void ) const { return reinterpret_cast<const T *>( &myInline ); }
+
+	void check( size_t i ) const
+	{
+		if ( i >= mySize )
+			throw std::out_of_range( "small_vector index out of range" );
+	}
+
+	void release( void )
+	{
+		if ( ! is_inline() )
+			::operator delete( myData );
+		myData = inline_data();
+		myCapacity = N;
+		mySize = 0;
+	}
+
+	/// takes o's elements, leaving it empty
+	void steal( small_vector &o )
+	{
+		if ( o.is_inline() )
+		{
+			if ( o.mySize > 0 )
+				std::memcpy( static_cast<void *>( myData ), o.myData, o.mySize * sizeof(T) );
+			mySize = o.mySize;
+			o.mySize = 0;
+		}
+		else
+		{
+			myData = o.myData;
+			mySize = o.mySize;
+			myCapacity = o.myCapacity;
+			o.myData = o.inline_data();
+			o.myCapacity = N;
+			o.mySize = 0;
+		}
+	}
+
+	void grow( size_t n )
+	{
+		reallocate( std::max( n, myCapacity * 2 ) );
+	}
+
+	void reallocate( size_t n )
+	{
+		T *nd = inline_data();
+		if ( n > N )
+			nd = static_cast<T *>( ::operator new( n * sizeof(T) ) );
+		else
+			n = N;
+		if ( nd == myData )
+			return;
+		if ( mySize > 0 )
+			std::memcpy( static_cast<void *>( nd ), myData, mySize * sizeof(T) );
+		if ( ! is_inline() )
+			::operator delete( myData );
+		myData = nd;
+		myCapacity = n;
+	}
+
+	template <typename It>
+	iterator insert_range( const_iterator pos, It first, It last, std::input_iterator_tag )
+	{
+		size_t off = size_t( pos - begin() );
+		for ( size_t i = off; first != last; ++first, ++i )
+			insert( begin() + i, *first );
+		return begin() + off;
+	}
+	template <typename It>
+	iterator insert_range( const_iterator pos, It first, It last, std::forward_iterator_tag )
+	{
+		iterator p = open( pos, size_t( std::distance( first, last ) ) );
+		std::copy( first, last, p );
+		return p;
+	}
+
+	/// makes a gap of n elements at pos, returning where it starts
+	iterator open( const_iterator pos, size_t n )
+	{
+		size_t off = size_t( pos - begin() );
+		if ( mySize + n > myCapacity )
+			grow( mySize + n );
+		iterator p = begin() + off;
+		if ( n > 0 )
+		{
+			std::memmove( static_cast<void *>( p + n ), p, ( mySize - off ) * sizeof(T) );
+			mySize += n;
+		}
+		return p;
+	}
+
+	typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type myInline;
+	T *myData = inline_data();
+	size_t mySize = 0;
+	size_t myCapacity = N;
+};
+
+template <typename T, size_t N>
+constexpr size_t small_vector<T, N>::inline_capacity;
+
+template <typename T, size_t N>
+inline bool operator==( const small_vector<T, N> &a, const small_vector<T, N> &b )
+{
+	return a.size() == b.size() && std::equal( a.begin(), a.end(), b.begin() );
+}
+
+template <typename T, size_t N>
+inline bool operator!=( const small_vector<T, N> &a, const small_vector<T, N> &b )
+{
+	return !( a == b );
+}
+
+template <typename T, size_t N>
+inline bool operator<( const small_vector<T, N> &a, const small_vector<T, N> &b )
+{
+	return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end() );
+}
+
+template <typename T, size_t N>
+inline void swap( small_vector<T, N> &a, small_vector<T, N> &b ) noexcept
+{
+	a.swap( b );
+}
+
+} // namespace yaco
+
+
+// Local Variables:
+// mode: C++
+// End:
+// vim:ft=cpp:
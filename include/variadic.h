@@ -22,7 +22,7 @@
 
 #pragma once
 
-#include "impl/config"
+#include "impl/config.h"
 
 #include <cstddef>
 #include <tuple>
@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/banded_region.h>
+#include <iostream>
+#include <algorithm>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+
+struct and_op { bool operator()( bool a, bool b ) const { return a && b; } };
+struct or_op { bool operator()( bool a, bool b ) const { return a || b; } };
+struct xor_op { bool operator()( bool a, bool b ) const { return a != b; } };
+struct not_in_op { bool operator()( bool a, bool b ) const { return a && ! b; } };
+
+template <typename Pred>
+inline region_list
+band_op( const region_list &a, const region_list &b )
+{
+	region_list retval;
+	retval.reserve( a.size() + b.size() );
+	yaco::__priv::region_band_op( retval,
+								  a.data(), a.data() + a.size(),
+								  b.data(), b.data() + b.size(),
+								  Pred() );
+	return retval;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+region
+banded_region::bounds( void ) const
+{
+	if ( myRects.empty() )
+		return region();
+
+	value_type l = myRects.front().left();
+	value_type r = myRects.front().right();
+	for ( const region &x: myRects )
+	{
+		l = std::min( l, x.left() );
+		r = std::max( r, x.right() );
+	}
+	return region( l, r, myRects.front().bottom(), myRects.back().top() );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+banded_region::band_count( void ) const
+{
+	size_t n = 0;
+	for ( size_t i = 0; i != myRects.size(); ++i )
+	{
+		if ( i == 0 || myRects[i].bottom() != myRects[i - 1].bottom() )
+			++n;
+	}
+	return n;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+banded_region::contains( value_type x, value_type y ) const
+{
+	// first region of the band after the one that could contain y
+	auto e = std::upper_bound( myRects.begin(), myRects.end(), y,
+							   []( value_type v, const region &r ) { return v < r.bottom(); } );
+	if ( e == myRects.begin() )
+		return false;
+
+	const region &last = *( e - 1 );
+	if ( ! last.contains_y( y ) )
+		return false;
+
+	auto b = std::lower_bound( myRects.begin(), e, last.bottom(),
+							   []( const region &r, value_type v ) { return r.bottom() < v; } );
+	auto s = std::lower_bound( b, e, x,
+							   []( const region &r, value_type v ) { return r.right() < v; } );
+	return s != e && s->contains_x( x );
+}
+
+
+////////////////////////////////////////
+
+
+banded_region &
+banded_region::operator&=( const banded_region &o )
+{
+	myRects = band_op<and_op>( myRects, o.myRects );
+	return *this;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region &
+banded_region::operator|=( const banded_region &o )
+{
+	myRects = band_op<or_op>( myRects, o.myRects );
+	return *this;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region &
+banded_region::operator^=( const banded_region &o )
+{
+	myRects = band_op<xor_op>( myRects, o.myRects );
+	return *this;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region &
+banded_region::subtract( const banded_region &o )
+{
+	myRects = band_op<not_in_op>( myRects, o.myRects );
+	return *this;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+banded_region::adopt( region_list l )
+{
+	banded_region retval;
+	retval.myRects = std::move( l );
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+std::ostream &
+operator<<( std::ostream &out, const banded_region &r )
+{
+	out << r.rects();
+	return out;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+operator&( const banded_region &a, const banded_region &b )
+{
+	return banded_region::adopt( band_op<and_op>( a.rects(), b.rects() ) );
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+operator|( const banded_region &a, const banded_region &b )
+{
+	return banded_region::adopt( band_op<or_op>( a.rects(), b.rects() ) );
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+operator^( const banded_region &a, const banded_region &b )
+{
+	return banded_region::adopt( band_op<xor_op>( a.rects(), b.rects() ) );
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+operator~( const banded_region &a )
+{
+	return banded_region( region( region::inf ) ) ^ a;
+}
+
+
+////////////////////////////////////////
+
+
+banded_region
+not_in( const banded_region &a, const banded_region &b )
+{
+	return banded_region::adopt( band_op<not_in_op>( a.rects(), b.rects() ) );
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
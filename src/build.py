@@ -1,8 +1,28 @@
 
-YACO = Library( 'yaco', Compile( 'yaco.cpp', 'region.cpp' ) )
+YACO = Library( 'yaco', Compile( 'yaco.cpp', 'region.cpp', 'banded_region.cpp', 'region_soa.cpp', 'region_index.cpp', 'damage_accumulator.cpp', 'region_raster.cpp', 'region_tiler.cpp', 'region_codec.cpp', 'vector_soa.cpp', 'quaternion_soa.cpp', 'dense_matrix.cpp', 'graphics.cpp', 'lock_profile.cpp' ) )
 
 #SubDir( 'test' )
 Executable( 'unit_str_format', Compile( 'test/strFormat.cpp' ) )
 Executable( 'unit_arg_parse', Compile( 'test/argParser.cpp' ) )
 Executable( 'unit_filename', Compile( 'test/filename.cpp' ) )
-
+Executable( 'unit_mutex_ext', Compile( 'test/mutexExt.cpp' ) )
+Executable( 'unit_small_vector', Compile( 'test/smallVector.cpp' ) )
+Executable( 'unit_vector', Compile( 'test/vector.cpp' ) )
+Executable( 'unit_matrix', Compile( 'test/matrix.cpp' ) )
+Executable( 'unit_const_matrix', Compile( 'test/constMatrix.cpp' ) )
+Executable( 'unit_vector_soa', Compile( 'test/vectorSoa.cpp' ), YACO )
+Executable( 'unit_quaternion', Compile( 'test/quaternion.cpp' ), YACO )
+Executable( 'unit_dense_matrix', Compile( 'test/denseMatrix.cpp' ), YACO )
+Executable( 'unit_graphics', Compile( 'test/graphics.cpp' ), YACO )
+Executable( 'bench_matrix', Compile( 'test/benchMatrix.cpp' ), YACO )
+Executable( 'unit_lock_profile', Compile( 'test/lockProfile.cpp' ), YACO )
+Executable( 'unit_region', Compile( 'test/region.cpp' ), YACO )
+Executable( 'unit_banded_region', Compile( 'test/bandedRegion.cpp' ), YACO )
+Executable( 'unit_region_soa', Compile( 'test/regionSoa.cpp' ), YACO )
+Executable( 'bench_region', Compile( 'test/benchRegion.cpp' ), YACO )
+Executable( 'unit_region_index', Compile( 'test/regionIndex.cpp' ), YACO )
+Executable( 'unit_damage_accumulator', Compile( 'test/damageAccumulator.cpp' ), YACO )
+Executable( 'unit_region_raster', Compile( 'test/regionRaster.cpp' ), YACO )
+Executable( 'unit_region_tiler', Compile( 'test/regionTiler.cpp' ), YACO )
+Executable( 'unit_region_oracle', Compile( 'test/regionOracle.cpp' ), YACO )
+Executable( 'unit_region_codec', Compile( 'test/regionCodec.cpp' ), YACO )
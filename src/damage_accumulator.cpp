@@ -0,0 +1,378 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/damage_accumulator.h>
+#include <math/region_index.h>
+#include <algorithm>
+#include <cstdint>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+
+/// batches smaller than this are not worth the sorting
+constexpr size_t min_batch = 32;
+
+/// neighbors looked at per rectangle when coalescing
+constexpr size_t coalesce_neighbors = 6;
+
+inline double
+area_of( const region &r )
+{
+	if ( r.empty() )
+		return 0.0;
+	return ( double(r.right()) - double(r.left()) + 1.0 ) *
+		( double(r.top()) - double(r.bottom()) + 1.0 );
+}
+
+/// area of the bounding box of a and b covered by neither
+inline double
+merge_cost( const region &a, const region &b )
+{
+	region box = a;
+	box.merge( b );
+	region both = a;
+	both.intersect( b );
+	return area_of( box ) - area_of( a ) - area_of( b ) + area_of( both );
+}
+
+/// true if b starts at or before the one past the end of a
+inline bool
+touches( region::value_type aend, region::value_type bstart )
+{
+	return int64_t(bstart) <= int64_t(aend) + 1;
+}
+
+////////////////////////////////////////
+
+/// removes every region inside another one, returns true if any
+/// were removed
+bool
+drop_contained( region_list &l )
+{
+	if ( l.size() < 2 )
+		return false;
+
+	// largest first, so a region can only be inside an earlier one
+	std::sort( l.begin(), l.end(),
+			   []( const region &a, const region &b )
+			   {
+				   double aa = area_of( a ), ab = area_of( b );
+				   return aa > ab || ( aa == ab && a < b );
+			   } );
+
+	region_index idx( l );
+	std::vector<char> dead( l.size(), 0 );
+	bool any = false;
+	for ( size_t i = 0; i != l.size(); ++i )
+	{
+		const region &r = l[i];
+		idx.visit( r, [&]( uint32_t j )
+				   {
+					   if ( j < i && ! dead[j] && r.inside( l[j] ) )
+					   {
+						   dead[i] = 1;
+						   any = true;
+						   return false;
+					   }
+					   return true;
+				   } );
+	}
+	if ( any )
+	{
+		size_t o = 0;
+		for ( size_t i = 0; i != l.size(); ++i )
+			if ( ! dead[i] )
+				l[o++] = l[i];
+		l.resize( o );
+	}
+	return any;
+}
+
+bool
+join_vertical( region_list &l )
+{
+	if ( l.size() < 2 )
+		return false;
+	std::sort( l.begin(), l.end(),
+			   []( const region &a, const region &b )
+			   {
+				   return a.left() < b.left() ||
+					   ( a.left() == b.left() && ( a.right() < b.right() ||
+												   ( a.right() == b.right() && a.bottom() < b.bottom() ) ) );
+			   } );
+	size_t o = 0;
+	for ( size_t i = 1; i != l.size(); ++i )
+	{
+		region &cur = l[o];
+		const region &n = l[i];
+		if ( n.left() == cur.left() && n.right() == cur.right() && touches( cur.top(), n.bottom() ) )
+			cur.reset( cur.left(), cur.right(), cur.bottom(), std::max( cur.top(), n.top() ) );
+		else
+			l[++o] = n;
+	}
+	bool changed = o + 1 != l.size();
+	l.resize( o + 1 );
+	return changed;
+}
+
+bool
+join_horizontal( region_list &l )
+{
+	if ( l.size() < 2 )
+		return false;
+	std::sort( l.begin(), l.end(),
+			   []( const region &a, const region &b )
+			   {
+				   return a.bottom() < b.bottom() ||
+					   ( a.bottom() == b.bottom() && ( a.top() < b.top() ||
+													   ( a.top() == b.top() && a.left() < b.left() ) ) );
+			   } );
+	size_t o = 0;
+	for ( size_t i = 1; i != l.size(); ++i )
+	{
+		region &cur = l[o];
+		const region &n = l[i];
+		if ( n.bottom() == cur.bottom() && n.top() == cur.top() && touches( cur.right(), n.left() ) )
+			cur.reset( cur.left(), std::max( cur.right(), n.right() ), cur.bottom(), cur.top() );
+		else
+			l[++o] = n;
+	}
+	bool changed = o + 1 != l.size();
+	l.resize( o + 1 );
+	return changed;
+}
+
+/// lossless cleanup: drops covered regions, joins exact pairs
+void
+simplify( region_list &l )
+{
+	bool changed = true;
+	drop_contained( l );
+	while ( changed )
+	{
+		changed = join_vertical( l );
+		changed = join_horizontal( l ) || changed;
+		if ( changed )
+			drop_contained( l );
+	}
+}
+
+/// merges pairs until there are at most maxr regions
+double
+coalesce( region_list &l, size_t maxr )
+{
+	struct candidate
+	{
+		double cost;
+		uint32_t a, b;
+		bool operator<( const candidate &o ) const
+		{
+			return cost < o.cost || ( cost == o.cost && ( a < o.a || ( a == o.a && b < o.b ) ) );
+		}
+	};
+
+	double overdraw = 0.0;
+	std::vector<candidate> cands;
+	std::vector<uint32_t> near;
+	std::vector<char> used;
+	region_list next;
+	while ( l.size() > maxr )
+	{
+		// candidate pairs: each region with its nearest neighbors
+		region_index idx( l );
+		cands.clear();
+		for ( size_t i = 0; i != l.size(); ++i )
+		{
+			const region &r = l[i];
+			region::value_type cx = region::value_type( ( int64_t(r.left()) + int64_t(r.right()) ) / 2 );
+			region::value_type cy = region::value_type( ( int64_t(r.bottom()) + int64_t(r.top()) ) / 2 );
+			idx.nearest( cx, cy, coalesce_neighbors + 1, near );
+			for ( uint32_t j: near )
+			{
+				if ( j != i )
+					cands.push_back( candidate{ merge_cost( r, l[j] ), std::min( uint32_t(i), j ), std::max( uint32_t(i), j ) } );
+			}
+		}
+		std::sort( cands.begin(), cands.end() );
+
+		// greedily merge disjoint pairs, cheapest first, only as
+		// many as needed
+		size_t excess = l.size() - maxr;
+		used.assign( l.size(), 0 );
+		next.clear();
+		for ( const candidate &c: cands )
+		{
+			if ( excess == 0 )
+				break;
+			if ( used[c.a] || used[c.b] )
+				continue;
+			used[c.a] = used[c.b] = 1;
+			region box = l[c.a];
+			box.merge( l[c.b] );
+			next.push_back( box );
+			overdraw += c.cost;
+			--excess;
+		}
+		for ( size_t i = 0; i != l.size(); ++i )
+			if ( ! used[i] )
+				next.push_back( l[i] );
+
+		l.swap( next );
+		// bounding boxes may now cover other regions
+		simplify( l );
+	}
+	return overdraw;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+void
+damage_accumulator::add( const region &r )
+{
+	if ( r.empty() )
+		return;
+
+	if ( myRects.empty() )
+		myBounds = r;
+	else
+		myBounds.merge( r );
+
+	// cheap check against the previous add, which is often the
+	// neighbor of this one
+	if ( myRects.size() > myClean )
+	{
+		region &last = myRects.back();
+		if ( r.inside( last ) )
+			return;
+		if ( last.inside( r ) )
+		{
+			last = r;
+			return;
+		}
+		if ( ( last.left() == r.left() && last.right() == r.right() &&
+			   touches( last.top(), r.bottom() ) && touches( r.top(), last.bottom() ) ) ||
+			 ( last.bottom() == r.bottom() && last.top() == r.top() &&
+			   touches( last.right(), r.left() ) && touches( r.right(), last.left() ) ) )
+		{
+			last.merge( r );
+			return;
+		}
+	}
+
+	myRects.push_back( r );
+	if ( myRects.size() - myClean >= std::max( myClean, min_batch ) )
+		flush();
+}
+
+
+////////////////////////////////////////
+
+
+void
+damage_accumulator::add( const region_list &l )
+{
+	for ( auto &r: l )
+		add( r );
+}
+
+
+////////////////////////////////////////
+
+
+void
+damage_accumulator::clear( void )
+{
+	myRects.clear();
+	myClean = 0;
+	myOverdraw = 0.0;
+	myBounds = region();
+}
+
+
+////////////////////////////////////////
+
+
+void
+damage_accumulator::flush( void ) const
+{
+	if ( myClean == myRects.size() && ( myMax == 0 || myRects.size() <= myMax ) )
+		return;
+
+	simplify( myRects );
+	if ( myMax > 0 && myRects.size() > myMax )
+		myOverdraw += coalesce( myRects, myMax );
+	myClean = myRects.size();
+}
+
+
+////////////////////////////////////////
+
+
+region_list
+damage_accumulator::take( void )
+{
+	flush();
+	region_list retval;
+	retval.swap( myRects );
+	clear();
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+double
+damage_accumulator::area( void ) const
+{
+	flush();
+	double retval = 0.0;
+	for ( auto &r: myRects )
+		retval += area_of( r );
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
@@ -0,0 +1,423 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/dense_matrix.h>
+#include <impl/soa_priv.h>
+#include <algorithm>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+using yaco::__priv::simd_lane;
+using yaco::__priv::parallel_for;
+
+// The gemm blocking, in the usual arrangement: a kc x nc panel of
+// op( b ) is copied out (sized for the last level cache) and, for
+// each mc x kc block of op( a ) (sized for the second level), the
+// inner kernel computes an MR x NR tile of c from strips of the two
+// copies, which it walks through in order.
+const size_t MR = 4;
+const size_t KC = 256;
+const size_t MC = 128;
+const size_t NC = 1024;
+
+template <typename T>
+struct gemm_lane
+{
+	typedef simd_lane<T> L;
+	static constexpr size_t NR = 2 * L::width;
+};
+
+/// op( m ) as an element accessor, ( i, j ) at p[i * rs + j * cs]
+template <typename T>
+struct strided
+{
+	const T *p;
+	size_t rs, cs;
+
+	strided( const dense_matrix<T> &m, mat_op op )
+		: p( m.data() ),
+		  rs( op == mat_op::none ? m.cols() : 1 ),
+		  cs( op == mat_op::none ? 1 : m.cols() )
+	{
+	}
+
+	T operator()( size_t i, size_t j ) const { return p[i * rs + j * cs]; }
+};
+
+/// copies rows [i0, i0 + mc) and columns [k0, k0 + kc) of op( a )
+/// into strips of MR rows, stored a column at a time, with the rows
+/// past the end of the matrix as 0
+template <typename T>
+void
+pack_a( const strided<T> &a, size_t i0, size_t mc, size_t k0, size_t kc, T *out )
+{
+	for ( size_t s = 0; s < mc; s += MR )
+	{
+		size_t rows = std::min( MR, mc - s );
+		for ( size_t k = 0; k != kc; ++k, out += MR )
+		{
+			size_t r = 0;
+			for ( ; r != rows; ++r )
+				out[r] = a( i0 + s + r, k0 + k );
+			for ( ; r != MR; ++r )
+				out[r] = T( 0 );
+		}
+	}
+}
+
+/// copies rows [k0, k0 + kc) and columns [j0, j0 + nc) of op( b )
+/// into strips of NR columns, stored a row at a time, with the
+/// columns past the end of the matrix as 0
+template <typename T, size_t NR>
+void
+pack_b( const strided<T> &b, size_t k0, size_t kc, size_t j0, size_t nc, T *out )
+{
+	for ( size_t s = 0; s < nc; s += NR )
+	{
+		size_t cols = std::min( NR, nc - s );
+		for ( size_t k = 0; k != kc; ++k, out += NR )
+		{
+			size_t c = 0;
+			for ( ; c != cols; ++c )
+				out[c] = b( k0 + k, j0 + s + c );
+			for ( ; c != NR; ++c )
+				out[c] = T( 0 );
+		}
+	}
+}
+
+/// c += alpha * a * b for an MR x NR tile, of which the top left
+/// mr x nr is inside c
+template <typename L, typename T>
+void
+micro_kernel( size_t kc, const T *a, const T *b, T alpha, T *c, size_t ldc, size_t mr, size_t nr )
+{
+	typedef typename L::type V;
+	const size_t W = L::width;
+	const size_t NR = 2 * W;
+
+	V c00 = L::set1( T( 0 ) ), c01 = c00, c10 = c00, c11 = c00;
+	V c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+	for ( size_t k = 0; k != kc; ++k, a += MR, b += NR )
+	{
+		V b0 = L::load( b ), b1 = L::load( b + W );
+		V a0 = L::set1( a[0] );
+		c00 = L::add( c00, L::mul( a0, b0 ) );
+		c01 = L::add( c01, L::mul( a0, b1 ) );
+		V a1 = L::set1( a[1] );
+		c10 = L::add( c10, L::mul( a1, b0 ) );
+		c11 = L::add( c11, L::mul( a1, b1 ) );
+		V a2 = L::set1( a[2] );
+		c20 = L::add( c20, L::mul( a2, b0 ) );
+		c21 = L::add( c21, L::mul( a2, b1 ) );
+		V a3 = L::set1( a[3] );
+		c30 = L::add( c30, L::mul( a3, b0 ) );
+		c31 = L::add( c31, L::mul( a3, b1 ) );
+	}
+
+	const V al = L::set1( alpha );
+	const V acc[MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 } };
+	if ( mr == MR && nr == NR )
+	{
+		for ( size_t r = 0; r != MR; ++r, c += ldc )
+		{
+			L::storeu( c, L::add( L::loadu( c ), L::mul( al, acc[r][0] ) ) );
+			L::storeu( c + W, L::add( L::loadu( c + W ), L::mul( al, acc[r][1] ) ) );
+		}
+		return;
+	}
+
+	alignas(32) T tile[MR][2 * W];
+	for ( size_t r = 0; r != MR; ++r )
+	{
+		L::store( tile[r], acc[r][0] );
+		L::store( tile[r] + W, acc[r][1] );
+	}
+	for ( size_t r = 0; r != mr; ++r, c += ldc )
+		for ( size_t j = 0; j != nr; ++j )
+			c[j] += alpha * tile[r][j];
+}
+
+/// c = beta * c for rows [i0, i1), without reading c when beta is 0
+template <typename T>
+void
+scale_rows( dense_matrix<T> &c, T beta, size_t i0, size_t i1 )
+{
+	if ( beta == T( 1 ) )
+		return;
+	T *p = c.row( i0 ), *e = c.row( i1 );
+	if ( beta == T( 0 ) )
+		std::fill( p, e, T( 0 ) );
+	else
+		for ( ; p != e; ++p )
+			*p *= beta;
+}
+
+/// rows [i0, i1) of the gemm
+template <typename T>
+void
+gemm_rows( const strided<T> &a, const strided<T> &b, size_t kdim, T alpha,
+		   dense_matrix<T> &c, T beta, size_t i0, size_t i1 )
+{
+	typedef typename gemm_lane<T>::L L;
+	const size_t NR = gemm_lane<T>::NR;
+	const size_t n = c.cols();
+
+	scale_rows( c, beta, i0, i1 );
+	if ( i0 == i1 || n == 0 || kdim == 0 || alpha == T( 0 ) )
+		return;
+
+	typename dense_matrix<T>::array_type abuf( MC * KC );
+	typename dense_matrix<T>::array_type bbuf( KC * ( ( std::min( NC, n ) + NR - 1 ) / NR * NR ) );
+	for ( size_t jc = 0; jc < n; jc += NC )
+	{
+		size_t nc = std::min( NC, n - jc );
+		for ( size_t pc = 0; pc < kdim; pc += KC )
+		{
+			size_t kc = std::min( KC, kdim - pc );
+			pack_b<T, NR>( b, pc, kc, jc, nc, bbuf.data() );
+			for ( size_t ic = i0; ic < i1; ic += MC )
+			{
+				size_t mc = std::min( MC, i1 - ic );
+				pack_a( a, ic, mc, pc, kc, abuf.data() );
+				for ( size_t jr = 0; jr < nc; jr += NR )
+				{
+					for ( size_t ir = 0; ir < mc; ir += MR )
+					{
+						micro_kernel<L>( kc, abuf.data() + ir * kc, bbuf.data() + jr * kc, alpha,
+										 c.row( ic + ir ) + jc + jr, n,
+										 std::min( MR, mc - ir ), std::min( NR, nc - jr ) );
+					}
+				}
+			}
+		}
+	}
+}
+
+/// rows per thread for a product of the given number of
+/// multiply-adds, across the rows of the output
+size_t
+piece_rows( size_t rows, size_t work, size_t nthreads )
+{
+	if ( work < dense_matrix_parallel_min )
+		return rows;
+	return yaco::__priv::piece_size( rows, nthreads, 0 );
+}
+
+/// y[i] = alpha * dot( row i of a, x ) + beta * y[i], for rows
+/// [i, i + NRows), which share the loads of x
+template <typename L, size_t NRows, typename T>
+void
+gemv_rows_block( const dense_matrix<T> &a, const T *x, T alpha, T beta, T *y, size_t i )
+{
+	typedef typename L::type V;
+	const size_t W = L::width;
+	const size_t n = a.cols();
+
+	const T *rows[NRows];
+	V s[NRows];
+	for ( size_t r = 0; r != NRows; ++r )
+	{
+		rows[r] = a.row( i + r );
+		s[r] = L::set1( T( 0 ) );
+	}
+
+	size_t j = 0;
+	for ( ; j + W <= n; j += W )
+	{
+		V xv = L::loadu( x + j );
+		for ( size_t r = 0; r != NRows; ++r )
+			s[r] = L::add( s[r], L::mul( L::loadu( rows[r] + j ), xv ) );
+	}
+
+	for ( size_t r = 0; r != NRows; ++r )
+	{
+		alignas(32) T lanes[W];
+		L::store( lanes, s[r] );
+		T sum = lanes[0];
+		for ( size_t k = 1; k != W; ++k )
+			sum += lanes[k];
+		for ( size_t jj = j; jj != n; ++jj )
+			sum += rows[r][jj] * x[jj];
+		y[i + r] = beta == T( 0 ) ? alpha * sum : alpha * sum + beta * y[i + r];
+	}
+}
+
+template <typename L, typename T>
+void
+gemv_rows_kernel( const dense_matrix<T> &a, const T *x, T alpha, T beta, T *y, size_t i0, size_t i1 )
+{
+	size_t i = i0;
+	for ( ; i + 4 <= i1; i += 4 )
+		gemv_rows_block<L, 4>( a, x, alpha, beta, y, i );
+	for ( ; i != i1; ++i )
+		gemv_rows_block<L, 1>( a, x, alpha, beta, y, i );
+}
+
+/// y[j] = beta * y[j] + alpha * sum over i of a( i, j ) * x[i], for
+/// columns [j0, j1)
+template <typename L, typename T>
+void
+gemv_cols_kernel( const dense_matrix<T> &a, const T *x, T alpha, T beta, T *y, size_t j0, size_t j1 )
+{
+	typedef typename L::type V;
+	const size_t W = L::width;
+	const size_t m = a.rows();
+
+	if ( beta == T( 0 ) )
+		std::fill( y + j0, y + j1, T( 0 ) );
+	else if ( beta != T( 1 ) )
+		for ( size_t j = j0; j != j1; ++j )
+			y[j] *= beta;
+
+	size_t i = 0;
+	for ( ; i + 4 <= m; i += 4 )
+	{
+		const T *r0 = a.row( i ), *r1 = a.row( i + 1 ), *r2 = a.row( i + 2 ), *r3 = a.row( i + 3 );
+		const T x0 = alpha * x[i], x1 = alpha * x[i + 1], x2 = alpha * x[i + 2], x3 = alpha * x[i + 3];
+		const V v0 = L::set1( x0 ), v1 = L::set1( x1 ), v2 = L::set1( x2 ), v3 = L::set1( x3 );
+		size_t j = j0;
+		for ( ; j + W <= j1; j += W )
+		{
+			V s = L::add( L::add( L::mul( L::loadu( r0 + j ), v0 ), L::mul( L::loadu( r1 + j ), v1 ) ),
+						  L::add( L::mul( L::loadu( r2 + j ), v2 ), L::mul( L::loadu( r3 + j ), v3 ) ) );
+			L::storeu( y + j, L::add( L::loadu( y + j ), s ) );
+		}
+		for ( ; j != j1; ++j )
+			y[j] += ( r0[j] * x0 + r1[j] * x1 ) + ( r2[j] * x2 + r3[j] * x3 );
+	}
+	for ( ; i != m; ++i )
+	{
+		const T *r = a.row( i );
+		const T xi = alpha * x[i];
+		for ( size_t j = j0; j != j1; ++j )
+			y[j] += r[j] * xi;
+	}
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+gemm( mat_op opa, mat_op opb, T alpha, const dense_matrix<T> &a, const dense_matrix<T> &b,
+	  T beta, dense_matrix<T> &c, size_t nthreads )
+{
+	if ( &c == &a || &c == &b )
+		throw std::invalid_argument( "gemm output may not be an input" );
+
+	const size_t m = opa == mat_op::none ? a.rows() : a.cols();
+	const size_t k = opa == mat_op::none ? a.cols() : a.rows();
+	const size_t kb = opb == mat_op::none ? b.rows() : b.cols();
+	const size_t n = opb == mat_op::none ? b.cols() : b.rows();
+	if ( k != kb )
+		throw std::invalid_argument( "gemm inner dimensions differ" );
+	if ( c.rows() != m || c.cols() != n )
+	{
+		if ( beta != T( 0 ) )
+			throw std::invalid_argument( "gemm output size mismatch" );
+		c.assign( m, n );
+	}
+
+	const strided<T> sa( a, opa ), sb( b, opb );
+	parallel_for( m, piece_rows( m, m * n * k, nthreads ), [&]( size_t, size_t i0, size_t i1 )
+	{
+		gemm_rows( sa, sb, k, alpha, c, beta, i0, i1 );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+gemv( mat_op opa, T alpha, const dense_matrix<T> &a, const std::vector<T> &x,
+	  T beta, std::vector<T> &y, size_t nthreads )
+{
+	if ( &x == &y )
+		throw std::invalid_argument( "gemv output may not be the input" );
+
+	const size_t m = opa == mat_op::none ? a.rows() : a.cols();
+	const size_t n = opa == mat_op::none ? a.cols() : a.rows();
+	if ( x.size() != n )
+		throw std::invalid_argument( "gemv vector size mismatch" );
+	if ( y.size() != m )
+	{
+		if ( beta != T( 0 ) )
+			throw std::invalid_argument( "gemv output size mismatch" );
+		y.assign( m, T( 0 ) );
+	}
+
+	const T *xp = x.data();
+	T *yp = y.data();
+	if ( opa == mat_op::none )
+	{
+		parallel_for( m, piece_rows( m, m * n, nthreads ), [&]( size_t, size_t i0, size_t i1 )
+		{
+			gemv_rows_kernel<simd_lane<T>>( a, xp, alpha, beta, yp, i0, i1 );
+		} );
+	}
+	else
+	{
+		parallel_for( m, piece_rows( m, m * n, nthreads ), [&]( size_t, size_t j0, size_t j1 )
+		{
+			gemv_cols_kernel<simd_lane<T>>( a, xp, alpha, beta, yp, j0, j1 );
+		} );
+	}
+}
+
+
+////////////////////////////////////////
+
+
+#define YACO_INSTANTIATE_DENSE_MATRIX( T ) \
+	template void gemm( mat_op, mat_op, T, const dense_matrix<T> &, const dense_matrix<T> &, T, dense_matrix<T> &, size_t ); \
+	template void gemv( mat_op, T, const dense_matrix<T> &, const std::vector<T> &, T, std::vector<T> &, size_t )
+
+YACO_INSTANTIATE_DENSE_MATRIX( float );
+YACO_INSTANTIATE_DENSE_MATRIX( double );
+
+#undef YACO_INSTANTIATE_DENSE_MATRIX
+
+} // math
+} // yaco
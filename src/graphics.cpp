@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/graphics.h>
+#include <impl/soa_priv.h>
+#include <cmath>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+using yaco::__priv::scalar_lane;
+using yaco::__priv::simd_lane;
+using yaco::__priv::parallel_for;
+
+/// n, |n| and d of each plane, spread across a lane
+template <typename L>
+struct plane_consts
+{
+	typename L::type n[3], a[3], d;
+
+	template <typename T>
+	void init( const plane<T> &p )
+	{
+		for ( size_t k = 0; k != 3; ++k )
+		{
+			n[k] = L::set1( p.n()[k] );
+			a[k] = L::set1( std::abs( p.n()[k] ) );
+		}
+		d = L::set1( p.d() );
+	}
+};
+
+/// the same arithmetic, in the same order, as frustum::visible
+template <typename L, typename T>
+size_t
+cull_kernel( const frustum<T> &f, const T *const lo[3], const T *const hi[3], uint64_t *mask, size_t i, size_t e )
+{
+	typedef typename L::type V;
+	plane_consts<L> planes[6];
+	for ( size_t p = 0; p != 6; ++p )
+		planes[p].init( f[p] );
+	const V half = L::set1( T( 0.5 ) );
+	const V zero = L::set1( T( 0 ) );
+	const unsigned all = ( 1U << L::width ) - 1;
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V c[3], x[3];
+		for ( size_t k = 0; k != 3; ++k )
+		{
+			V l = L::load( lo[k] + i ), h = L::load( hi[k] + i );
+			c[k] = L::mul( L::add( l, h ), half );
+			x[k] = L::mul( L::sub( h, l ), half );
+		}
+
+		// most boxes in a scene tend to be outside one of the first
+		// few planes, so stop once the whole register is
+		unsigned vis = all;
+		for ( size_t p = 0; p != 6 && vis; ++p )
+		{
+			const plane_consts<L> &pl = planes[p];
+			V dist = L::add( L::add( L::add( L::mul( pl.n[0], c[0] ), L::mul( pl.n[1], c[1] ) ),
+									 L::mul( pl.n[2], c[2] ) ), pl.d );
+			V r = L::add( L::add( L::mul( pl.a[0], x[0] ), L::mul( pl.a[1], x[1] ) ), L::mul( pl.a[2], x[2] ) );
+			vis &= L::mask_ge( L::add( dist, r ), zero );
+		}
+		mask[i / 64] |= uint64_t( vis ) << ( i % 64 );
+	}
+	return i;
+}
+
+size_t
+popcount( const std::vector<uint64_t> &mask )
+{
+	size_t r = 0;
+	for ( uint64_t w: mask )
+	{
+		while ( w )
+		{
+			w &= w - 1;
+			++r;
+		}
+	}
+	return r;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+template <typename T>
+size_t
+cull( const frustum<T> &f, const aabb_soa<T> &boxes, std::vector<uint64_t> &visible, size_t nthreads )
+{
+	const size_t n = boxes.size();
+	visible.assign( ( n + 63 ) / 64, 0 );
+
+	// the pieces are multiples of 64 boxes, so no two threads share
+	// a word of the mask
+	const size_t chunk = yaco::__priv::piece_size( n, nthreads, cull_parallel_min );
+	const T *const lo[3] = { boxes.min_component( 0 ), boxes.min_component( 1 ), boxes.min_component( 2 ) };
+	const T *const hi[3] = { boxes.max_component( 0 ), boxes.max_component( 1 ), boxes.max_component( 2 ) };
+	uint64_t *mask = visible.data();
+	parallel_for( n, chunk, [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = cull_kernel<simd_lane<T>>( f, lo, hi, mask, b, e );
+		cull_kernel<scalar_lane<T>>( f, lo, hi, mask, i, e );
+	} );
+	return popcount( visible );
+}
+
+
+////////////////////////////////////////
+
+
+#define YACO_INSTANTIATE_GRAPHICS( T ) \
+	template size_t cull( const frustum<T> &, const aabb_soa<T> &, std::vector<uint64_t> &, size_t )
+
+YACO_INSTANTIATE_GRAPHICS( float );
+YACO_INSTANTIATE_GRAPHICS( double );
+
+#undef YACO_INSTANTIATE_GRAPHICS
+
+} // math
+} // yaco
+
@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <lock_profile.h>
+#include <map>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+std::mutex &
+registry_lock( void )
+{
+	static std::mutex theLock;
+	return theLock;
+}
+
+std::map<std::string, std::shared_ptr<yaco::lock_stats>> &
+registry( void )
+{
+	static std::map<std::string, std::shared_ptr<yaco::lock_stats>> theRegistry;
+	return theRegistry;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+
+////////////////////////////////////////
+
+
+lock_stats::lock_stats( const std::string &n )
+		: name( n )
+{
+	reset();
+}
+
+
+////////////////////////////////////////
+
+
+void
+lock_stats::reset( void )
+{
+	acquisitions = 0;
+	contended = 0;
+	wait_ns = 0;
+	hold_ns = 0;
+	for ( size_t i = 0; i != histogram_buckets; ++i )
+		hold_histogram[i] = 0;
+}
+
+
+////////////////////////////////////////
+
+
+std::shared_ptr<lock_stats>
+register_lock_stats( const std::string &name )
+{
+	std::lock_guard<std::mutex> lk( registry_lock() );
+	std::shared_ptr<lock_stats> &r = registry()[name];
+	if ( ! r )
+		r = std::make_shared<lock_stats>( name );
+	return r;
+}
+
+
+////////////////////////////////////////
+
+
+std::vector<lock_profile_entry>
+lock_profile_snapshot( void )
+{
+	std::vector<lock_profile_entry> retval;
+
+	std::lock_guard<std::mutex> lk( registry_lock() );
+	auto &reg = registry();
+	retval.reserve( reg.size() );
+	for ( auto &i: reg )
+	{
+		const lock_stats &s = *(i.second);
+		lock_profile_entry e;
+		e.name = s.name;
+		e.acquisitions = s.acquisitions.load( std::memory_order_relaxed );
+		e.contended = s.contended.load( std::memory_order_relaxed );
+		e.wait_ns = s.wait_ns.load( std::memory_order_relaxed );
+		e.hold_ns = s.hold_ns.load( std::memory_order_relaxed );
+		e.hold_histogram.resize( lock_stats::histogram_buckets );
+		for ( size_t b = 0; b != lock_stats::histogram_buckets; ++b )
+			e.hold_histogram[b] = s.hold_histogram[b].load( std::memory_order_relaxed );
+		retval.emplace_back( std::move( e ) );
+	}
+
+	std::stable_sort( retval.begin(), retval.end(),
+					  []( const lock_profile_entry &a, const lock_profile_entry &b )
+					  {
+						  return a.wait_ns > b.wait_ns;
+					  } );
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+void
+dump_lock_profile( std::ostream &out )
+{
+	std::vector<lock_profile_entry> snap = lock_profile_snapshot();
+
+	// leave the caller's stream formatted as it was
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize prec = out.precision();
+
+	out << std::left << std::setw( 24 ) << "lock" << std::right
+		<< std::setw( 14 ) << "acquired"
+		<< std::setw( 14 ) << "contended"
+		<< std::setw( 10 ) << "cont %"
+		<< std::setw( 16 ) << "wait (us)"
+		<< std::setw( 16 ) << "hold (us)"
+		<< std::setw( 14 ) << "avg hold (ns)" << '\n';
+
+	for ( auto &e: snap )
+	{
+		double pct = e.acquisitions ? ( 100.0 * double(e.contended) / double(e.acquisitions) ) : 0.0;
+		uint64_t avg = e.acquisitions ? ( e.hold_ns / e.acquisitions ) : 0;
+		out << std::left << std::setw( 24 ) << e.name << std::right
+			<< std::setw( 14 ) << e.acquisitions
+			<< std::setw( 14 ) << e.contended
+			<< std::setw( 10 ) << std::fixed << std::setprecision( 2 ) << pct
+			<< std::setw( 16 ) << ( e.wait_ns / 1000 )
+			<< std::setw( 16 ) << ( e.hold_ns / 1000 )
+			<< std::setw( 14 ) << avg << '\n';
+
+		// only print the populated part of the histogram
+		size_t first = 0, last = e.hold_histogram.size();
+		while ( first < last && e.hold_histogram[first] == 0 )
+			++first;
+		while ( last > first && e.hold_histogram[last - 1] == 0 )
+			--last;
+		if ( first == last )
+			continue;
+
+		out << "    hold ns histogram:";
+		for ( size_t b = first; b != last; ++b )
+			out << " [" << ( uint64_t(1) << b ) << "]=" << e.hold_histogram[b];
+		out << '\n';
+	}
+
+	out.flags( flags );
+	out.precision( prec );
+	out << std::flush;
+}
+
+
+////////////////////////////////////////
+
+
+void
+reset_lock_profile( void )
+{
+	std::lock_guard<std::mutex> lk( registry_lock() );
+	for ( auto &i: registry() )
+		i.second->reset();
+}
+
+
+////////////////////////////////////////
+
+
+} // yaco
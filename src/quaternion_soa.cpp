@@ -0,0 +1,430 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/quaternion_soa.h>
+#include <impl/soa_priv.h>
+#include <limits>
+#include <stdexcept>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+using yaco::__priv::scalar_lane;
+using yaco::__priv::simd_lane;
+using yaco::__priv::parallel_for;
+
+size_t
+piece_size( size_t n, size_t nthreads )
+{
+	return yaco::__priv::piece_size( n, nthreads, vector_soa_parallel_min );
+}
+
+template <typename T>
+void
+check_sizes( const quaternion_soa<T> &a, const quaternion_soa<T> &b )
+{
+	if ( a.size() != b.size() )
+		throw std::invalid_argument( "quaternion buffers must be the same size" );
+}
+
+/// one quaternion per lane
+template <typename L>
+struct quat_lanes
+{
+	typedef typename L::type V;
+	V v[4];
+
+	template <typename T>
+	void load( const T *const c[4], size_t i )
+	{
+		for ( size_t k = 0; k != 4; ++k )
+			v[k] = L::load( c[k] + i );
+	}
+
+	template <typename T>
+	void store( T *const c[4], size_t i ) const
+	{
+		for ( size_t k = 0; k != 4; ++k )
+			L::store( c[k] + i, v[k] );
+	}
+
+	V dot( const quat_lanes &o ) const
+	{
+		return L::add( L::add( L::add( L::mul( v[0], o.v[0] ), L::mul( v[1], o.v[1] ) ),
+							   L::mul( v[2], o.v[2] ) ), L::mul( v[3], o.v[3] ) );
+	}
+
+	/// same as quaternion::normalize
+	void normalize( V eps, V one )
+	{
+		V l = L::sqrt( dot( *this ) );
+		l = L::select_gt( l, eps, l, one );
+		for ( size_t k = 0; k != 4; ++k )
+			v[k] = L::div( v[k], l );
+	}
+};
+
+template <typename T>
+struct kernel_args
+{
+	const T *a[4];
+	const T *b[4];
+	T *out[4];
+};
+
+template <typename T>
+kernel_args<T>
+make_args( const quaternion_soa<T> &a, const quaternion_soa<T> &b, quaternion_soa<T> &out )
+{
+	kernel_args<T> r;
+	for ( size_t k = 0; k != 4; ++k )
+	{
+		r.a[k] = a.component( k );
+		r.b[k] = b.component( k );
+		r.out[k] = out.component( k );
+	}
+	return r;
+}
+
+template <typename L, typename T>
+size_t
+normalize_kernel( T *const q[4], size_t i, size_t e )
+{
+	const typename L::type eps = L::set1( std::numeric_limits<T>::epsilon() );
+	const typename L::type one = L::set1( T( 1 ) );
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		quat_lanes<L> v;
+		v.load( q, i );
+		v.normalize( eps, one );
+		v.store( q, i );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+multiply_kernel( const kernel_args<T> &args, size_t i, size_t e )
+{
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		quat_lanes<L> p, q, r;
+		p.load( args.a, i );
+		q.load( args.b, i );
+		// same terms and order as quaternion::operator*=
+		r.v[0] = L::sub( L::sub( L::sub( L::mul( p.v[0], q.v[0] ), L::mul( p.v[1], q.v[1] ) ),
+								 L::mul( p.v[2], q.v[2] ) ), L::mul( p.v[3], q.v[3] ) );
+		r.v[1] = L::sub( L::add( L::add( L::mul( p.v[0], q.v[1] ), L::mul( p.v[1], q.v[0] ) ),
+								 L::mul( p.v[2], q.v[3] ) ), L::mul( p.v[3], q.v[2] ) );
+		r.v[2] = L::add( L::add( L::sub( L::mul( p.v[0], q.v[2] ), L::mul( p.v[1], q.v[3] ) ),
+								 L::mul( p.v[2], q.v[0] ) ), L::mul( p.v[3], q.v[1] ) );
+		r.v[3] = L::add( L::sub( L::add( L::mul( p.v[0], q.v[3] ), L::mul( p.v[1], q.v[2] ) ),
+								 L::mul( p.v[2], q.v[1] ) ), L::mul( p.v[3], q.v[0] ) );
+		r.store( args.out, i );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+nlerp_kernel( const kernel_args<T> &args, T t, size_t i, size_t e )
+{
+	typedef typename L::type V;
+	const V tv = L::set1( t );
+	const V eps = L::set1( std::numeric_limits<T>::epsilon() );
+	const V one = L::set1( T( 1 ) );
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		quat_lanes<L> a, b;
+		a.load( args.a, i );
+		b.load( args.b, i );
+		V c = a.dot( b );
+		for ( size_t k = 0; k != 4; ++k )
+			a.v[k] = L::add( a.v[k], L::mul( L::sub( L::mulsign( b.v[k], c ), a.v[k] ), tv ) );
+		a.normalize( eps, one );
+		a.store( args.out, i );
+	}
+	return i;
+}
+
+/// terms of the slerp weight series giving full precision, once the
+/// angle is at most 45 degrees
+template <typename T> struct slerp_terms { static const size_t value = 18; };
+template <> struct slerp_terms<float> { static const size_t value = 8; };
+
+/// @brief The coefficients of the series for sin( t theta ) / sin( theta )
+///
+/// With d = cos( theta ) - 1, the ratio is
+///
+///   t ( 1 + b1 d ( 1 + b2 d ( 1 + ... ) ) )
+///
+/// where bi = ( t^2 - i^2 ) / ( i ( 2 i + 1 ) ).
+template <typename T>
+struct slerp_series
+{
+	T t;
+	T b[slerp_terms<T>::value];
+
+	explicit slerp_series( T tt ) : t( tt )
+	{
+		for ( size_t i = 1; i <= slerp_terms<T>::value; ++i )
+		{
+			T fi = static_cast<T>( i );
+			b[i - 1] = ( t * t - fi * fi ) / ( fi * ( T( 2 ) * fi + T( 1 ) ) );
+		}
+	}
+};
+
+template <typename L, typename T>
+struct slerp_lanes
+{
+	typedef typename L::type V;
+	V t;
+	V b[slerp_terms<T>::value];
+
+	explicit slerp_lanes( const slerp_series<T> &s )
+	{
+		t = L::set1( s.t );
+		for ( size_t i = 0; i != slerp_terms<T>::value; ++i )
+			b[i] = L::set1( s.b[i] );
+	}
+
+	V weight( V d, V one ) const
+	{
+		V h = one;
+		for ( size_t i = slerp_terms<T>::value; i-- > 0; )
+			h = L::add( one, L::mul( L::mul( b[i], d ), h ) );
+		return L::mul( t, h );
+	}
+};
+
+template <typename L, typename T>
+size_t
+slerp_kernel( const kernel_args<T> &args, T t, size_t i, size_t e )
+{
+	typedef typename L::type V;
+
+	// split the arc at the midpoint m, and interpolate from a to m
+	// or m to b, where the cosine of the angle is at least 0.7
+	const bool low = t < T( 0.5 );
+	const T s = low ? t * T( 2 ) : t * T( 2 ) - T( 1 );
+	const slerp_lanes<L, T> wp( ( slerp_series<T>( T( 1 ) - s ) ) );
+	const slerp_lanes<L, T> wq( ( slerp_series<T>( s ) ) );
+	const V one = L::set1( T( 1 ) );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		quat_lanes<L> a, b, m;
+		a.load( args.a, i );
+		b.load( args.b, i );
+		V c = a.dot( b );
+		for ( size_t k = 0; k != 4; ++k )
+		{
+			b.v[k] = L::mulsign( b.v[k], c );
+			m.v[k] = L::add( a.v[k], b.v[k] );
+		}
+		V ml = L::sqrt( m.dot( m ) );
+		for ( size_t k = 0; k != 4; ++k )
+			m.v[k] = L::div( m.v[k], ml );
+
+		const quat_lanes<L> &p = low ? a : m;
+		const quat_lanes<L> &q = low ? m : b;
+		V d = L::sub( p.dot( q ), one );
+		V fp = wp.weight( d, one );
+		V fq = wq.weight( d, one );
+		quat_lanes<L> r;
+		for ( size_t k = 0; k != 4; ++k )
+			r.v[k] = L::add( L::mul( p.v[k], fp ), L::mul( q.v[k], fq ) );
+		r.store( args.out, i );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+matrix_kernel( const T *const q[4], T *const out[9], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	const V zero = L::set1( T( 0 ) );
+	const V one = L::set1( T( 1 ) );
+	const V two = L::set1( T( 2 ) );
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		quat_lanes<L> v;
+		v.load( q, i );
+		// same terms and order as quaternion::to_matrix
+		V n = v.dot( v );
+		V s = L::select_gt( n, zero, L::div( two, n ), zero );
+		V w = v.v[0], x = v.v[1], y = v.v[2], z = v.v[3];
+		V xs = L::mul( x, s ), ys = L::mul( y, s ), zs = L::mul( z, s );
+		V wx = L::mul( w, xs ), wy = L::mul( w, ys ), wz = L::mul( w, zs );
+		V xx = L::mul( x, xs ), xy = L::mul( x, ys ), xz = L::mul( x, zs );
+		V yy = L::mul( y, ys ), yz = L::mul( y, zs ), zz = L::mul( z, zs );
+
+		// column major
+		L::store( out[0] + i, L::sub( one, L::add( yy, zz ) ) );
+		L::store( out[1] + i, L::add( xy, wz ) );
+		L::store( out[2] + i, L::sub( xz, wy ) );
+		L::store( out[3] + i, L::sub( xy, wz ) );
+		L::store( out[4] + i, L::sub( one, L::add( xx, zz ) ) );
+		L::store( out[5] + i, L::add( yz, wx ) );
+		L::store( out[6] + i, L::add( xz, wy ) );
+		L::store( out[7] + i, L::sub( yz, wx ) );
+		L::store( out[8] + i, L::sub( one, L::add( xx, yy ) ) );
+	}
+	return i;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+normalize( quaternion_soa<T> &q, size_t nthreads )
+{
+	T *const c[4] = { q.component( 0 ), q.component( 1 ), q.component( 2 ), q.component( 3 ) };
+	parallel_for( q.size(), piece_size( q.size(), nthreads ), [&]( size_t, size_t first, size_t last )
+	{
+		size_t i = normalize_kernel<simd_lane<T>>( c, first, last );
+		normalize_kernel<scalar_lane<T>>( c, i, last );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+multiply( const quaternion_soa<T> &a, const quaternion_soa<T> &b, quaternion_soa<T> &out, size_t nthreads )
+{
+	check_sizes( a, b );
+	const size_t n = a.size();
+	out.resize( n );
+
+	const kernel_args<T> args = make_args( a, b, out );
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t first, size_t last )
+	{
+		size_t i = multiply_kernel<simd_lane<T>>( args, first, last );
+		multiply_kernel<scalar_lane<T>>( args, i, last );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+nlerp( const quaternion_soa<T> &a, const quaternion_soa<T> &b, T t, quaternion_soa<T> &out, size_t nthreads )
+{
+	check_sizes( a, b );
+	const size_t n = a.size();
+	out.resize( n );
+
+	const kernel_args<T> args = make_args( a, b, out );
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t first, size_t last )
+	{
+		size_t i = nlerp_kernel<simd_lane<T>>( args, t, first, last );
+		nlerp_kernel<scalar_lane<T>>( args, t, i, last );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+slerp( const quaternion_soa<T> &a, const quaternion_soa<T> &b, T t, quaternion_soa<T> &out, size_t nthreads )
+{
+	check_sizes( a, b );
+	const size_t n = a.size();
+	out.resize( n );
+
+	const kernel_args<T> args = make_args( a, b, out );
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t first, size_t last )
+	{
+		size_t i = slerp_kernel<simd_lane<T>>( args, t, first, last );
+		slerp_kernel<scalar_lane<T>>( args, t, i, last );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+to_matrix( const quaternion_soa<T> &q, vector_soa<T, 9> &out, size_t nthreads )
+{
+	const size_t n = q.size();
+	out.resize( n );
+
+	const T *const src[4] = { q.component( 0 ), q.component( 1 ), q.component( 2 ), q.component( 3 ) };
+	T *dst[9];
+	for ( size_t c = 0; c != 9; ++c )
+		dst[c] = out.component( c );
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t first, size_t last )
+	{
+		size_t i = matrix_kernel<simd_lane<T>>( src, dst, first, last );
+		matrix_kernel<scalar_lane<T>>( src, dst, i, last );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+#define YACO_INSTANTIATE_QUATERNION_SOA( T ) \
+	template void normalize( quaternion_soa<T> &, size_t ); \
+	template void multiply( const quaternion_soa<T> &, const quaternion_soa<T> &, quaternion_soa<T> &, size_t ); \
+	template void nlerp( const quaternion_soa<T> &, const quaternion_soa<T> &, T, quaternion_soa<T> &, size_t ); \
+	template void slerp( const quaternion_soa<T> &, const quaternion_soa<T> &, T, quaternion_soa<T> &, size_t ); \
+	template void to_matrix( const quaternion_soa<T> &, vector_soa<T, 9> &, size_t )
+
+YACO_INSTANTIATE_QUATERNION_SOA( float );
+YACO_INSTANTIATE_QUATERNION_SOA( double );
+
+#undef YACO_INSTANTIATE_QUATERNION_SOA
+
+} // math
+} // yaco
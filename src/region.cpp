@@ -21,11 +21,9 @@
 //
 
 #include <math/region.h>
-#include <set>
-#include <list>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
-#include <functional>
 #include <algorithm>
 
 
@@ -36,209 +34,92 @@ namespace
 {
 
 using namespace yaco::math;
+using yaco::__priv::region_coord;
 
-struct edge
+// below this many input regions, a parallel op just runs
+// on the calling thread
+constexpr size_t parallel_threshold = 4096;
+
+struct and_op { bool operator()( int a, int b ) const { return a > 0 && b > 0; } };
+struct or_op { bool operator()( int a, int b ) const { return a > 0 || b > 0; } };
+struct xor_op { bool operator()( int a, int b ) const { return ( a > 0 && b == 0 ) || ( b > 0 && a == 0 ); } };
+struct not_in_op { bool operator()( int a, int b ) const { return a > 0 && b == 0; } };
+struct covers_op { bool operator()( int a, int b ) const { return b > 0 && a == 0; } };
+
+template <typename Pred, typename T>
+inline region_list_t<T>
+parallel_set_op( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads )
 {
-	region::value_type left, right, y;
-	int inA, inB;
-	union 
-	{
-		bool out;
-		char __align_buf[alignof(region::value_type)];
-	};
-	edge( region::value_type l, region::value_type r, region::value_type p,
-		  int a, int b, bool o )
-			: left( l ), right( r ), y( p ), inA( a ), inB( b ), out( o )
-	{}
-
-	bool operator<( const edge &o ) const { return y < o.y; }
-};
-
-void add_region( region_list &retval,
-				 region_list::iterator &curout,
-				 region::value_type l,
-				 region::value_type r,
-				 region::value_type b,
-				 region::value_type t )
-{
-	region::value_type nt = t;
-	if ( nt != std::numeric_limits<region::value_type>::max() )
-		--nt;
-
-	if ( curout == retval.end() )
-	{
-		retval.push_back( region( l, r, b, nt ) );
-		curout = retval.end();
-	}
-	else
-	{
-		(*curout) = region( l, r, b, nt );
-		++curout;
-	}
+	if ( ( a.size() + b.size() ) < parallel_threshold )
+		nthreads = 1;
+	return region_combine_parallel( a, b, Pred(), nthreads );
 }
 
-void
-merge_sweep( region_list &retval,
-			 region_list::iterator &curout,
-			 std::list<edge> &sweep, std::list<edge>::iterator s,
-			 const std::function<bool (int, int)> &op )
+/// sweep + canonicalize, a and b are each a list or a region
+template <typename T, typename A, typename B, typename Pred>
+inline void
+region_set_op( region_list_t<T> &retval, const A &a, const B &b,
+			   const Pred &op, region_scratch_t<T> &scratch )
 {
-	auto o = s;
-	--o;
-
-	if ( (*s).out == (*o).out && (*s).inA == (*o).inA && (*s).inB == (*o).inB )
-	{
-		if ( op( (*s).inA, (*s).inB ) )
-		{
-			if ( (*s).y < (*o).y )
-			{
-				add_region( retval, curout, (*s).left, (*s).right, (*s).y, (*o).y );
-				(*s).y = (*o).y;
-			}
-			else if ( (*s).y > (*o).y )
-			{
-				add_region( retval, curout, (*o).left, (*o).right, (*o).y, (*s).y );
-
-				(*s).y = (*o).y;
-			}
-		}
-
-		(*s).left = (*o).left;
-		sweep.erase( o );
-	}
+	yaco::__priv::region_sweep( scratch.input, a, b, op, scratch );
+	yaco::__priv::region_canonicalize_input( retval, scratch );
 }
 
-void
-region_set_op( region_list &retval,
-			   const region_list &la,
-			   const region_list &lb,
-			   const std::function<bool (int, int)> &op )
+template <typename T, typename A, typename B, typename Pred>
+inline region_list_t<T>
+region_set_op( const A &a, const B &b, const Pred &op )
 {
-	std::multiset<edge> edges;
-	std::list<edge> sweep;
-	constexpr region::value_type neg_inf = std::numeric_limits<region::value_type>::min();
-	constexpr region::value_type pos_inf = std::numeric_limits<region::value_type>::max();
-
-	for ( auto a = la.begin(); a != la.end(); ++a )
-	{
-		if ( ! (*a).empty() )
-		{
-			edges.insert( edge( (*a).left(), (*a).right(),
-								std::max( (*a).top() + 1, (*a).top() ),
-								1, 0, true ) );
-			edges.insert( edge( (*a).left(), (*a).right(), (*a).bottom(),
-								1, 0, false ) );
-		}
-	}
-
-	for ( auto b = lb.begin(); b != lb.end(); ++b )
-	{
-		if ( ! (*b).empty() )
-		{
-			edges.insert( edge( (*b).left(), (*b).right(),
-								std::max( (*b).top() + 1, (*b).top() ),
-								0, 1, true ) );
-			edges.insert( edge( (*b).left(), (*b).right(), (*b).bottom(),
-								0, 1, false ) );
-		}
-	}
-
-	auto outi = retval.begin();
-
-	sweep.push_front( edge( neg_inf, pos_inf, neg_inf, 0, 0, false ) );
-
-	for ( auto e = edges.cbegin(); e != edges.cend(); ++e )
-	{
-		auto s = sweep.begin();
-
-		while ( (*e).left > (*s).right )
-			++s;
-
-		// intersect the edge with the sweep line and
-		// create any regions
-		while ( (*e).right >= (*s).left && s != sweep.end() )
-		{
-			if ( op( (*s).inA, (*s).inB ) && (*s).y < (*e).y )
-			{
-				add_region( retval, outi, (*s).left, (*s).right, (*s).y, (*e).y );
-				(*s).y = (*e).y;
-			}
-
-			region::value_type nl = std::max( (*e).left, (*s).left );
-			region::value_type nr = std::min( (*e).right, (*s).right );
-
-			// split beginning
-			if ( nl != (*s).left )
-			{
-				if ( nl == neg_inf )
-					throw std::runtime_error( "Negative infinity when trying to split edges" );
-
-				sweep.insert( s,
-							  edge( (*s).left, nl - 1, (*s).y,
-									(*s).inA, (*s).inB, (*s).out ) );
-
-				(*s).left = nl;
-			}
-
-			// split end
-			if ( nr != (*s).right )
-			{
-				if ( nr == pos_inf )
-					throw std::runtime_error( "Positive infinity when trying to split edges" );
-
-				sweep.insert( s,
-							  edge( (*s).left, nr, (*s).y,
-									(*s).inA, (*s).inB, (*s).out ) );
-
-				(*s).left = nr + 1;
-
-				// switch to prior
-				if ( s == sweep.begin() )
-					throw std::runtime_error( "Beginning of sweep list when splitting end" );
-
-				--s;
-			}
-
-			// update flags
-			if ( (*e).out )
-			{
-				(*s).inA = (*s).inA - (*e).inA;
-				(*s).inB = (*s).inB - (*e).inB;
-				if ( (*s).inA < 0 )
-					throw std::runtime_error( "Invalid edge count for a list" );
-				if ( (*s).inB < 0 )
-					throw std::runtime_error( "Invalid edge count for b list" );
-			}
-			else
-			{
-				(*s).inA = (*s).inA + (*e).inA;
-				(*s).inB = (*s).inB + (*e).inB;
-			}
-
-			// new y
-			(*s).y = (*e).y;
-
-			if ( s != sweep.begin() )
-				merge_sweep( retval, outi, sweep, s, op );
-
-			++s;
-		}
-
-		// after trying to intersect, see if we can join the next edge
-		if ( s != sweep.end() && s != sweep.end() )
-			merge_sweep( retval, outi, sweep, s, op );
-	}
+	region_list_t<T> retval;
+	region_set_op( retval, a, b, op, yaco::__priv::region_local_scratch<region_t<T>>() );
+	return retval;
+}
 
-	if ( outi != retval.end() )
-		retval.erase( outi, retval.end() );
+/// runs the sweep, handing each region of the result to visit
+template <typename T, typename A, typename B, typename Pred, typename Visit>
+inline bool
+region_visit( const A &a, const B &b, const Pred &op, Visit &&visit )
+{
+	auto &scratch = yaco::__priv::region_local_scratch<region_t<T>>();
+	yaco::__priv::region_sweep_edges( a, b, scratch );
+	return yaco::__priv::region_sweep_run( scratch, op, std::forward<Visit>( visit ) );
+}
+
+template <typename T, typename A, typename B>
+inline double
+region_intersection_area( const A &a, const B &b )
+{
+	typedef region_coord<T> coord;
+	double retval = 0.0;
+	region_visit<T>( a, b, and_op(),
+					 [&retval]( const region_t<T> &r )
+					 {
+						 // the integer sentinels would be multiplied
+						 // as ordinary numbers
+						 if ( r.infinite() )
+						 {
+							 retval = std::numeric_limits<double>::infinity();
+							 return false;
+						 }
+						 retval += ( double(r.right()) - double(r.left()) + double(coord::unit()) ) *
+							 ( double(r.top()) - double(r.bottom()) + double(coord::unit()) );
+						 return true;
+					 } );
+	return retval;
+}
 
-	sort_and_merge( retval );
+/// visitor stopping at the first region
+template <typename T>
+inline bool
+region_stop( const region_t<T> & )
+{
+	return false;
 }
 
-region_list
-computeXOR( const region &a, const region &b )
+template <typename T>
+region_list_t<T>
+computeXOR( const region_t<T> &a, const region_t<T> &b )
 {
-	region_list retval;
+	region_list_t<T> retval;
 
 	if ( a.intersects( b ) )
 	{
@@ -281,42 +162,42 @@ computeXOR( const region &a, const region &b )
 		//
 		if ( a.left() != b.left() )
 		{
-			region::value_type nl = std::min( a.left(), b.left() );
-			region::value_type nr = std::max( a.left(), b.left() ) - 1;
+			T nl = std::min( a.left(), b.left() );
+			T nr = region_coord<T>::prev( std::max( a.left(), b.left() ) );
 			if ( nl == a.left() )
-				retval.push_back( region( nl, nr, a.bottom(), a.top() ) );
+				retval.push_back( region_t<T>( nl, nr, a.bottom(), a.top() ) );
 			else
-				retval.push_back( region( nl, nr, b.bottom(), b.top() ) );
+				retval.push_back( region_t<T>( nl, nr, b.bottom(), b.top() ) );
 		}
 
 		if ( a.bottom() != b.bottom() )
 		{
-			region::value_type nb = std::min( a.bottom(), b.bottom() );
-			region::value_type nt = std::max( a.bottom(), b.bottom() ) - 1;
+			T nb = std::min( a.bottom(), b.bottom() );
+			T nt = region_coord<T>::prev( std::max( a.bottom(), b.bottom() ) );
 			if ( nb == a.bottom() )
-				retval.push_back( region( a.left(), a.right(), nb, nt ) );
+				retval.push_back( region_t<T>( a.left(), a.right(), nb, nt ) );
 			else
-				retval.push_back( region( b.left(), b.right(), nb, nt ) );
+				retval.push_back( region_t<T>( b.left(), b.right(), nb, nt ) );
 		}
 
 		if ( a.right() != b.right() )
 		{
-			region::value_type nl = std::min( a.right(), b.right() ) + 1;
-			region::value_type nr = std::max( a.right(), b.right() );
+			T nl = region_coord<T>::next( std::min( a.right(), b.right() ) );
+			T nr = std::max( a.right(), b.right() );
 			if ( nr == a.right() )
-				retval.push_back( region( nl, nr, a.bottom(), a.top() ) );
+				retval.push_back( region_t<T>( nl, nr, a.bottom(), a.top() ) );
 			else
-				retval.push_back( region( nl, nr, b.bottom(), b.top() ) );
+				retval.push_back( region_t<T>( nl, nr, b.bottom(), b.top() ) );
 		}
 
 		if ( a.top() != b.top() )
 		{
-			region::value_type nb = std::min( a.top(), b.top() ) + 1;
-			region::value_type nt = std::max( a.top(), b.top() );
+			T nb = region_coord<T>::next( std::min( a.top(), b.top() ) );
+			T nt = std::max( a.top(), b.top() );
 			if ( nt == a.top() )
-				retval.push_back( region( a.left(), a.right(), nb, nt ) );
+				retval.push_back( region_t<T>( a.left(), a.right(), nb, nt ) );
 			else
-				retval.push_back( region( b.left(), b.right(), nb, nt ) );
+				retval.push_back( region_t<T>( b.left(), b.right(), nb, nt ) );
 		}
 	}
 	else
@@ -330,10 +211,11 @@ computeXOR( const region &a, const region &b )
 	return retval;
 }
 
-region_list
-computeOR( const region &a, const region &b )
+template <typename T>
+region_list_t<T>
+computeOR( const region_t<T> &a, const region_t<T> &b )
 {
-	region_list retval;
+	region_list_t<T> retval;
 
 	if ( a == b || a.inside( b ) )
 		retval.push_back( b );
@@ -348,155 +230,40 @@ computeOR( const region &a, const region &b )
 	{
 		// have an intersection we care about
 		//
-		// up to 3 regions output
-		// 
+		// up to 3 bands output: the part of whichever region
+		// starts lower below the other, the rows both cover
+		// (one span, since they intersect), and the part of
+		// whichever region ends higher above the other
+		//
 		// +-------+
-		// |   1   |
+		// |   3   |
 		// |---+-------+
-		// |     2     |    A
+		// |     2     |
 		// +---|---+---|
-		//     |   3   |
-		//     +-------+
-		//
-		//     +-------+
 		//     |   1   |
-		// +-----------+
-		// |           |    B
-		// |   +  2    +
-		// |           |
-		// +-----------+
-		//
-		//     +-------+
-		//     |       |
-		// +----       +
-		// |   |       |
-		// | 1 |   2   |    C
-		// |   |       |
-		// +----       +
-		//     |       |
 		//     +-------+
 		//
-		// +-------+
-		// |   1   |
-		// +-----------+
-		// |           |    D
-		// +     2 +   |
-		// |           |
-		// +-----------+
-		//
-		// +-------+
-		// |       |
-		// +       |---+
-		// |       |   |
-		// |   1   | 2 |    E
-		// |       |   |
-		// +       |---+
-		// |       |
-		// +-------+
-		// 
-		// +-------+
-		// |       |
-		// +       +
-		// |   1   | F
-		// +       +
-		// |       |
-		// +-------+
-		//
-		// +---+---+---+
-		// |           |
-		// |     1     | G
-		// |           |
-		// +---+---+---+
-		//
-		if ( a.left() != b.left() )
-		{
-			region::value_type nl = std::min( a.left(), b.left() );
-			region::value_type nr = std::max( a.right(), b.right() );
-			region::value_type nb = std::max( a.bottom(), b.bottom() );
-			region::value_type nt = std::min( a.top(), b.top() );
-
-			if ( a.bottom() == nb && a.top() == nt )
-			{
-				// case C
-				retval.push_back( region( a.left(), a.right(), nb, nt ) );
-				retval.push_back( region( nl, nr, b.bottom(), b.top() ) );
-			}
-			else if ( b.bottom() == nb && b.top() == nt )
-			{
-				// case C
-				retval.push_back( region( b.left(), b.right(), nb, nt ) );
-				retval.push_back( region( nl, nr, a.bottom(), a.top() ) );
-			}
-			else
-			{
-				// case A or B
-				retval.push_back( region( nl, nr, nb, nt ) );
-
-				if ( a.top() > nt )
-					retval.push_back(
-						region( a.left(), a.right(), nt + 1, a.top() ) );
-				else if ( b.top() > nt )
-					retval.push_back(
-						region( b.left(), b.right(), nt + 1, b.top() ) );
-
-				if ( a.bottom() < nb )
-					retval.push_back(
-						region( a.left(), a.right(), a.bottom(), nb - 1 ) );
-				else if ( b.bottom() < nb )
-					retval.push_back(
-						region( b.left(), b.right(), b.bottom(), nb - 1 ) );
-			}
-		}
-		else if ( a.right() != b.right() )
+		T nb = std::max( a.bottom(), b.bottom() );
+		T nt = std::min( a.top(), b.top() );
+
+		if ( a.bottom() != b.bottom() )
 		{
-			region::value_type nl = a.left(); // left is the same
-			region::value_type nr = std::max( a.right(), b.right() );
-			region::value_type nb = std::max( a.bottom(), b.bottom() );
-			region::value_type nt = std::min( a.top(), b.top() );
-
-			if ( a.bottom() == nb && a.top() == nt )
-			{
-				// case E
-				retval.push_back( region( a.left(), a.right(), nb, nt ) );
-				retval.push_back( region( nl, nr, b.bottom(), b.top() ) );
-			}
-			else if ( b.bottom() == nb && b.top() == nt )
-			{
-				// case E
-				retval.push_back( region( b.left(), b.right(), nb, nt ) );
-				retval.push_back( region( nl, nr, a.bottom(), a.top() ) );
-			}
-			else
-			{
-				// case D
-				retval.push_back( region( nl, nr, nb, nt ) );
-
-				if ( a.top() > nt )
-					retval.push_back(
-						region( a.left(), a.right(), nt + 1, a.top() ) );
-				else if ( b.top() > nt )
-					retval.push_back(
-						region( b.left(), b.right(), nt + 1, b.top() ) );
-
-				if ( a.bottom() < nb )
-					retval.push_back(
-						region( a.left(), a.right(), a.bottom(), nb - 1 ) );
-				else if ( b.bottom() < nb )
-					retval.push_back(
-						region( b.left(), b.right(), b.bottom(), nb - 1 ) );
-			}
+			const region_t<T> &low = a.bottom() < b.bottom() ? a : b;
+			retval.push_back( region_t<T>( low.left(), low.right(), low.bottom(), region_coord<T>::prev( nb ) ) );
 		}
-		else
+
+		retval.push_back( region_t<T>( std::min( a.left(), b.left() ), std::max( a.right(), b.right() ), nb, nt ) );
+
+		if ( a.top() != b.top() )
 		{
-			region tmp = a;
-			tmp.merge( b );
-			retval.push_back( tmp );
+			const region_t<T> &high = a.top() > b.top() ? a : b;
+			retval.push_back( region_t<T>( high.left(), high.right(), region_coord<T>::next( nt ), high.top() ) );
 		}
 	}
 
 	sort_and_merge( retval );
 
-	return std::move( retval );
+	return retval;
 }
 
 } // empty namespace
@@ -514,39 +281,42 @@ namespace math
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::reset( infinite_tag_t )
+region_t<T>::reset( infinite_tag_t )
 {
-	myL = myB = std::numeric_limits<value_type>::min();
-	myR = myT = std::numeric_limits<value_type>::max();
+	myL = myB = coord::lowest();
+	myR = myT = coord::highest();
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::reset_by_size( value_type ox, value_type oy, value_type sx, value_type sy )
+region_t<T>::reset_by_size( value_type ox, value_type oy, value_type sx, value_type sy )
 {
 	myL = ox;
 	myB = oy;
-	myR = ox + sx - 1;
-	myT = oy + sy - 1;
+	myR = ox + sx - coord::unit();
+	myT = oy + sy - coord::unit();
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::set_offset( int ox, int oy )
+region_t<T>::set_offset( value_type ox, value_type oy )
 {
 	if ( empty() )
 	{
 		myL = ox;
 		myB = oy;
-		myR = ox - 1;
-		myT = oy - 1;
+		myR = coord::prev( ox );
+		myT = coord::prev( oy );
 	}
 	else
 	{
@@ -558,7 +328,7 @@ region::set_offset( int ox, int oy )
 		{
 			value_type s = size_x();
 			myL = ox;
-			myR = ox + s - 1;
+			myR = ox + s - coord::unit();
 		}
 
 		if ( infinite_y() )
@@ -569,7 +339,7 @@ region::set_offset( int ox, int oy )
 		{
 			value_type s = size_y();
 			myB = oy;
-			myT = oy + s - 1;
+			myT = oy + s - coord::unit();
 		}
 	}
 }
@@ -578,37 +348,40 @@ region::set_offset( int ox, int oy )
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::set_size( int sx, int sy )
+region_t<T>::set_size( value_type sx, value_type sy )
 {
-	myR = myL + sx - 1;
-	myT = myB + sy - 1;
+	myR = myL + sx - coord::unit();
+	myT = myB + sy - coord::unit();
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::intersect( const region &o )
+region_t<T>::intersect( const region_t<T> &o )
 {
 	myL = std::max( myL, o.myL );
 	myR = std::min( myR, o.myR );
 	if ( myR < myL )
-		myR = myL - 1;
+		myR = coord::prev( myL );
 
 	myB = std::max( myB, o.myB );
 	myT = std::min( myT, o.myT );
 	if ( myT < myB )
-		myT = myB - 1;
+		myT = coord::prev( myB );
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::merge( const region &o )
+region_t<T>::merge( const region_t<T> &o )
 {
 	myL = std::min( left(), o.left() );
 	myR = std::max( right(), o.right() );
@@ -620,30 +393,32 @@ region::merge( const region &o )
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-region::grow( value_type left, value_type right, value_type bottom, value_type top )
+region_t<T>::grow( value_type left, value_type right, value_type bottom, value_type top )
 {
-	if ( myL > std::numeric_limits<value_type>::min() )
+	if ( myL > coord::lowest() )
 		myL -= left;
-	if ( myR < std::numeric_limits<value_type>::max() )
+	if ( myR < coord::highest() )
 		myR += right;
 	if ( myR < myL )
-		myR = myL - 1;
+		myR = coord::prev( myL );
 
-	if ( myB > std::numeric_limits<value_type>::min() )
+	if ( myB > coord::lowest() )
 		myB -= bottom;
-	if ( myT < std::numeric_limits<value_type>::max() )
+	if ( myT < coord::highest() )
 		myT += top;
 	if ( myT < myB )
-		myT = myB - 1;
+		myT = coord::prev( myB );
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
 std::ostream &
-operator<<( std::ostream &out, const region &r )
+operator<<( std::ostream &out, const region_t<T> &r )
 {
 	out << "region( " << r.left() << ", " << r.right() << ", " << r.bottom()
 		<< ", " << r.top() << " )";
@@ -654,8 +429,9 @@ operator<<( std::ostream &out, const region &r )
 ////////////////////////////////////////
 
 
+template <typename T>
 std::ostream &
-operator<<( std::ostream &out, const region_list &rl )
+operator<<( std::ostream &out, const region_list_t<T> &rl )
 {
 	for ( auto r = rl.begin(); r != rl.end(); ++r )
 	{
@@ -670,157 +446,118 @@ operator<<( std::ostream &out, const region_list &rl )
 ////////////////////////////////////////
 
 
+template <typename T>
 void
-sort_and_merge( region_list &a )
+canonicalize( region_list_t<T> &a )
 {
-	if ( a.size() <= 1 )
-		return;
+	yaco::__priv::region_canonicalize( a, yaco::__priv::region_local_scratch<region_t<T>>() );
+}
 
-	bool made_change;
-	do
-	{
-		made_change = false;
-		auto i = a.begin();
-		while ( i != a.end() )
-		{
-			region_list::difference_type xi = i - a.begin();
-
-			if ( (*i).empty() )
-			{
-				a.erase( i );
-				i = a.begin() + xi;
-				continue;
-			}
-
-			auto o = i;
-			++o;
-			while ( o != a.end() )
-			{
-				const region &c = (*i);
-				const region &p = (*o);
-
-				if ( p.inside( c ) ||
-					 ( c.left() == p.left() && c.right() == p.right() &&
-					   ( c.contains_y( p.bottom() ) ||
-						 p.contains_y( c.bottom() ) ||
-						 c.bottom() == ( p.top() + 1 ) ||
-						 c.top() == ( p.bottom() - 1 ) ) ) ||
-					 ( c.bottom() == p.bottom() && c.top() == p.top() &&
-					   ( c.contains_x( p.left() ) ||
-						 p.contains_x( c.left() ) ||
-						 c.left() == ( p.right() - 1 ) ||
-						 c.right() == ( p.left() + 1 ) ) ) )
-				{
-					(*i).merge( p );
-
-					a.erase( o );
-					i = a.begin() + xi;
-					// restart the search in case we can merge more
-					o = i;
-					++o;
-					made_change = true;
-					continue;
-				}
-				++o;
-			}
-
-			++i;
-		}
-	} while ( made_change );
 
-	std::sort( a.begin(), a.end() );
+////////////////////////////////////////
+
+
+template <typename T>
+void
+sort_and_merge( region_list_t<T> &a )
+{
+	canonicalize( a );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator&( region_list la, const region_list &lb )
+template <typename T>
+region_list_t<T>
+operator&( region_list_t<T> la, const region_list_t<T> &lb )
 {
-	region_set_op( la, la, lb, []( int a, int b ) { return a > 0 && b > 0; } );
-	return std::move( la );
+	region_set_op( la, la, lb, and_op(), yaco::__priv::region_local_scratch<region_t<T>>() );
+	return la;
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator&( const region_list &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator&( const region_list_t<T> &a, const region_t<T> &b )
 {
-	region_list tmp{ b };
-	return std::move( tmp ) & a;
+	return region_set_op<T>( a, b, and_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator&( const region &a, const region_list &b )
+template <typename T>
+region_list_t<T>
+operator&( const region_t<T> &a, const region_list_t<T> &b )
 {
-	region_list tmp{ a };
-	return std::move( tmp ) & b;
+	return region_set_op<T>( a, b, and_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator&( const region &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator&( const region_t<T> &a, const region_t<T> &b )
 {
-	region_list retval;
+	region_list_t<T> retval;
 
-	region tmp( a );
+	region_t<T> tmp( a );
 	tmp.intersect( b );
 
 	if ( ! tmp.empty() )
 		retval.push_back( tmp );
 
-	return std::move( retval );
+	return retval;
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator|( region_list la, const region_list &lb )
+template <typename T>
+region_list_t<T>
+operator|( region_list_t<T> la, const region_list_t<T> &lb )
 {
-	region_set_op( la, la, lb, []( int a, int b ) { return a > 0 || b > 0; } );
-	return std::move( la );
+	region_set_op( la, la, lb, or_op(), yaco::__priv::region_local_scratch<region_t<T>>() );
+	return la;
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator|( const region_list &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator|( const region_list_t<T> &a, const region_t<T> &b )
 {
-	region_list tmp{ b };
-	return std::move( tmp ) | a;
+	return region_set_op<T>( a, b, or_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator|( const region &a, const region_list &b )
+template <typename T>
+region_list_t<T>
+operator|( const region_t<T> &a, const region_list_t<T> &b )
 {
-	region_list tmp{ a };
-	return std::move( tmp ) | b;
+	return region_set_op<T>( a, b, or_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator|( const region &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator|( const region_t<T> &a, const region_t<T> &b )
 {
 	return computeOR( a, b );
 }
@@ -829,41 +566,43 @@ operator|( const region &a, const region &b )
 ////////////////////////////////////////
 
 
-region_list
-operator^( region_list la, const region_list &lb )
+template <typename T>
+region_list_t<T>
+operator^( region_list_t<T> la, const region_list_t<T> &lb )
 {
-	region_set_op( la, la, lb, []( int a, int b ) { return ( a > 0 && b == 0 ) || ( b > 0 && a == 0 ); } );
-	return std::move( la );
+	region_set_op( la, la, lb, xor_op(), yaco::__priv::region_local_scratch<region_t<T>>() );
+	return la;
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator^( const region_list &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator^( const region_list_t<T> &a, const region_t<T> &b )
 {
-	region_list tmp{ b };
-	return std::move( tmp ) ^ a;
+	return region_set_op<T>( a, b, xor_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator^( const region &a, const region_list &b )
+template <typename T>
+region_list_t<T>
+operator^( const region_t<T> &a, const region_list_t<T> &b )
 {
-	region_list tmp{ a };
-	return std::move( tmp ) ^ b;
+	return region_set_op<T>( a, b, xor_op() );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator^( const region &a, const region &b )
+template <typename T>
+region_list_t<T>
+operator^( const region_t<T> &a, const region_t<T> &b )
 {
 	return computeXOR( a, b );
 }
@@ -872,61 +611,296 @@ operator^( const region &a, const region &b )
 ////////////////////////////////////////
 
 
-region_list
-operator~( const region &a )
+template <typename T>
+region_list_t<T>
+operator~( const region_t<T> &a )
+{
+	return computeXOR( region_t<T>( region_t<T>::inf ), a );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+operator~( const region_list_t<T> &a )
+{
+	return region_set_op<T>( region_t<T>( region_t<T>::inf ), a, not_in_op() );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+not_in( region_list_t<T> la, const region_list_t<T> &lb )
+{
+	region_set_op( la, la, lb, not_in_op(), yaco::__priv::region_local_scratch<region_t<T>>() );
+	return la;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+not_in( const region_list_t<T> &a, const region_t<T> &b )
+{
+	return region_set_op<T>( a, b, not_in_op() );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+not_in( const region_t<T> &a, const region_list_t<T> &b )
+{
+	return region_set_op<T>( a, b, not_in_op() );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+parallel_and( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads )
 {
-	return computeXOR( region( region::inf ), a );
+	return parallel_set_op<and_op>( a, b, nthreads );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-operator~( const region_list &a )
+template <typename T>
+region_list_t<T>
+parallel_or( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads )
 {
-	region_list retval{ region( region::inf ) };
+	return parallel_set_op<or_op>( a, b, nthreads );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+parallel_xor( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads )
+{
+	return parallel_set_op<xor_op>( a, b, nthreads );
+}
+
 
-	return std::move( retval ) ^ a;
+////////////////////////////////////////
+
+
+template <typename T>
+region_list_t<T>
+parallel_not_in( const region_list_t<T> &a, const region_list_t<T> &b, size_t nthreads )
+{
+	return parallel_set_op<not_in_op>( a, b, nthreads );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-not_in( region_list la, const region_list &lb )
+#define YACO_REGION_INTO( name, op ) \
+	template <typename T> \
+	void name( region_list_t<T> &out, const region_list_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch ) \
+	{ region_set_op( out, a, b, op(), scratch ); } \
+	template <typename T> \
+	void name( region_list_t<T> &out, const region_list_t<T> &a, const region_t<T> &b, region_scratch_t<T> &scratch ) \
+	{ region_set_op( out, a, b, op(), scratch ); }
+
+YACO_REGION_INTO( intersect_into, and_op )
+YACO_REGION_INTO( union_into, or_op )
+YACO_REGION_INTO( xor_into, xor_op )
+YACO_REGION_INTO( not_in_into, not_in_op )
+
+#undef YACO_REGION_INTO
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+not_in_into( region_list_t<T> &out, const region_t<T> &a, const region_list_t<T> &b, region_scratch_t<T> &scratch )
 {
-	region_set_op( la, la, lb, []( int a, int b ) { return a > 0 && b == 0; } );
-	return std::move( la );
+	region_set_op( out, a, b, not_in_op(), scratch );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-not_in( const region_list &a, const region &b )
+template <typename T>
+void
+complement_into( region_list_t<T> &out, const region_list_t<T> &a, region_scratch_t<T> &scratch )
 {
-	region_list tmp{ b };
-	return not_in( std::move( tmp ), a );
+	region_set_op( out, region_t<T>( region_t<T>::inf ), a, not_in_op(), scratch );
 }
 
 
 ////////////////////////////////////////
 
 
-region_list
-not_in( const region &a, const region_list &b )
+template <typename T>
+double
+intersection_area( const region_list_t<T> &a, const region_list_t<T> &b )
 {
-	region_list tmp = { a };
-	return not_in( std::move( tmp ), b );
+	return region_intersection_area<T>( a, b );
 }
 
 
 ////////////////////////////////////////
 
 
+template <typename T>
+double
+intersection_area( const region_list_t<T> &a, const region_t<T> &b )
+{
+	return region_intersection_area<T>( a, b );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+bool
+any_overlap( const region_list_t<T> &a, const region_list_t<T> &b )
+{
+	if ( a.empty() || b.empty() )
+		return false;
+	return ! region_visit<T>( a, b, and_op(), region_stop<T> );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+bool
+any_overlap( const region_list_t<T> &a, const region_t<T> &b )
+{
+	if ( b.empty() )
+		return false;
+	for ( const auto &r: a )
+	{
+		if ( ! r.empty() && r.intersects( b ) )
+			return true;
+	}
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+bool
+covers( const region_list_t<T> &a, const region_list_t<T> &b )
+{
+	return region_visit<T>( a, b, covers_op(), region_stop<T> );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+bool
+covers( const region_list_t<T> &a, const region_t<T> &b )
+{
+	if ( b.empty() )
+		return true;
+	for ( const auto &r: a )
+	{
+		if ( ! r.empty() && b.inside( r ) )
+			return true;
+	}
+	return region_visit<T>( a, b, covers_op(), region_stop<T> );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+bool
+equal_coverage( const region_list_t<T> &a, const region_list_t<T> &b )
+{
+	return region_visit<T>( a, b, xor_op(), region_stop<T> );
+}
+
+
+////////////////////////////////////////
+
+
+#define YACO_INSTANTIATE_REGION( T ) \
+	template class region_t<T>; \
+	template std::ostream &operator<<( std::ostream &, const region_t<T> & ); \
+	template std::ostream &operator<<( std::ostream &, const region_list_t<T> & ); \
+	template void canonicalize( region_list_t<T> & ); \
+	template void sort_and_merge( region_list_t<T> & ); \
+	template region_list_t<T> operator&( region_list_t<T>, const region_list_t<T> & ); \
+	template region_list_t<T> operator&( const region_list_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator&( const region_t<T> &, const region_list_t<T> & ); \
+	template region_list_t<T> operator&( const region_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator|( region_list_t<T>, const region_list_t<T> & ); \
+	template region_list_t<T> operator|( const region_list_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator|( const region_t<T> &, const region_list_t<T> & ); \
+	template region_list_t<T> operator|( const region_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator^( region_list_t<T>, const region_list_t<T> & ); \
+	template region_list_t<T> operator^( const region_list_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator^( const region_t<T> &, const region_list_t<T> & ); \
+	template region_list_t<T> operator^( const region_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> operator~( const region_t<T> & ); \
+	template region_list_t<T> operator~( const region_list_t<T> & ); \
+	template region_list_t<T> not_in( region_list_t<T>, const region_list_t<T> & ); \
+	template region_list_t<T> not_in( const region_list_t<T> &, const region_t<T> & ); \
+	template region_list_t<T> not_in( const region_t<T> &, const region_list_t<T> & ); \
+	template region_list_t<T> parallel_and( const region_list_t<T> &, const region_list_t<T> &, size_t ); \
+	template region_list_t<T> parallel_or( const region_list_t<T> &, const region_list_t<T> &, size_t ); \
+	template region_list_t<T> parallel_xor( const region_list_t<T> &, const region_list_t<T> &, size_t ); \
+	template region_list_t<T> parallel_not_in( const region_list_t<T> &, const region_list_t<T> &, size_t ); \
+	template void intersect_into( region_list_t<T> &, const region_list_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template void intersect_into( region_list_t<T> &, const region_list_t<T> &, const region_t<T> &, region_scratch_t<T> & ); \
+	template void union_into( region_list_t<T> &, const region_list_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template void union_into( region_list_t<T> &, const region_list_t<T> &, const region_t<T> &, region_scratch_t<T> & ); \
+	template void xor_into( region_list_t<T> &, const region_list_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template void xor_into( region_list_t<T> &, const region_list_t<T> &, const region_t<T> &, region_scratch_t<T> & ); \
+	template void not_in_into( region_list_t<T> &, const region_list_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template void not_in_into( region_list_t<T> &, const region_list_t<T> &, const region_t<T> &, region_scratch_t<T> & ); \
+	template void not_in_into( region_list_t<T> &, const region_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template void complement_into( region_list_t<T> &, const region_list_t<T> &, region_scratch_t<T> & ); \
+	template double intersection_area( const region_list_t<T> &, const region_list_t<T> & ); \
+	template double intersection_area( const region_list_t<T> &, const region_t<T> & ); \
+	template bool any_overlap( const region_list_t<T> &, const region_list_t<T> & ); \
+	template bool any_overlap( const region_list_t<T> &, const region_t<T> & ); \
+	template bool covers( const region_list_t<T> &, const region_list_t<T> & ); \
+	template bool covers( const region_list_t<T> &, const region_t<T> & ); \
+	template bool equal_coverage( const region_list_t<T> &, const region_list_t<T> & )
+
+YACO_INSTANTIATE_REGION( int );
+YACO_INSTANTIATE_REGION( int64_t );
+YACO_INSTANTIATE_REGION( float );
+YACO_INSTANTIATE_REGION( double );
+
+#undef YACO_INSTANTIATE_REGION
+
+
+////////////////////////////////////////
+
+
 } // math
 } // yaco
 
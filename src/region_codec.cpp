@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/region_codec.h>
+#include <algorithm>
+#include <stdexcept>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+inline uint64_t
+bits( int64_t v )
+{
+	return static_cast<uint64_t>( v );
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+encode_regions( std::vector<uint8_t> &out, const region_list_t<T> &l )
+{
+	using __priv::varint_write;
+	using __priv::zigzag_encode;
+
+	region_list_t<T> bands = l;
+	canonicalize( bands );
+
+	// typically 2 bytes a region, and 3 more for each band
+	out.reserve( out.size() + 1 + bands.size() * 3 );
+	varint_write( out, bands.size() );
+
+	uint64_t top = 0, firstLeft = 0;
+	for ( size_t b = 0; b != bands.size(); )
+	{
+		const region_t<T> &band = bands[b];
+		size_t e = b + 1;
+		while ( e != bands.size() && bands[e].bottom() == band.bottom() && bands[e].top() == band.top() )
+			++e;
+
+		varint_write( out, zigzag_encode( bits( band.bottom() ) - top ) );
+		varint_write( out, bits( band.top() ) - bits( band.bottom() ) );
+		varint_write( out, e - b );
+		varint_write( out, zigzag_encode( bits( band.left() ) - firstLeft ) );
+		varint_write( out, bits( band.right() ) - bits( band.left() ) );
+		for ( size_t i = b + 1; i != e; ++i )
+		{
+			varint_write( out, bits( bands[i].left() ) - bits( bands[i - 1].right() ) );
+			varint_write( out, bits( bands[i].right() ) - bits( bands[i].left() ) );
+		}
+
+		top = bits( band.top() );
+		firstLeft = bits( band.left() );
+		b = e;
+	}
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+decode_regions( region_list_t<T> &out, const uint8_t *data, size_t size )
+{
+	region_decoder_t<T> dec( data, size );
+
+	out.clear();
+	// every region takes at least 2 bytes, so a bad count can't
+	// make this reserve much more than the buffer size
+	out.reserve( std::min( dec.size(), size / 2 ) );
+
+	auto i = dec.begin();
+	for ( size_t n = dec.size(); n > 0; --n, ++i )
+		out.push_back( *i );
+
+	if ( i.position() != data + size )
+		throw std::runtime_error( "Unexpected data after encoded region list" );
+}
+
+
+////////////////////////////////////////
+
+
+template void encode_regions( std::vector<uint8_t> &, const region_list_t<int> & );
+template void encode_regions( std::vector<uint8_t> &, const region_list_t<int64_t> & );
+template void decode_regions( region_list_t<int> &, const uint8_t *, size_t );
+template void decode_regions( region_list_t<int64_t> &, const uint8_t *, size_t );
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
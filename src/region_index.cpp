@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_index.h>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+
+/// position of (x, y) along a 2^16 x 2^16 hilbert curve
+/// (branch free version from "Fast Hilbert curve generation" by
+/// rawrunprotected, as used in flatbush)
+uint32_t
+hilbert( uint32_t x, uint32_t y )
+{
+	uint32_t a = x ^ y;
+	uint32_t b = 0xFFFF ^ a;
+	uint32_t c = 0xFFFF ^ ( x | y );
+	uint32_t d = x & ( y ^ 0xFFFF );
+
+	uint32_t A = a | ( b >> 1 );
+	uint32_t B = ( a >> 1 ) ^ a;
+	uint32_t C = ( ( c >> 1 ) ^ ( b & ( d >> 1 ) ) ) ^ c;
+	uint32_t D = ( ( a & ( c >> 1 ) ) ^ ( d >> 1 ) ) ^ d;
+
+	a = A; b = B; c = C; d = D;
+	A = ( ( a & ( a >> 2 ) ) ^ ( b & ( b >> 2 ) ) );
+	B = ( ( a & ( b >> 2 ) ) ^ ( b & ( ( a ^ b ) >> 2 ) ) );
+	C ^= ( ( a & ( c >> 2 ) ) ^ ( b & ( d >> 2 ) ) );
+	D ^= ( ( b & ( c >> 2 ) ) ^ ( ( a ^ b ) & ( d >> 2 ) ) );
+
+	a = A; b = B; c = C; d = D;
+	A = ( ( a & ( a >> 4 ) ) ^ ( b & ( b >> 4 ) ) );
+	B = ( ( a & ( b >> 4 ) ) ^ ( b & ( ( a ^ b ) >> 4 ) ) );
+	C ^= ( ( a & ( c >> 4 ) ) ^ ( b & ( d >> 4 ) ) );
+	D ^= ( ( b & ( c >> 4 ) ) ^ ( ( a ^ b ) & ( d >> 4 ) ) );
+
+	a = A; b = B; c = C; d = D;
+	C ^= ( ( a & ( c >> 8 ) ) ^ ( b & ( d >> 8 ) ) );
+	D ^= ( ( b & ( c >> 8 ) ) ^ ( ( a ^ b ) & ( d >> 8 ) ) );
+
+	a = C ^ ( C >> 1 );
+	b = D ^ ( D >> 1 );
+
+	uint32_t i0 = x ^ y;
+	uint32_t i1 = b | ( 0xFFFF ^ ( i0 | a ) );
+
+	i0 = ( i0 | ( i0 << 8 ) ) & 0x00FF00FF;
+	i0 = ( i0 | ( i0 << 4 ) ) & 0x0F0F0F0F;
+	i0 = ( i0 | ( i0 << 2 ) ) & 0x33333333;
+	i0 = ( i0 | ( i0 << 1 ) ) & 0x55555555;
+
+	i1 = ( i1 | ( i1 << 8 ) ) & 0x00FF00FF;
+	i1 = ( i1 | ( i1 << 4 ) ) & 0x0F0F0F0F;
+	i1 = ( i1 | ( i1 << 2 ) ) & 0x33333333;
+	i1 = ( i1 | ( i1 << 1 ) ) & 0x55555555;
+
+	return ( i1 << 1 ) | i0;
+}
+
+/// squared distance from a point to the closest point of a region
+inline double
+distance_sq( const region &r, double x, double y )
+{
+	double dx = std::max( 0.0, std::max( double(r.left()) - x, x - double(r.right()) ) );
+	double dy = std::max( 0.0, std::max( double(r.bottom()) - y, y - double(r.top()) ) );
+	return dx * dx + dy * dy;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+void
+region_index::build( const region_list &l, size_t node_size )
+{
+	if ( node_size < 2 )
+		throw std::invalid_argument( "region_index node size must be at least 2" );
+	if ( l.size() > std::numeric_limits<uint32_t>::max() )
+		throw std::length_error( "too many regions for region_index" );
+
+	clear();
+	myNodeSize = node_size;
+
+	std::vector<uint32_t> items;
+	items.reserve( l.size() );
+	region all;
+	for ( size_t i = 0; i != l.size(); ++i )
+	{
+		if ( l[i].empty() )
+			continue;
+		if ( items.empty() )
+			all = l[i];
+		else
+			all.merge( l[i] );
+		items.push_back( static_cast<uint32_t>( i ) );
+	}
+	if ( items.empty() )
+		return;
+
+	// hilbert sort of the centers, scaled to the overall bounds
+	double ox = double(all.left()), oy = double(all.bottom());
+	double w = std::max( 1.0, double(all.right()) - ox );
+	double h = std::max( 1.0, double(all.top()) - oy );
+	std::vector<uint32_t> hv( l.size() );
+	for ( uint32_t i: items )
+	{
+		const region &r = l[i];
+		double cx = ( double(r.left()) + double(r.right()) ) * 0.5;
+		double cy = ( double(r.bottom()) + double(r.top()) ) * 0.5;
+		hv[i] = hilbert( static_cast<uint32_t>( 65535.0 * ( cx - ox ) / w ),
+						 static_cast<uint32_t>( 65535.0 * ( cy - oy ) / h ) );
+	}
+	std::sort( items.begin(), items.end(),
+			   [&]( uint32_t a, uint32_t b ) { return hv[a] < hv[b] || ( hv[a] == hv[b] && a < b ); } );
+
+	size_t n = items.size();
+	size_t total = n;
+	for ( size_t c = n; c > 1 || total == n; )
+	{
+		c = ( c + node_size - 1 ) / node_size;
+		total += c;
+	}
+	myBoxes.reserve( total );
+	myIndex.reserve( total );
+
+	for ( uint32_t i: items )
+	{
+		myBoxes.push_back( l[i] );
+		myIndex.push_back( i );
+	}
+	myLevels.push_back( n );
+
+	// always at least one level of parents, so the root is never a leaf
+	size_t levelStart = 0;
+	do
+	{
+		size_t levelEnd = myBoxes.size();
+		for ( size_t i = levelStart; i < levelEnd; i += node_size )
+		{
+			region b = myBoxes[i];
+			size_t e = std::min( i + node_size, levelEnd );
+			for ( size_t c = i + 1; c < e; ++c )
+				b.merge( myBoxes[c] );
+			myBoxes.push_back( b );
+			myIndex.push_back( static_cast<uint32_t>( i ) );
+		}
+		levelStart = levelEnd;
+		myLevels.push_back( myBoxes.size() );
+	} while ( myBoxes.size() - levelStart > 1 );
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_index::clear( void )
+{
+	myBoxes.clear();
+	myIndex.clear();
+	myLevels.clear();
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_index::query( const region &q, std::vector<uint32_t> &out, size_t max_results ) const
+{
+	out.clear();
+	if ( max_results == 0 )
+		return 0;
+
+	visit( q, [&]( uint32_t i )
+		   {
+			   out.push_back( i );
+			   return out.size() < max_results;
+		   } );
+	return out.size();
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_index::query( value_type x, value_type y, std::vector<uint32_t> &out, size_t max_results ) const
+{
+	return query( region( x, x, y, y ), out, max_results );
+}
+
+
+////////////////////////////////////////
+
+
+bool
+region_index::any( const region &q ) const
+{
+	bool found = false;
+	visit( q, [&]( uint32_t ) { found = true; return false; } );
+	return found;
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_index::nearest( value_type x, value_type y, size_t k, std::vector<uint32_t> &out ) const
+{
+	out.clear();
+	if ( k == 0 || myBoxes.empty() )
+		return 0;
+
+	// best first search: nodes and leaves share the queue, ordered
+	// by distance, so a leaf is only popped once nothing left can be
+	// closer
+	struct item
+	{
+		double d;
+		size_t pos, level;
+		bool operator<( const item &o ) const { return d > o.d || ( d == o.d && level > o.level ); }
+	};
+
+	double px = double(x), py = double(y);
+	std::priority_queue<item> q;
+	q.push( item{ distance_sq( myBoxes.back(), px, py ), myBoxes.size() - 1, myLevels.size() - 1 } );
+	while ( ! q.empty() )
+	{
+		item n = q.top();
+		q.pop();
+
+		if ( n.level == 0 )
+		{
+			out.push_back( myIndex[n.pos] );
+			if ( out.size() == k )
+				break;
+			continue;
+		}
+
+		size_t first = myIndex[n.pos];
+		size_t last = std::min( first + myNodeSize, myLevels[n.level - 1] );
+		for ( size_t c = first; c != last; ++c )
+			q.push( item{ distance_sq( myBoxes[c], px, py ), c, n.level - 1 } );
+	}
+	return out.size();
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
@@ -0,0 +1,454 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_raster.h>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define YACO_RASTER_SSE2 1
+#endif
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+
+typedef coverage_rle::run run;
+
+inline uint64_t
+low_bits( int n )
+{
+	return n >= 64 ? ~uint64_t(0) : ( ( uint64_t(1) << n ) - 1 );
+}
+
+/// true if the 128 bits at p are all equal to fill
+inline bool
+block_is( const uint64_t *p, uint64_t fill )
+{
+#ifdef YACO_RASTER_SSE2
+	__m128i v = _mm_load_si128( reinterpret_cast<const __m128i *>( p ) );
+	__m128i f = _mm_set1_epi32( static_cast<int>( fill ) );
+	return _mm_movemask_epi8( _mm_cmpeq_epi8( v, f ) ) == 0xFFFF;
+#else
+	return p[0] == fill && p[1] == fill;
+#endif
+}
+
+/// appends the runs of set bits in a mask row, in pixel
+/// coordinates. Solid or empty 128 bit blocks are skipped whole,
+/// otherwise the transitions are found a word at a time with
+/// count trailing zeros.
+void
+row_runs( const uint64_t *row, size_t words, int left, int width, std::vector<run> &out )
+{
+	bool in = false;
+	int start = 0;
+	for ( size_t w = 0; w < words; )
+	{
+		if ( ( w & 1 ) == 0 && w + 2 <= words && block_is( row + w, in ? ~uint64_t(0) : 0 ) )
+		{
+			w += 2;
+			continue;
+		}
+
+		uint64_t bits = row[w];
+		int base = static_cast<int>( w * 64 );
+		uint64_t from = ~uint64_t(0);
+		while ( true )
+		{
+			uint64_t x = ( in ? ~bits : bits ) & from;
+			if ( x == 0 )
+				break;
+			int p = __builtin_ctzll( x );
+			if ( in )
+				out.push_back( run{ left + start, left + base + p } );
+			else
+				start = base + p;
+			in = ! in;
+			from = ~uint64_t(0) << p;
+		}
+		++w;
+	}
+	if ( in )
+		out.push_back( run{ left + start, left + width } );
+}
+
+/// builds a banded list from rows of maximal runs: consecutive rows
+/// with identical runs become one band
+class band_builder
+{
+public:
+	explicit band_builder( region_list &out ) : myOut( out ) {}
+
+	void add_row( int y, const run *b, const run *e )
+	{
+		size_t n = static_cast<size_t>( e - b );
+		if ( n > 0 && n == myPrevCount && y == myPrevY + 1 &&
+			 std::equal( b, e, myPrev.begin() ) )
+		{
+			for ( size_t i = myBandStart; i != myOut.size(); ++i )
+			{
+				const region &r = myOut[i];
+				myOut[i] = region( r.left(), r.right(), r.bottom(), y );
+			}
+			myPrevY = y;
+			return;
+		}
+
+		myBandStart = myOut.size();
+		for ( const run *r = b; r != e; ++r )
+			myOut.push_back( region( r->x0, r->x1 - 1, y, y ) );
+		myPrev.assign( b, e );
+		myPrevCount = n;
+		myPrevY = y;
+	}
+
+private:
+	region_list &myOut;
+	std::vector<run> myPrev;
+	size_t myPrevCount = 0;
+	size_t myBandStart = 0;
+	int myPrevY = 0;
+};
+
+void
+check_finite( const region &r )
+{
+	if ( ! r.empty() && r.infinite() )
+		throw std::invalid_argument( "coverage window must be finite" );
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+region_spans::const_iterator::const_iterator( const region *b, const region *e )
+		: myBand( b ), myCur( b ), myEnd( e )
+{
+	if ( b != e )
+	{
+		myBandEnd = __priv::region_band_end( b, e );
+		mySpan.y = b->bottom();
+		load();
+	}
+}
+
+
+////////////////////////////////////////
+
+
+region_spans::const_iterator &
+region_spans::const_iterator::operator++( void )
+{
+	if ( ++myCur == myBandEnd )
+	{
+		if ( mySpan.y != myBand->top() )
+		{
+			++mySpan.y;
+			myCur = myBand;
+		}
+		else
+		{
+			myBand = myCur = myBandEnd;
+			if ( myBand == myEnd )
+			{
+				mySpan = coverage_span{ 0, 0, 0 };
+				return *this;
+			}
+			myBandEnd = __priv::region_band_end( myBand, myEnd );
+			mySpan.y = myBand->bottom();
+		}
+	}
+	load();
+	return *this;
+}
+
+
+////////////////////////////////////////
+
+
+region_spans::region_spans( const region_list &l, const region &clip )
+		: myClip( clip )
+{
+	check_finite( clip );
+	if ( clip.empty() )
+		return;
+
+	myBands.reserve( l.size() );
+	for ( region r: l )
+	{
+		r.intersect( clip );
+		if ( ! r.empty() )
+			myBands.push_back( r );
+	}
+	canonicalize( myBands );
+}
+
+
+////////////////////////////////////////
+
+
+coverage_mask::coverage_mask( const region &bounds )
+		: myBounds( bounds )
+{
+	check_finite( bounds );
+	if ( bounds.empty() )
+		return;
+
+	myStride = ( ( size_t( width() ) + 127 ) / 128 ) * 2;
+	myBits.assign( myStride * size_t( height() ), 0 );
+}
+
+
+////////////////////////////////////////
+
+
+coverage_mask::coverage_mask( const region_list &l, const region &bounds )
+		: coverage_mask( bounds )
+{
+	region_spans( l, bounds ).for_each( [this]( int y, int x0, int x1 ) { fill_span( y, x0, x1 ); } );
+}
+
+
+////////////////////////////////////////
+
+
+bool
+coverage_mask::test( int x, int y ) const
+{
+	if ( ! myBounds.contains( x, y ) )
+		return false;
+	size_t bit = size_t( x - myBounds.left() );
+	return ( row( y )[bit / 64] >> ( bit % 64 ) ) & 1;
+}
+
+
+////////////////////////////////////////
+
+
+void
+coverage_mask::set( int x, int y )
+{
+	if ( myBounds.contains( x, y ) )
+	{
+		size_t bit = size_t( x - myBounds.left() );
+		row( y )[bit / 64] |= uint64_t(1) << ( bit % 64 );
+	}
+}
+
+
+////////////////////////////////////////
+
+
+void
+coverage_mask::fill_span( int y, int x0, int x1 )
+{
+	if ( ! myBounds.contains_y( y ) )
+		return;
+	x0 = std::max( x0, myBounds.left() ) - myBounds.left();
+	x1 = std::min( int64_t( x1 ), int64_t( myBounds.right() ) + 1 ) - myBounds.left();
+	if ( x1 <= x0 )
+		return;
+
+	uint64_t *r = row( y );
+	size_t w0 = size_t( x0 ) / 64, w1 = size_t( x1 - 1 ) / 64;
+	uint64_t m0 = ~uint64_t(0) << ( x0 % 64 );
+	uint64_t m1 = low_bits( ( ( x1 - 1 ) % 64 ) + 1 );
+	if ( w0 == w1 )
+	{
+		r[w0] |= m0 & m1;
+		return;
+	}
+	r[w0] |= m0;
+	std::fill( r + w0 + 1, r + w1, ~uint64_t(0) );
+	r[w1] |= m1;
+}
+
+
+////////////////////////////////////////
+
+
+void
+coverage_mask::clear( void )
+{
+	std::fill( myBits.begin(), myBits.end(), uint64_t(0) );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+coverage_mask::count( void ) const
+{
+	size_t retval = 0;
+	for ( uint64_t w: myBits )
+		retval += static_cast<size_t>( __builtin_popcountll( w ) );
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+region_list
+coverage_mask::to_list( void ) const
+{
+	region_list retval;
+	if ( myBounds.empty() )
+		return retval;
+
+	band_builder bands( retval );
+	std::vector<run> runs;
+	for ( int y = myBounds.bottom(); ; ++y )
+	{
+		runs.clear();
+		row_runs( row( y ), myStride, myBounds.left(), width(), runs );
+		bands.add_row( y, runs.data(), runs.data() + runs.size() );
+		if ( y == myBounds.top() )
+			break;
+	}
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+void
+coverage_rle::start( const region &bounds )
+{
+	check_finite( bounds );
+	myBounds = bounds;
+	myRows.clear();
+	myRuns.clear();
+	myRows.reserve( size_t( bounds.empty() ? 0 : bounds.size_y() ) + 1 );
+	myRows.push_back( 0 );
+}
+
+
+////////////////////////////////////////
+
+
+coverage_rle::coverage_rle( const region_list &l, const region &clip )
+{
+	start( clip );
+	if ( clip.empty() )
+		return;
+
+	int nexty = clip.bottom();
+	region_spans( l, clip ).for_each( [&]( int y, int x0, int x1 )
+	{
+		for ( ; nexty <= y; ++nexty )
+			myRows.push_back( static_cast<uint32_t>( myRuns.size() ) );
+		myRuns.push_back( run{ x0, x1 } );
+		// close row y now, later spans on it bump the offset
+		myRows.back() = static_cast<uint32_t>( myRuns.size() );
+	} );
+	while ( myRows.size() < size_t( clip.size_y() ) + 1 )
+		myRows.push_back( static_cast<uint32_t>( myRuns.size() ) );
+}
+
+
+////////////////////////////////////////
+
+
+coverage_rle::coverage_rle( const coverage_mask &m )
+{
+	start( m.bounds() );
+	if ( m.bounds().empty() )
+		return;
+
+	for ( int y = myBounds.bottom(); ; ++y )
+	{
+		row_runs( m.row( y ), m.words_per_row(), myBounds.left(), m.width(), myRuns );
+		myRows.push_back( static_cast<uint32_t>( myRuns.size() ) );
+		if ( y == myBounds.top() )
+			break;
+	}
+}
+
+
+////////////////////////////////////////
+
+
+region_list
+coverage_rle::to_list( void ) const
+{
+	region_list retval;
+	if ( myBounds.empty() )
+		return retval;
+
+	band_builder bands( retval );
+	for ( int y = myBounds.bottom(); ; ++y )
+	{
+		bands.add_row( y, row_begin( y ), row_end( y ) );
+		if ( y == myBounds.top() )
+			break;
+	}
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+coverage_mask
+coverage_rle::to_mask( void ) const
+{
+	coverage_mask retval( myBounds );
+	if ( myBounds.empty() )
+		return retval;
+
+	for ( int y = myBounds.bottom(); ; ++y )
+	{
+		for ( const run *r = row_begin( y ), *e = row_end( y ); r != e; ++r )
+			retval.fill_span( y, r->x0, r->x1 );
+		if ( y == myBounds.top() )
+			break;
+	}
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
@@ -0,0 +1,385 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_soa.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define YACO_REGION_SSE2 1
+#endif
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+# include <immintrin.h>
+# define YACO_REGION_AVX2 1
+#endif
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+typedef region::value_type value_type;
+
+// All the queries reduce to "entry i fails if any of 4 comparisons
+// a > b is true", where each comparison has an entry coordinate on
+// one side and a query coordinate on the other. The flag is true
+// when the entry coordinate is on the left hand side.
+//
+//   intersects: L > qR | qL > R | B > qT | qB > T
+//   inside:     qL > L | R > qR | qB > B | T > qT
+//   contains:   L > qL | qR > R | B > qB | qT > T
+struct query
+{
+	value_type q[4]; // compared against L, R, B, T respectively
+	bool entryLeft[4];
+};
+
+query
+make_intersects( const region &r )
+{
+	return query{ { r.right(), r.left(), r.top(), r.bottom() }, { true, false, true, false } };
+}
+
+query
+make_inside( const region &r )
+{
+	return query{ { r.left(), r.right(), r.bottom(), r.top() }, { false, true, false, true } };
+}
+
+query
+make_contains( const region &r )
+{
+	return query{ { r.left(), r.right(), r.bottom(), r.top() }, { true, false, true, false } };
+}
+
+inline bool
+scalar_fail( value_type v, value_type q, bool entryLeft )
+{
+	return entryLeft ? ( v > q ) : ( q > v );
+}
+
+/// fills in the mask words covering entries [start, n)
+void
+scalar_kernel( const value_type *const arrays[4], size_t start, size_t n,
+			   const query &q, uint64_t *mask )
+{
+	for ( size_t i = start; i < n; ++i )
+	{
+		bool fail = false;
+		for ( int c = 0; c < 4; ++c )
+			fail |= scalar_fail( arrays[c][i], q.q[c], q.entryLeft[c] );
+		if ( ! fail )
+			mask[i / 64] |= uint64_t(1) << ( i % 64 );
+	}
+}
+
+#ifdef YACO_REGION_SSE2
+size_t
+sse2_kernel( const value_type *const arrays[4], size_t n,
+			 const query &q, uint64_t *mask )
+{
+	__m128i qv[4];
+	for ( int c = 0; c < 4; ++c )
+		qv[c] = _mm_set1_epi32( q.q[c] );
+
+	size_t i = 0;
+	for ( ; ( i + 4 ) <= n; i += 4 )
+	{
+		__m128i fail = _mm_setzero_si128();
+		for ( int c = 0; c < 4; ++c )
+		{
+			__m128i v = _mm_load_si128( reinterpret_cast<const __m128i *>( arrays[c] + i ) );
+			fail = _mm_or_si128( fail, q.entryLeft[c] ? _mm_cmpgt_epi32( v, qv[c] ) : _mm_cmpgt_epi32( qv[c], v ) );
+		}
+		uint64_t bits = static_cast<uint64_t>( ~_mm_movemask_ps( _mm_castsi128_ps( fail ) ) & 0xF );
+		mask[i / 64] |= bits << ( i % 64 );
+	}
+	return i;
+}
+#endif
+
+#ifdef YACO_REGION_AVX2
+__attribute__((target("avx2"))) size_t
+avx2_kernel( const value_type *const arrays[4], size_t n,
+			 const query &q, uint64_t *mask )
+{
+	__m256i qv[4];
+	for ( int c = 0; c < 4; ++c )
+		qv[c] = _mm256_set1_epi32( q.q[c] );
+
+	size_t i = 0;
+	for ( ; ( i + 8 ) <= n; i += 8 )
+	{
+		__m256i fail = _mm256_setzero_si256();
+		for ( int c = 0; c < 4; ++c )
+		{
+			__m256i v = _mm256_load_si256( reinterpret_cast<const __m256i *>( arrays[c] + i ) );
+			fail = _mm256_or_si256( fail, q.entryLeft[c] ? _mm256_cmpgt_epi32( v, qv[c] ) : _mm256_cmpgt_epi32( qv[c], v ) );
+		}
+		uint64_t bits = static_cast<uint64_t>( ~_mm256_movemask_ps( _mm256_castsi256_ps( fail ) ) & 0xFF );
+		mask[i / 64] |= bits << ( i % 64 );
+	}
+	return i;
+}
+
+bool
+have_avx2( void )
+{
+	static const bool theAVX2 = __builtin_cpu_supports( "avx2" );
+	return theAVX2;
+}
+#endif
+
+size_t
+popcount( const std::vector<uint64_t> &mask )
+{
+	size_t r = 0;
+	for ( uint64_t w: mask )
+	{
+		while ( w )
+		{
+			w &= w - 1;
+			++r;
+		}
+	}
+	return r;
+}
+
+size_t
+run_mask( const region_soa &s, const query &q, std::vector<uint64_t> &mask )
+{
+	const size_t n = s.size();
+	const value_type *const arrays[4] = { s.left(), s.right(), s.bottom(), s.top() };
+
+	mask.assign( ( n + 63 ) / 64, 0 );
+	size_t done = 0;
+#ifdef YACO_REGION_AVX2
+	if ( have_avx2() )
+		done = avx2_kernel( arrays, n, q, mask.data() );
+	else
+#endif
+	{
+#ifdef YACO_REGION_SSE2
+		done = sse2_kernel( arrays, n, q, mask.data() );
+#endif
+	}
+	scalar_kernel( arrays, done, n, q, mask.data() );
+	return popcount( mask );
+}
+
+size_t
+run_indices( const region_soa &s, const query &q, std::vector<uint32_t> &indices )
+{
+	static thread_local std::vector<uint64_t> mask;
+	run_mask( s, q, mask );
+
+	indices.clear();
+	for ( size_t w = 0; w != mask.size(); ++w )
+	{
+		uint64_t bits = mask[w];
+		while ( bits )
+		{
+			indices.push_back( static_cast<uint32_t>( w * 64 + static_cast<size_t>( __builtin_ctzll( bits ) ) ) );
+			bits &= bits - 1;
+		}
+	}
+	return indices.size();
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+region_soa::region_soa( const region_list &l )
+{
+	assign( l );
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_soa::reserve( size_t n )
+{
+	myL.reserve( n );
+	myR.reserve( n );
+	myB.reserve( n );
+	myT.reserve( n );
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_soa::clear( void )
+{
+	myL.clear();
+	myR.clear();
+	myB.clear();
+	myT.clear();
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_soa::push_back( const region &r )
+{
+	myL.push_back( r.left() );
+	myR.push_back( r.right() );
+	myB.push_back( r.bottom() );
+	myT.push_back( r.top() );
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_soa::assign( const region_list &l )
+{
+	clear();
+	reserve( l.size() );
+	for ( const region &r: l )
+		push_back( r );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::intersects( const region &q, std::vector<uint64_t> &mask ) const
+{
+	return run_mask( *this, make_intersects( q ), mask );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::intersects( const region &q, std::vector<uint32_t> &indices ) const
+{
+	return run_indices( *this, make_intersects( q ), indices );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::inside( const region &q, std::vector<uint64_t> &mask ) const
+{
+	return run_mask( *this, make_inside( q ), mask );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::inside( const region &q, std::vector<uint32_t> &indices ) const
+{
+	return run_indices( *this, make_inside( q ), indices );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::contains( const region &q, std::vector<uint64_t> &mask ) const
+{
+	return run_mask( *this, make_contains( q ), mask );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::contains( const region &q, std::vector<uint32_t> &indices ) const
+{
+	return run_indices( *this, make_contains( q ), indices );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::contains( value_type x, value_type y, std::vector<uint64_t> &mask ) const
+{
+	return run_mask( *this, make_contains( region( x, x, y, y ) ), mask );
+}
+
+
+////////////////////////////////////////
+
+
+size_t
+region_soa::contains( value_type x, value_type y, std::vector<uint32_t> &indices ) const
+{
+	return run_indices( *this, make_contains( region( x, x, y, y ) ), indices );
+}
+
+
+////////////////////////////////////////
+
+
+const char *
+region_soa::kernel_name( void )
+{
+#ifdef YACO_REGION_AVX2
+	if ( have_avx2() )
+		return "avx2";
+#endif
+#ifdef YACO_REGION_SSE2
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
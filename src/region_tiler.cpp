@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_tiler.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+
+/// floor( v / d ) for d > 0
+inline int
+floor_div( int v, int d )
+{
+	return v >= 0 ? v / d : -( ( -( v + 1 ) ) / d ) - 1;
+}
+
+struct piece
+{
+	int tx, ty;
+	region r;
+};
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+region_tiler::region_tiler( const region_list &l, const region &clip, int tile_w, int tile_h )
+		: myClip( clip ), myTileW( tile_w ), myTileH( tile_h )
+{
+	if ( tile_w <= 0 || tile_h <= 0 )
+		throw std::invalid_argument( "tile size must be positive" );
+	if ( clip.empty() )
+		return;
+	if ( clip.infinite() )
+		throw std::invalid_argument( "tiling window must be finite" );
+
+	region_list banded;
+	banded.reserve( l.size() );
+	for ( region r: l )
+	{
+		r.intersect( clip );
+		if ( ! r.empty() )
+			banded.push_back( r );
+	}
+	canonicalize( banded );
+
+	// cut every rect at the tile boundaries, the pieces of a tile
+	// come out in band order, which the stable sort preserves
+	std::vector<piece> pieces;
+	pieces.reserve( banded.size() );
+	for ( const region &r: banded )
+	{
+		int ty0 = floor_div( r.bottom(), tile_h ), ty1 = floor_div( r.top(), tile_h );
+		int tx0 = floor_div( r.left(), tile_w ), tx1 = floor_div( r.right(), tile_w );
+		for ( int ty = ty0; ty <= ty1; ++ty )
+		{
+			int64_t yb = std::max( int64_t( r.bottom() ), int64_t( ty ) * tile_h );
+			int64_t yt = std::min( int64_t( r.top() ), int64_t( ty + 1 ) * tile_h - 1 );
+			for ( int tx = tx0; tx <= tx1; ++tx )
+			{
+				int64_t xl = std::max( int64_t( r.left() ), int64_t( tx ) * tile_w );
+				int64_t xr = std::min( int64_t( r.right() ), int64_t( tx + 1 ) * tile_w - 1 );
+				pieces.push_back( piece{ tx, ty, region( int( xl ), int( xr ), int( yb ), int( yt ) ) } );
+			}
+		}
+	}
+	std::stable_sort( pieces.begin(), pieces.end(),
+					  []( const piece &a, const piece &b )
+					  {
+						  return a.ty < b.ty || ( a.ty == b.ty && a.tx < b.tx );
+					  } );
+
+	myRects.reserve( pieces.size() );
+	for ( size_t i = 0; i != pieces.size(); )
+	{
+		region_tile t;
+		t.tx = pieces[i].tx;
+		t.ty = pieces[i].ty;
+		t.bounds = region( int( std::max( int64_t( clip.left() ), int64_t( t.tx ) * tile_w ) ),
+						   int( std::min( int64_t( clip.right() ), int64_t( t.tx + 1 ) * tile_w - 1 ) ),
+						   int( std::max( int64_t( clip.bottom() ), int64_t( t.ty ) * tile_h ) ),
+						   int( std::min( int64_t( clip.top() ), int64_t( t.ty + 1 ) * tile_h - 1 ) ) );
+		t.covered = 0;
+		t.first = myRects.size();
+		for ( ; i != pieces.size() && pieces[i].tx == t.tx && pieces[i].ty == t.ty; ++i )
+		{
+			const region &r = pieces[i].r;
+			t.covered += uint64_t( r.size_x() ) * uint64_t( r.size_y() );
+			myRects.push_back( r );
+		}
+		t.last = myRects.size();
+		myTiles.push_back( t );
+	}
+}
+
+
+////////////////////////////////////////
+
+
+uint64_t
+region_tiler::covered( void ) const
+{
+	uint64_t retval = 0;
+	for ( const region_tile &t: myTiles )
+		retval += t.covered;
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+void
+region_tiler::run( size_t ntiles, size_t nthreads, const std::function<void ( size_t )> &work )
+{
+	if ( nthreads == 0 )
+		nthreads = std::max( 1U, std::thread::hardware_concurrency() );
+	nthreads = std::min( nthreads, ntiles );
+	if ( nthreads <= 1 )
+	{
+		for ( size_t i = 0; i != ntiles; ++i )
+			work( i );
+		return;
+	}
+
+	std::atomic<size_t> next( 0 );
+	std::atomic<bool> failed( false );
+	std::vector<std::exception_ptr> errors( nthreads );
+	auto worker = [&]( size_t w )
+	{
+		try
+		{
+			while ( ! failed.load( std::memory_order_relaxed ) )
+			{
+				size_t i = next.fetch_add( 1, std::memory_order_relaxed );
+				if ( i >= ntiles )
+					break;
+				work( i );
+			}
+		}
+		catch ( ... )
+		{
+			errors[w] = std::current_exception();
+			failed.store( true, std::memory_order_relaxed );
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve( nthreads - 1 );
+	for ( size_t w = 1; w < nthreads; ++w )
+		threads.emplace_back( worker, w );
+	worker( 0 );
+	for ( auto &t: threads )
+		t.join();
+
+	for ( auto &e: errors )
+	{
+		if ( e )
+			std::rethrow_exception( e );
+	}
+}
+
+
+////////////////////////////////////////
+
+
+} // math
+} // yaco
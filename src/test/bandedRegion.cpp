@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/banded_region.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+region_list
+random_list( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( 0, 40 );
+	std::uniform_int_distribution<int> sz( 1, 12 );
+	region_list retval;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testBasics( void )
+{
+	banded_region e;
+	if ( ! e.empty() || e.contains( 0, 0 ) || banded_region( region() ).size() != 0 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	banded_region plus{ region( 10, 19, 0, 29 ), region( 0, 29, 10, 19 ) };
+	if ( plus.size() != 3 || plus.band_count() != 3 )
+		throw std::runtime_error( "plus sign not split into 3 bands" );
+	if ( plus.bounds() != region( 0, 29, 0, 29 ) )
+		throw std::runtime_error( "bad bounds" );
+	if ( ! plus.contains( 15, 5 ) || ! plus.contains( 0, 10 ) || ! plus.contains( 29, 19 ) ||
+		 plus.contains( 5, 5 ) || plus.contains( 25, 25 ) || plus.contains( 15, 30 ) )
+		throw std::runtime_error( "bad point containment" );
+
+	banded_region hole = region( 0, 99, 0, 99 );
+	hole.subtract( region( 25, 74, 25, 74 ) );
+	if ( hole.size() != 4 || hole.contains( 50, 50 ) || ! hole.contains( 10, 50 ) )
+		throw std::runtime_error( "bad subtract" );
+
+	hole |= region( 25, 74, 25, 74 );
+	if ( hole != banded_region( region( 0, 99, 0, 99 ) ) )
+		throw std::runtime_error( "bad union" );
+
+	banded_region n = ~banded_region( region( 0, 9, 0, 9 ) );
+	if ( n.contains( 5, 5 ) || ! n.contains( -100000, 5 ) || ! n.contains( 5, 100000 ) )
+		throw std::runtime_error( "bad complement" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testAgainstList( void )
+{
+	std::mt19937 gen( 1234 );
+	for ( int i = 0; i < 500; ++i )
+	{
+		region_list la = random_list( gen, 1 + ( i % 17 ) );
+		region_list lb = random_list( gen, 1 + ( i % 13 ) );
+		banded_region a( la ), b( lb );
+
+		// the list operators produce canonical output too, so
+		// the results have to match exactly
+		if ( ( a & b ).rects() != ( la & lb ) ||
+			 ( a | b ).rects() != ( la | lb ) ||
+			 ( a ^ b ).rects() != ( la ^ lb ) ||
+			 not_in( a, b ).rects() != not_in( la, lb ) )
+		{
+			std::cout << "a: " << la << "\nb: " << lb << std::endl;
+			throw std::runtime_error( __PRETTY_FUNCTION__ );
+		}
+
+		banded_region c = a;
+		c ^= b;
+		c ^= b;
+		if ( c != a )
+			throw std::runtime_error( "xor is not its own inverse" );
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testBasics();
+		retval += testAgainstList();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,337 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/matrix.h>
+#include <math/vector_soa.h>
+#include <math/dense_matrix.h>
+#include <math/graphics.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+/// textbook versions, on row major arrays
+template <typename T>
+struct naive4
+{
+	T v[4][4];
+
+	static void multiply( const naive4 &a, const naive4 &b, naive4 &out )
+	{
+		for ( int r = 0; r < 4; ++r )
+			for ( int c = 0; c < 4; ++c )
+			{
+				T s = 0;
+				for ( int k = 0; k < 4; ++k )
+					s += a.v[r][k] * b.v[k][c];
+				out.v[r][c] = s;
+			}
+	}
+
+	static void transform( const naive4 &m, const T *in, T *out )
+	{
+		for ( int r = 0; r < 4; ++r )
+		{
+			T s = 0;
+			for ( int k = 0; k < 4; ++k )
+				s += m.v[r][k] * in[k];
+			out[r] = s;
+		}
+	}
+
+	/// Gauss-Jordan
+	static T inverse( const naive4 &m, naive4 &out )
+	{
+		naive4 a = m;
+		for ( int r = 0; r < 4; ++r )
+			for ( int c = 0; c < 4; ++c )
+				out.v[r][c] = r == c ? 1 : 0;
+		T det = 1;
+		for ( int k = 0; k < 4; ++k )
+		{
+			int p = k;
+			for ( int r = k + 1; r < 4; ++r )
+				if ( std::abs( a.v[r][k] ) > std::abs( a.v[p][k] ) )
+					p = r;
+			if ( p != k )
+			{
+				std::swap( a.v[p], a.v[k] );
+				std::swap( out.v[p], out.v[k] );
+				det = -det;
+			}
+			T piv = a.v[k][k];
+			det *= piv;
+			for ( int c = 0; c < 4; ++c )
+			{
+				a.v[k][c] /= piv;
+				out.v[k][c] /= piv;
+			}
+			for ( int r = 0; r < 4; ++r )
+			{
+				if ( r == k )
+					continue;
+				T f = a.v[r][k];
+				for ( int c = 0; c < 4; ++c )
+				{
+					a.v[r][c] -= f * a.v[k][c];
+					out.v[r][c] -= f * out.v[k][c];
+				}
+			}
+		}
+		return det;
+	}
+};
+
+void
+time_op( const char *type, const char *name, size_t n, const std::function<double (void)> &op )
+{
+	typedef std::chrono::steady_clock clock;
+
+	clock::time_point start = clock::now();
+	double check = op();
+	double ns = std::chrono::duration<double, std::nano>( clock::now() - start ).count() / double(n);
+
+	std::cout << std::left << std::setw( 8 ) << type
+			  << std::setw( 20 ) << name << std::right
+			  << std::setw( 14 ) << std::fixed << std::setprecision( 2 ) << ns
+			  << std::setw( 16 ) << std::setprecision( 3 ) << check << std::endl;
+}
+
+template <typename T>
+void
+bench( const char *type, size_t n )
+{
+	typedef square_matrix<T, 4> mat;
+	typedef vector<T, 4> vec;
+	std::mt19937 gen( 42 );
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+
+	std::vector<mat> ms( n );
+	std::vector<naive4<T>> ns( n );
+	std::vector<vec> vs( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		for ( size_t r = 0; r != 4; ++r )
+		{
+			for ( size_t c = 0; c != 4; ++c )
+				ms[i]( r, c ) = ns[i].v[r][c] = static_cast<T>( val( gen ) + ( r == c ? 3.0 : 0.0 ) );
+			vs[i][r] = static_cast<T>( val( gen ) );
+		}
+	}
+
+	// the check column sums a result so the work can't be skipped,
+	// and the naive and kernel rows should agree
+	time_op( type, "naive multiply", n, [&]() {
+			double s = 0; naive4<T> out;
+			for ( size_t i = 1; i != n; ++i ) { naive4<T>::multiply( ns[i - 1], ns[i], out ); s += out.v[1][2]; }
+			return s; } );
+	time_op( type, "multiply", n, [&]() {
+			double s = 0;
+			for ( size_t i = 1; i != n; ++i ) s += ( ms[i - 1] * ms[i] )( 1, 2 );
+			return s; } );
+
+	time_op( type, "naive transform", n, [&]() {
+			double s = 0; T out[4];
+			for ( size_t i = 0; i != n; ++i ) { naive4<T>::transform( ns[i], vs[i].data(), out ); s += out[2]; }
+			return s; } );
+	time_op( type, "transform", n, [&]() {
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += ( ms[i] * vs[i] )[2];
+			return s; } );
+
+	time_op( type, "naive inverse", n, [&]() {
+			double s = 0; naive4<T> out;
+			for ( size_t i = 0; i != n; ++i ) s += naive4<T>::inverse( ns[i], out ) + out.v[3][2];
+			return s; } );
+	time_op( type, "inverse", n, [&]() {
+			double s = 0; mat out;
+			for ( size_t i = 0; i != n; ++i ) { ms[i].invert( out ); s += ms[i].determinant() + out( 3, 2 ); }
+			return s; } );
+
+	time_op( type, "transpose", n, [&]() {
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += ms[i].transposed()( 0, 3 );
+			return s; } );
+}
+
+template <typename T>
+void
+bench_batch( const char *type, size_t n )
+{
+	typedef square_matrix<T, 4> mat;
+	std::mt19937 gen( 42 );
+	std::uniform_real_distribution<double> val( -100.0, 100.0 );
+
+	vector_soa<T, 3> in, out;
+	std::vector<vector<T, 3>> pts( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		for ( size_t c = 0; c != 3; ++c )
+			pts[i][c] = static_cast<T>( val( gen ) );
+		in.push_back( pts[i] );
+	}
+	mat m{
+		T( 1.5 ), T( 0 ), T( 0.2 ), T( 1 ),
+		T( 0 ), T( 2 ), T( 0 ), T( -3 ),
+		T( 0.1 ), T( 0 ), T( -1.002 ), T( -0.2 ),
+		T( 0 ), T( 0 ), T( -1 ), T( 400 ) };
+
+	time_op( type, "transform_point", n, [&]() {
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += transform_point( m, pts[i] )[1];
+			return s; } );
+	time_op( type, "transform_points/1", n, [&]() {
+			transform_points( m, in, out, 1 );
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += out.component( 1 )[i];
+			return s; } );
+	time_op( type, "transform_points", n, [&]() {
+			transform_points( m, in, out );
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += out.component( 1 )[i];
+			return s; } );
+	time_op( type, "bounding_box", n, [&]() {
+			auto b = bounding_box( in );
+			return double( b.second[0] - b.first[0] ); } );
+}
+
+template <typename T>
+void
+bench_cull( const char *type, size_t n )
+{
+	std::mt19937 gen( 42 );
+	std::uniform_real_distribution<double> pos( -200.0, 200.0 );
+	std::uniform_real_distribution<double> size( 0.0, 10.0 );
+
+	aabb_soa<T> boxes;
+	std::vector<aabb<T>> list( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		point<T> lo( T( pos( gen ) ), T( pos( gen ) ), T( pos( gen ) ) );
+		point<T> hi( lo[0] + T( size( gen ) ), lo[1] + T( size( gen ) ), lo[2] + T( size( gen ) ) );
+		list[i] = aabb<T>( lo, hi );
+		boxes.push_back( list[i] );
+	}
+	frustum<T> f( square_matrix<T, 4>{
+			T( 1 ), T( 0 ), T( 0 ), T( 0 ),
+			T( 0 ), T( 1 ), T( 0 ), T( 0 ),
+			T( 0 ), T( 0 ), T( -1.02 ), T( -2.02 ),
+			T( 0 ), T( 0 ), T( -1 ), T( 0 ) } );
+
+	std::vector<uint64_t> mask;
+	time_op( type, "frustum::visible", n, [&]() {
+			double s = 0;
+			for ( size_t i = 0; i != n; ++i ) s += f.visible( list[i] ) ? 1 : 0;
+			return s; } );
+	time_op( type, "cull/1", n, [&]() {
+			return double( cull( f, boxes, mask, 1 ) ); } );
+	time_op( type, "cull", n, [&]() {
+			return double( cull( f, boxes, mask ) ); } );
+}
+
+template <typename T>
+void
+bench_dense( const char *type, size_t n )
+{
+	std::mt19937 gen( 42 );
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	dense_matrix<T> a( n, n ), b( n, n ), c;
+	for ( size_t i = 0; i != n * n; ++i )
+	{
+		a.data()[i] = static_cast<T>( val( gen ) );
+		b.data()[i] = static_cast<T>( val( gen ) );
+	}
+	std::vector<T> x( n, T( 1 ) ), y;
+
+	// per multiply-add of the product
+	const size_t work = n * n * n;
+	time_op( type, "naive gemm", work, [&]() {
+			dense_matrix<T> r( n, n );
+			for ( size_t i = 0; i != n; ++i )
+				for ( size_t j = 0; j != n; ++j )
+				{
+					T s = 0;
+					for ( size_t k = 0; k != n; ++k )
+						s += a( i, k ) * b( k, j );
+					r( i, j ) = s;
+				}
+			return double( r( 1, 2 ) ); } );
+	time_op( type, "gemm/1", work, [&]() {
+			gemm( mat_op::none, mat_op::none, T( 1 ), a, b, T( 0 ), c, 1 );
+			return double( c( 1, 2 ) ); } );
+	time_op( type, "gemm", work, [&]() {
+			gemm( mat_op::none, mat_op::none, T( 1 ), a, b, T( 0 ), c );
+			return double( c( 1, 2 ) ); } );
+	time_op( type, "gemm a' b", work, [&]() {
+			gemm( mat_op::transpose, mat_op::none, T( 1 ), a, b, T( 0 ), c );
+			return double( c( 1, 2 ) ); } );
+	time_op( type, "gemv", n * n, [&]() {
+			gemv( mat_op::none, T( 1 ), a, x, T( 0 ), y );
+			return double( y[2] ); } );
+	time_op( type, "gemv a'", n * n, [&]() {
+			gemv( mat_op::transpose, T( 1 ), a, x, T( 0 ), y );
+			return double( y[2] ); } );
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int argc, char *argv[] )
+{
+	// bench_matrix [count]
+	size_t n = 1000000;
+	if ( argc > 1 )
+		n = static_cast<size_t>( std::atol( argv[1] ) );
+
+	std::cout << std::left << std::setw( 8 ) << "type"
+			  << std::setw( 20 ) << "op" << std::right
+			  << std::setw( 14 ) << "ns / op"
+			  << std::setw( 16 ) << "check" << std::endl;
+
+	bench<float>( "float", n );
+	bench<double>( "double", n );
+	bench_batch<float>( "float", n );
+	bench_batch<double>( "double", n );
+	bench_cull<float>( "float", n );
+	bench_cull<double>( "double", n );
+	bench_dense<float>( "float", 512 );
+	bench_dense<double>( "double", 512 );
+
+	return 0;
+}
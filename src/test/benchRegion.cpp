@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+/// uniformly scattered, with the expected number of overlaps per
+/// region roughly constant as n grows
+region_list
+random_regions( std::mt19937 &gen, size_t n )
+{
+	int extent = static_cast<int>( 200 * std::sqrt( double(n) ) );
+	std::uniform_int_distribution<int> pos( 0, extent - 1 );
+	std::uniform_int_distribution<int> sz( 1, 64 );
+
+	region_list retval;
+	retval.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+/// 32 pixel aligned blocks, 1 to 4 cells on a side, as UI damage
+/// or tiled rendering tends to produce
+region_list
+grid_regions( std::mt19937 &gen, size_t n )
+{
+	int cells = static_cast<int>( 4 * std::sqrt( double(n) ) ) + 1;
+	std::uniform_int_distribution<int> pos( 0, cells - 1 );
+	std::uniform_int_distribution<int> sz( 1, 4 );
+
+	region_list retval;
+	retval.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ) * 32, pos( gen ) * 32, sz( gen ) * 32, sz( gen ) * 32 );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+/// large regions piled into a fixed area, so almost everything
+/// overlaps everything else
+region_list
+overlapping_regions( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( 0, 1023 );
+	std::uniform_int_distribution<int> sz( 256, 1024 );
+
+	region_list retval;
+	retval.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+/// 1 pixel wide slivers, alternating vertical and horizontal, at
+/// odd offsets: the worst case for banding, every sliver end starts
+/// a new band and every crossing splits a span
+region_list
+sliver_regions( std::mt19937 &gen, size_t n )
+{
+	int extent = static_cast<int>( 60 * std::sqrt( double(n) ) ) + 256;
+	std::uniform_int_distribution<int> pos( 0, extent - 1 );
+	std::uniform_int_distribution<int> len( 16, 256 );
+
+	region_list retval;
+	retval.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		if ( i & 1 )
+			r.reset_by_size( pos( gen ), pos( gen ), 1, len( gen ) );
+		else
+			r.reset_by_size( pos( gen ), pos( gen ), len( gen ), 1 );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+struct generator
+{
+	const char *name;
+	region_list (*make)( std::mt19937 &, size_t );
+};
+
+const generator theGenerators[] =
+{
+	{ "random", random_regions },
+	{ "grid", grid_regions },
+	{ "overlap", overlapping_regions },
+	{ "sliver", sliver_regions }
+};
+
+
+////////////////////////////////////////
+
+
+void
+time_op( const char *gen, const char *name, size_t n,
+		 const std::function<region_list (void)> &op )
+{
+	typedef std::chrono::steady_clock clock;
+
+	// repeat small cases so the time is measurable
+	int iters = static_cast<int>( std::max( size_t(1), size_t(10000) / n ) );
+	size_t outsize = 0;
+	clock::time_point start = clock::now();
+	for ( int i = 0; i < iters; ++i )
+		outsize = op().size();
+	double ms = std::chrono::duration<double, std::milli>( clock::now() - start ).count() / double(iters);
+
+	std::cout << std::left << std::setw( 10 ) << gen
+			  << std::setw( 16 ) << name << std::right
+			  << std::setw( 10 ) << n
+			  << std::setw( 14 ) << std::fixed << std::setprecision( 3 ) << ms
+			  << std::setw( 12 ) << outsize << std::endl;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int argc, char *argv[] )
+{
+	// bench_region [max n] [generator]
+	size_t maxN = 10000;
+	if ( argc > 1 )
+		maxN = static_cast<size_t>( std::atol( argv[1] ) );
+	std::string only;
+	if ( argc > 2 )
+		only = argv[2];
+
+	std::cout << std::left << std::setw( 10 ) << "input"
+			  << std::setw( 16 ) << "op" << std::right
+			  << std::setw( 10 ) << "n"
+			  << std::setw( 14 ) << "ms / op"
+			  << std::setw( 12 ) << "out size" << std::endl;
+
+	for ( const generator &g: theGenerators )
+	{
+		if ( ! only.empty() && only != g.name )
+			continue;
+
+		for ( size_t n = 10; n <= maxN; n *= 10 )
+		{
+			std::mt19937 gen( 42 );
+			region_list a = g.make( gen, n );
+			region_list b = g.make( gen, n );
+
+			time_op( g.name, "and", n, [&]() { return a & b; } );
+			time_op( g.name, "or", n, [&]() { return a | b; } );
+			time_op( g.name, "xor", n, [&]() { return a ^ b; } );
+			time_op( g.name, "not", n, [&]() { return ~a; } );
+			time_op( g.name, "not_in", n, [&]() { return not_in( a, b ); } );
+			time_op( g.name, "sort_and_merge", n, [&]() { region_list t = a; sort_and_merge( t ); return t; } );
+			time_op( g.name, "par_and", n, [&]() { return parallel_and( a, b ); } );
+			time_op( g.name, "par_or", n, [&]() { return parallel_or( a, b ); } );
+		}
+	}
+
+	return 0;
+}
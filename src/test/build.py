@@ -8,3 +8,24 @@
 Executable( 'unit_str_format', Compile( 'strFormat.cpp' ), YACO )
 Executable( 'unit_arg_parser', Compile( 'argParser.cpp' ), YACO )
 
+Executable( 'unit_mutex_ext', Compile( 'mutexExt.cpp' ), YACO )
+Executable( 'unit_small_vector', Compile( 'smallVector.cpp' ), YACO )
+Executable( 'unit_vector', Compile( 'vector.cpp' ), YACO )
+Executable( 'unit_matrix', Compile( 'matrix.cpp' ), YACO )
+Executable( 'unit_const_matrix', Compile( 'constMatrix.cpp' ), YACO )
+Executable( 'unit_vector_soa', Compile( 'vectorSoa.cpp' ), YACO )
+Executable( 'unit_quaternion', Compile( 'quaternion.cpp' ), YACO )
+Executable( 'unit_dense_matrix', Compile( 'denseMatrix.cpp' ), YACO )
+Executable( 'unit_graphics', Compile( 'graphics.cpp' ), YACO )
+Executable( 'bench_matrix', Compile( 'benchMatrix.cpp' ), YACO )
+Executable( 'unit_lock_profile', Compile( 'lockProfile.cpp' ), YACO )
+Executable( 'unit_region', Compile( 'region.cpp' ), YACO )
+Executable( 'bench_region', Compile( 'benchRegion.cpp' ), YACO )
+Executable( 'unit_banded_region', Compile( 'bandedRegion.cpp' ), YACO )
+Executable( 'unit_region_soa', Compile( 'regionSoa.cpp' ), YACO )
+Executable( 'unit_region_index', Compile( 'regionIndex.cpp' ), YACO )
+Executable( 'unit_damage_accumulator', Compile( 'damageAccumulator.cpp' ), YACO )
+Executable( 'unit_region_raster', Compile( 'regionRaster.cpp' ), YACO )
+Executable( 'unit_region_tiler', Compile( 'regionTiler.cpp' ), YACO )
+Executable( 'unit_region_oracle', Compile( 'regionOracle.cpp' ), YACO )
+Executable( 'unit_region_codec', Compile( 'regionCodec.cpp' ), YACO )
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/matrix.h>
+#include <math/const_matrix.h>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+// everything here is checked by the compiler, main only compares
+// against the run time versions
+
+constexpr const_mat3 theUnimodular = const_mat3::from_rows( 1, 2, 3,
+															  0, 1, 4,
+															  5, 6, 0 );
+constexpr const_mat3 theUnimodularInv = const_mat3::from_rows( -24, 18, 5,
+																 20, -15, -4,
+																 -5, 4, 1 );
+constexpr const_fmat4 theBlock = const_fmat4::from_rows( 2, 0, 0, 1,
+														   0, 1, 0, 0,
+														   0, 0, 4, 0,
+														   1, 0, 0, 1 );
+
+static_assert( theUnimodular( 0, 1 ) == 2 && theUnimodular( 2, 0 ) == 5, "from_rows is row major" );
+static_assert( theUnimodular.v[1] == 0 && theUnimodular.v[2] == 5, "storage is column major" );
+static_assert( transpose( theUnimodular )( 1, 0 ) == 2, "transpose" );
+static_assert( transpose( transpose( theUnimodular ) ) == theUnimodular, "transpose twice" );
+static_assert( const_mat3::identity() * theUnimodular == theUnimodular, "identity" );
+static_assert( theUnimodular * const_mat3::identity() == theUnimodular, "identity" );
+static_assert( ( theUnimodular + theUnimodular ) == theUnimodular * 2.0, "add and scale" );
+static_assert( ( theUnimodular - theUnimodular ) == 0.0 * theUnimodular, "subtract" );
+
+static_assert( determinant( theUnimodular ) == 1, "3x3 determinant" );
+static_assert( determinant( theBlock ) == 4, "4x4 determinant" );
+static_assert( determinant( const_fmat2::from_rows( 3, 1, 4, 2 ) ) == 2, "2x2 determinant" );
+static_assert( inverse( theUnimodular ) == theUnimodularInv, "3x3 inverse" );
+static_assert( theUnimodular * theUnimodularInv == const_mat3::identity(), "3x3 product" );
+static_assert( inverse( theBlock ) == const_fmat4::from_rows( 1, 0, 0, -1,
+																0, 1, 0, 0,
+																0, 0, 0.25, 0,
+																-1, 0, 0, 2 ), "4x4 inverse" );
+static_assert( inverse( theBlock ) * theBlock == const_fmat4::identity(), "4x4 product" );
+static_assert( inverse( const_fmat2::from_rows( 3, 1, 4, 2 ) ) ==
+			   const_fmat2::from_rows( 1, -0.5, -2, 1.5 ), "2x2 inverse" );
+
+constexpr const_vec3 theX{ { 1, 0, 0 } };
+constexpr const_vec3 theY{ { 0, 1, 0 } };
+
+static_assert( cross( theX, theY ) == const_vec3{ { 0, 0, 1 } }, "cross" );
+static_assert( dot( theX + theY, theX - theY ) == 0, "dot" );
+static_assert( mag_squared( 2.0 * theX - theY ) == 5, "mag_squared" );
+static_assert( -theX / 2.0 == const_vec3{ { -0.5, 0, 0 } }, "negate and divide" );
+static_assert( theUnimodular * theX == const_vec3{ { 1, 0, 5 } }, "matrix times vector" );
+static_assert( theUnimodularInv * ( theUnimodular * theY ) == theY, "round trip" );
+
+// the conversions are constant expressions too, so these are
+// computed entirely at compile time
+constexpr fmat4 theBlockInv = fmat4( inverse( theBlock ) );
+constexpr vec3 theZ = vec3( cross( theX, theY ) );
+
+static_assert( theBlockInv( 0, 3 ) == -1 && theBlockInv( 3, 3 ) == 2, "converted matrix" );
+static_assert( theZ[2] == 1 && theZ[0] == 0, "converted vector" );
+
+// linear rec. 709 to XYZ, the sort of table this is meant for
+constexpr const_fmat3 theToXYZ = const_fmat3::from_rows( 0.4124564f, 0.3575761f, 0.1804375f,
+														   0.2126729f, 0.7151522f, 0.0721750f,
+														   0.0193339f, 0.1191920f, 0.9503041f );
+constexpr fmat3 theFromXYZ = fmat3( inverse( theToXYZ ) );
+
+
+////////////////////////////////////////
+
+
+template <size_t dim>
+bool
+close( const square_matrix<float, dim> &a, const square_matrix<float, dim> &b, float tol )
+{
+	for ( size_t r = 0; r != dim; ++r )
+		for ( size_t c = 0; c != dim; ++c )
+			if ( std::abs( a( r, c ) - b( r, c ) ) > tol )
+				return false;
+	return true;
+}
+
+int
+testConversion( void )
+{
+	fmat4 m = theBlockInv;
+	fmat4 b = fmat4( theBlock );
+	if ( m * b != fmat4::identity() )
+		throw std::runtime_error( "converted matrix product" );
+	if ( ! close( b.inverse(), m, 1e-6f ) )
+		throw std::runtime_error( "compile time inverse does not match run time" );
+
+	vec3 z = theZ;
+	if ( z != vec3{ 0, 0, 1 } )
+		throw std::runtime_error( "converted vector" );
+	return 0;
+}
+
+int
+testColor( void )
+{
+	if ( ! close( fmat3( theToXYZ ).inverse(), theFromXYZ, 1e-5f ) )
+		throw std::runtime_error( "compile time color matrix inverse" );
+
+	// white should map to white
+	fvec3 w = fmat3( theToXYZ ) * ( theFromXYZ * fvec3{ 0.95047f, 1.0f, 1.08883f } );
+	if ( std::abs( w[0] - 0.95047f ) > 1e-5f || std::abs( w[1] - 1.0f ) > 1e-5f ||
+		 std::abs( w[2] - 1.08883f ) > 1e-5f )
+		throw std::runtime_error( "color matrix round trip" );
+	return 0;
+}
+
+int
+testErrors( void )
+{
+	// not a constant expression, so these throw at run time instead
+	// of failing the compile
+	const_mat3 singular = const_mat3::from_rows( 1, 2, 3,
+												 2, 4, 6,
+												 0, 0, 1 );
+	bool threw = false;
+	try
+	{
+		inverse( singular );
+	}
+	catch ( std::runtime_error & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "singular inverse should throw" );
+
+	threw = false;
+	try
+	{
+		theUnimodular.at( 3, 0 );
+	}
+	catch ( std::out_of_range & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "at should check the range" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testConversion();
+		retval += testColor();
+		retval += testErrors();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
+
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/damage_accumulator.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+const int W = 128;
+
+void
+paint( std::vector<int> &pix, const region &r )
+{
+	for ( int y = std::max( 0, r.bottom() ); y <= std::min( W - 1, r.top() ); ++y )
+		for ( int x = std::max( 0, r.left() ); x <= std::min( W - 1, r.right() ); ++x )
+			++pix[y * W + x];
+}
+
+
+////////////////////////////////////////
+
+
+int
+testBasics( void )
+{
+	damage_accumulator d;
+	if ( ! d.empty() || d.size() != 0 )
+		throw std::runtime_error( "new damage_accumulator is not empty" );
+
+	d.add( region( 0, 9, 0, 9 ) );
+	d.add( region( 2, 3, 2, 3 ) );
+	d.add( region( 0, 9, 10, 19 ) );
+	d.add( region( 10, 19, 0, 19 ) );
+	d.add( region() );
+	if ( d.size() != 1 || d.rects()[0] != region( 0, 19, 0, 19 ) )
+		throw std::runtime_error( "damage_accumulator did not join exact neighbors" );
+	if ( d.overdraw_area() != 0.0 || d.area() != 400.0 )
+		throw std::runtime_error( "damage_accumulator area is wrong" );
+	if ( d.bounds() != region( 0, 19, 0, 19 ) )
+		throw std::runtime_error( "damage_accumulator bounds are wrong" );
+
+	region_list l = d.take();
+	if ( l.size() != 1 || ! d.empty() )
+		throw std::runtime_error( "damage_accumulator take did not reset" );
+
+	damage_accumulator lim( 1 );
+	lim.add( region( 0, 0, 0, 0 ) );
+	lim.add( region( 2, 2, 0, 0 ) );
+	if ( lim.size() != 1 || lim.rects()[0] != region( 0, 2, 0, 0 ) || lim.overdraw_area() != 1.0 )
+		throw std::runtime_error( "damage_accumulator did not coalesce to the limit" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testCoverage( void )
+{
+	std::mt19937 gen( 5 );
+	std::uniform_int_distribution<int> pos( -10, W );
+	std::uniform_int_distribution<int> sz( 1, 24 );
+
+	for ( size_t maxr: { 0, 1, 4, 16, 64 } )
+	{
+		for ( int iter = 0; iter < 20; ++iter )
+		{
+			damage_accumulator d( maxr );
+			std::vector<int> added( W * W, 0 );
+			size_t n = size_t( iter ) * 37;
+			for ( size_t i = 0; i != n; ++i )
+			{
+				region r;
+				r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+				d.add( r );
+				paint( added, r );
+			}
+
+			std::vector<int> out( W * W, 0 );
+			double total = 0.0;
+			for ( auto &r: d.rects() )
+			{
+				paint( out, r );
+				total += ( double(r.right()) - r.left() + 1 ) * ( double(r.top()) - r.bottom() + 1 );
+			}
+			if ( total != d.area() )
+				throw std::runtime_error( "damage_accumulator area does not match rects" );
+			if ( maxr > 0 && d.size() > maxr )
+				throw std::runtime_error( "damage_accumulator exceeds its rect limit" );
+			if ( maxr == 0 && d.overdraw_area() != 0.0 )
+				throw std::runtime_error( "unlimited damage_accumulator reports overdraw" );
+
+			size_t extra = 0;
+			for ( size_t p = 0; p != added.size(); ++p )
+			{
+				if ( added[p] && ! out[p] )
+					throw std::runtime_error( "damage_accumulator lost damaged area" );
+				if ( ! added[p] && out[p] )
+				{
+					if ( maxr == 0 )
+						throw std::runtime_error( "damage_accumulator added undamaged area" );
+					++extra;
+				}
+			}
+			if ( double(extra) > d.overdraw_area() )
+				throw std::runtime_error( "damage_accumulator overdraw is not an upper bound" );
+		}
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testBasics();
+		retval += testCoverage();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/dense_matrix.h>
+#include <random>
+#include <limits>
+#include <string>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename T>
+dense_matrix<T>
+randomMatrix( std::mt19937 &gen, size_t rows, size_t cols )
+{
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	dense_matrix<T> r( rows, cols );
+	for ( size_t i = 0; i != rows; ++i )
+		for ( size_t j = 0; j != cols; ++j )
+			r( i, j ) = static_cast<T>( val( gen ) );
+	return r;
+}
+
+template <typename T>
+std::vector<T>
+randomVector( std::mt19937 &gen, size_t n )
+{
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	std::vector<T> r( n );
+	for ( T &v: r )
+		v = static_cast<T>( val( gen ) );
+	return r;
+}
+
+template <typename T>
+T
+element( const dense_matrix<T> &m, mat_op op, size_t i, size_t j )
+{
+	return op == mat_op::none ? m( i, j ) : m( j, i );
+}
+
+/// checks v against a long double sum, allowing the rounding error
+/// of summing abssum in any order
+template <typename T>
+void
+checkClose( T v, long double expect, long double abssum, size_t n, const std::string &what )
+{
+	long double tol = std::numeric_limits<T>::epsilon() * ( 2 * n + 4 ) * abssum + std::numeric_limits<T>::min();
+	if ( std::abs( static_cast<long double>( v ) - expect ) > tol )
+		throw std::runtime_error( what + ": result off by " + std::to_string( double( std::abs( static_cast<long double>( v ) - expect ) ) ) );
+}
+
+template <typename T>
+int
+testGemm( size_t m, size_t n, size_t k, mat_op opa, mat_op opb, T alpha, T beta )
+{
+	std::mt19937 gen( static_cast<unsigned>( m * 7919 + n * 31 + k ) );
+	dense_matrix<T> a = opa == mat_op::none ? randomMatrix<T>( gen, m, k ) : randomMatrix<T>( gen, k, m );
+	dense_matrix<T> b = opb == mat_op::none ? randomMatrix<T>( gen, k, n ) : randomMatrix<T>( gen, n, k );
+	dense_matrix<T> c0 = randomMatrix<T>( gen, m, n );
+	if ( beta == T( 0 ) && m > 0 && n > 0 )
+		c0( 0, 0 ) = std::numeric_limits<T>::quiet_NaN();
+
+	std::string what = "gemm " + std::to_string( m ) + "x" + std::to_string( n ) + "x" + std::to_string( k );
+	dense_matrix<T> c = c0;
+	gemm( opa, opb, alpha, a, b, beta, c, 1 );
+	if ( c.rows() != m || c.cols() != n )
+		throw std::runtime_error( what + ": size" );
+	for ( size_t i = 0; i != m; ++i )
+	{
+		for ( size_t j = 0; j != n; ++j )
+		{
+			long double s = 0, as = 0;
+			for ( size_t p = 0; p != k; ++p )
+			{
+				long double t = static_cast<long double>( element( a, opa, i, p ) ) * element( b, opb, p, j );
+				s += t;
+				as += std::abs( t );
+			}
+			long double expect = s * alpha;
+			as *= std::abs( alpha );
+			if ( beta != T( 0 ) )
+			{
+				expect += static_cast<long double>( beta ) * c0( i, j );
+				as += std::abs( static_cast<long double>( beta ) * c0( i, j ) );
+			}
+			checkClose( c( i, j ), expect, as, k, what );
+		}
+	}
+
+	// threads split the rows, without changing any result
+	for ( size_t nthreads: { 0, 3 } )
+	{
+		dense_matrix<T> ct = c0;
+		gemm( opa, opb, alpha, a, b, beta, ct, nthreads );
+		if ( ct != c )
+			throw std::runtime_error( what + ": threaded result differs" );
+	}
+	return 0;
+}
+
+template <typename T>
+int
+testGemv( size_t m, size_t n, mat_op opa, T alpha, T beta, size_t nthreads )
+{
+	std::mt19937 gen( static_cast<unsigned>( m * 131 + n ) );
+	dense_matrix<T> a = opa == mat_op::none ? randomMatrix<T>( gen, m, n ) : randomMatrix<T>( gen, n, m );
+	std::vector<T> x = randomVector<T>( gen, n ), y0 = randomVector<T>( gen, m );
+
+	std::string what = "gemv " + std::to_string( m ) + "x" + std::to_string( n );
+	std::vector<T> y = y0;
+	gemv( opa, alpha, a, x, beta, y, nthreads );
+	for ( size_t i = 0; i != m; ++i )
+	{
+		long double s = 0, as = 0;
+		for ( size_t j = 0; j != n; ++j )
+		{
+			long double t = static_cast<long double>( element( a, opa, i, j ) ) * x[j];
+			s += t;
+			as += std::abs( t );
+		}
+		long double expect = s * alpha + static_cast<long double>( beta ) * y0[i];
+		as = as * std::abs( alpha ) + std::abs( static_cast<long double>( beta ) * y0[i] );
+		checkClose( y[i], expect, as, n, what );
+	}
+	return 0;
+}
+
+template <typename T>
+int
+testBasics( void )
+{
+	dense_matrix<T> a( 2, 3, { 1, 2, 3, 4, 5, 6 } );
+	dense_matrix<T> b( 3, 2, { 7, 8, 9, 10, 11, 12 } );
+	if ( a * b != dense_matrix<T>( 2, 2, { 58, 64, 139, 154 } ) )
+		throw std::runtime_error( "dense_matrix product" );
+	if ( a.transposed() != dense_matrix<T>( 3, 2, { 1, 4, 2, 5, 3, 6 } ) )
+		throw std::runtime_error( "dense_matrix transpose" );
+	if ( a * std::vector<T>{ 1, 0, -1 } != std::vector<T>{ -2, -2 } )
+		throw std::runtime_error( "dense_matrix vector product" );
+	if ( dense_matrix<T>::identity( 3 ) * b != b || ( a + a ) != a * T( 2 ) || ( a - a ) != dense_matrix<T>( 2, 3 ) )
+		throw std::runtime_error( "dense_matrix arithmetic" );
+	if ( a.at( 1, 2 ) != T( 6 ) || *a.row( 1 ) != T( 4 ) )
+		throw std::runtime_error( "dense_matrix access" );
+
+	int errors = 0;
+	try { a.at( 2, 0 ); } catch ( std::out_of_range & ) { ++errors; }
+	try { dense_matrix<T>( 2, 2, { 1, 2, 3 } ); } catch ( std::invalid_argument & ) { ++errors; }
+	try { a * a; } catch ( std::invalid_argument & ) { ++errors; }
+	try { a += b; } catch ( std::invalid_argument & ) { ++errors; }
+	try { dense_matrix<T> c( 3, 3 ); gemm( mat_op::none, mat_op::none, T( 1 ), a, b, T( 1 ), c ); } catch ( std::invalid_argument & ) { ++errors; }
+	try { dense_matrix<T> c = a; gemm( mat_op::none, mat_op::transpose, T( 1 ), c, a, T( 0 ), c ); } catch ( std::invalid_argument & ) { ++errors; }
+	try { std::vector<T> y; gemv( mat_op::none, T( 1 ), a, std::vector<T>( 2 ), T( 0 ), y ); } catch ( std::invalid_argument & ) { ++errors; }
+	if ( errors != 7 )
+		throw std::runtime_error( "dense_matrix accepted bad arguments" );
+	return 0;
+}
+
+/// the normal equations of a least squares fit of a cubic to noisy
+/// samples, solved here by plain Gaussian elimination
+template <typename T>
+int
+testLeastSquares( void )
+{
+	const size_t samples = 5000;
+	const T coef[4] = { T( 0.5 ), T( -2 ), T( 1.25 ), T( 0.75 ) };
+	std::mt19937 gen( 99 );
+	std::uniform_real_distribution<double> noise( -1e-3, 1e-3 );
+
+	dense_matrix<T> a( samples, 4 );
+	std::vector<T> y( samples );
+	for ( size_t i = 0; i != samples; ++i )
+	{
+		T x = T( -1 ) + T( 2 ) * T( i ) / T( samples - 1 );
+		T p = 1;
+		y[i] = static_cast<T>( noise( gen ) );
+		for ( size_t j = 0; j != 4; ++j, p *= x )
+		{
+			a( i, j ) = p;
+			y[i] += coef[j] * p;
+		}
+	}
+
+	dense_matrix<T> ata;
+	std::vector<T> aty;
+	gemm( mat_op::transpose, mat_op::none, T( 1 ), a, a, T( 0 ), ata );
+	gemv( mat_op::transpose, T( 1 ), a, y, T( 0 ), aty );
+
+	for ( size_t c = 0; c != 4; ++c )
+	{
+		for ( size_t r = c + 1; r != 4; ++r )
+		{
+			T f = ata( r, c ) / ata( c, c );
+			for ( size_t k = c; k != 4; ++k )
+				ata( r, k ) -= f * ata( c, k );
+			aty[r] -= f * aty[c];
+		}
+	}
+	T sol[4];
+	for ( size_t r = 4; r-- > 0; )
+	{
+		T s = aty[r];
+		for ( size_t k = r + 1; k != 4; ++k )
+			s -= ata( r, k ) * sol[k];
+		sol[r] = s / ata( r, r );
+		if ( std::abs( sol[r] - coef[r] ) > T( 1e-2 ) )
+			throw std::runtime_error( "least squares fit" );
+	}
+	return 0;
+}
+
+template <typename T>
+int
+testAll( void )
+{
+	int retval = testBasics<T>();
+	const mat_op ops[2] = { mat_op::none, mat_op::transpose };
+	for ( mat_op opa: ops )
+	{
+		for ( mat_op opb: ops )
+		{
+			retval += testGemm<T>( 1, 1, 1, opa, opb, T( 1 ), T( 0 ) );
+			retval += testGemm<T>( 3, 5, 2, opa, opb, T( 2 ), T( 0.5 ) );
+			retval += testGemm<T>( 37, 61, 129, opa, opb, T( -1 ), T( 1 ) );
+			retval += testGemm<T>( 0, 4, 3, opa, opb, T( 1 ), T( 0 ) );
+			retval += testGemm<T>( 4, 3, 0, opa, opb, T( 1 ), T( 2 ) );
+		}
+	}
+	// across the cache blocks, and split between threads
+	retval += testGemm<T>( 261, 150, 300, mat_op::none, mat_op::none, T( 1 ), T( 0 ) );
+	retval += testGemm<T>( 130, 257, 259, mat_op::transpose, mat_op::transpose, T( 0.5 ), T( -1 ) );
+	retval += testGemm<T>( 5, 1100, 40, mat_op::none, mat_op::transpose, T( 1 ), T( 1 ) );
+
+	for ( mat_op op: ops )
+	{
+		for ( size_t nthreads: { 1, 0, 3 } )
+		{
+			retval += testGemv<T>( 1, 1, op, T( 1 ), T( 0 ), nthreads );
+			retval += testGemv<T>( 7, 13, op, T( 2 ), T( 0.5 ), nthreads );
+			retval += testGemv<T>( 1201, 1999, op, T( -1 ), T( 1 ), nthreads );
+		}
+	}
+	retval += testLeastSquares<T>();
+	return retval;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testAll<float>();
+		retval += testAll<double>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
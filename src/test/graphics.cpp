@@ -0,0 +1,286 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/graphics.h>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+/// fovy of 90 degrees, aspect 1, near 1 and far 100, looking down
+/// -z, in either clip depth convention
+template <typename T>
+matrix4<T>
+projection( bool zeroToOne )
+{
+	if ( zeroToOne )
+	{
+		return matrix4<T>{
+			T( 1 ), T( 0 ), T( 0 ), T( 0 ),
+			T( 0 ), T( 1 ), T( 0 ), T( 0 ),
+			T( 0 ), T( 0 ), T( 100.0 / -99.0 ), T( 100.0 / -99.0 ),
+			T( 0 ), T( 0 ), T( -1 ), T( 0 ) };
+	}
+	return matrix4<T>{
+		T( 1 ), T( 0 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 1 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 0 ), T( -101.0 / 99.0 ), T( -200.0 / 99.0 ),
+		T( 0 ), T( 0 ), T( -1 ), T( 0 ) };
+}
+
+template <typename T>
+int
+testTransforms( void )
+{
+	matrix4<T> m{
+		T( 2 ), T( 0 ), T( 0 ), T( 10 ),
+		T( 0 ), T( 1 ), T( 0 ), T( 20 ),
+		T( 0 ), T( 0 ), T( 1 ), T( 30 ),
+		T( 0 ), T( 0 ), T( 0 ), T( 1 ) };
+
+	if ( transform( m, point<T>( 1, 1, 1 ) ) != point<T>( 12, 21, 31 ) )
+		throw std::runtime_error( "point transform" );
+	if ( transform( m, vector3<T>{ 1, 1, 1 } ) != vector3<T>{ 2, 1, 1 } )
+		throw std::runtime_error( "vector transform" );
+
+	// stretching x tilts a 45 degree normal towards y
+	normal<T> n = transform( m, normal<T>( 1, 1, 0 ) );
+	T l = std::sqrt( T( 1.25 ) );
+	if ( std::abs( n[0] - T( 0.5 ) / l ) > T( 1e-6 ) || std::abs( n[1] - T( 1 ) / l ) > T( 1e-6 ) || n[2] != T( 0 ) )
+		throw std::runtime_error( "normal transform" );
+
+	point2<T> p( 1, 2 );
+	p = p + vector<T, 2>{ 1, 1 };
+	if ( p != point2<T>( 2, 3 ) )
+		throw std::runtime_error( "point2 arithmetic" );
+	return 0;
+}
+
+template <typename T>
+int
+testPlane( void )
+{
+	plane<T> p = plane<T>::through( point<T>( 0, 0, 5 ), point<T>( 1, 0, 5 ), point<T>( 0, 1, 5 ) );
+	if ( p.n() != vector3<T>{ 0, 0, 1 } || p.d() != T( -5 ) )
+		throw std::runtime_error( "plane through 3 points" );
+	if ( p.distance( point<T>( 3, 4, 7 ) ) != T( 2 ) || p.flipped().distance( point<T>( 3, 4, 7 ) ) != T( -2 ) )
+		throw std::runtime_error( "plane distance" );
+
+	plane<T> q( vector3<T>{ 0, 3, 4 }, T( 10 ) );
+	q.normalize();
+	if ( std::abs( q.distance( point<T>( 0, 0, 0 ) ) - T( 2 ) ) > T( 1e-6 ) )
+		throw std::runtime_error( "normalized plane distance" );
+	return 0;
+}
+
+template <typename T>
+int
+testBoxes( void )
+{
+	aabb<T> b;
+	if ( ! b.empty() || b.contains( point<T>( 0, 0, 0 ) ) )
+		throw std::runtime_error( "default box should be empty" );
+	b.extend( point<T>( 1, 2, 3 ) );
+	b.extend( point<T>( -1, 4, 0 ) );
+	if ( b.empty() || b.min() != point<T>( -1, 2, 0 ) || b.max() != point<T>( 1, 4, 3 ) )
+		throw std::runtime_error( "box extend" );
+	if ( b.center() != point<T>( 0, 3, T( 1.5 ) ) || b.extent() != vector3<T>{ 1, 1, T( 1.5 ) } )
+		throw std::runtime_error( "box center / extent" );
+	if ( ! b.contains( point<T>( 0, 3, 3 ) ) || b.contains( point<T>( 0, 5, 1 ) ) )
+		throw std::runtime_error( "box contains" );
+	if ( ! b.intersects( aabb<T>( point<T>( 1, 4, 3 ), point<T>( 5, 5, 5 ) ) ) ||
+		 b.intersects( aabb<T>( point<T>( 2, 0, 0 ), point<T>( 5, 5, 5 ) ) ) ||
+		 b.intersects( aabb<T>() ) )
+		throw std::runtime_error( "box intersects" );
+
+	// 90 degrees about z, then moved
+	matrix4<T> rot{
+		T( 0 ), T( -1 ), T( 0 ), T( 10 ),
+		T( 1 ), T( 0 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 0 ), T( 1 ), T( 0 ),
+		T( 0 ), T( 0 ), T( 0 ), T( 1 ) };
+	aabb<T> t = b.transformed( rot );
+	if ( t.min() != point<T>( 6, -1, 0 ) || t.max() != point<T>( 8, 1, 3 ) )
+		throw std::runtime_error( "box transform" );
+	if ( ! aabb<T>().transformed( rot ).empty() )
+		throw std::runtime_error( "empty box transform" );
+
+	sphere<T> s( point<T>( 0, 0, 0 ), T( 2 ) );
+	if ( ! s.contains( point<T>( 0, 2, 0 ) ) || s.contains( point<T>( 2, 2, 0 ) ) )
+		throw std::runtime_error( "sphere contains" );
+	if ( ! s.intersects( sphere<T>( point<T>( 3, 0, 0 ), T( 1 ) ) ) || s.intersects( sphere<T>( point<T>( 3, 1, 0 ), T( 1 ) ) ) )
+		throw std::runtime_error( "sphere intersects sphere" );
+	if ( ! s.intersects( aabb<T>( point<T>( 1, 1, -1 ), point<T>( 3, 3, 1 ) ) ) ||
+		 s.intersects( aabb<T>( point<T>( 2, 2, -1 ), point<T>( 3, 3, 1 ) ) ) ||
+		 s.intersects( aabb<T>() ) )
+		throw std::runtime_error( "sphere intersects box" );
+	if ( s.bounds().min() != point<T>( -2, -2, -2 ) || s.bounds().max() != point<T>( 2, 2, 2 ) )
+		throw std::runtime_error( "sphere bounds" );
+	return 0;
+}
+
+template <typename T>
+int
+testFrustum( bool zeroToOne )
+{
+	typedef typename frustum<T>::clip_depth depth;
+	frustum<T> f( projection<T>( zeroToOne ), zeroToOne ? depth::zero_to_one : depth::minus_one_to_one );
+
+	if ( ! f.visible( point<T>( 0, 0, -10 ) ) || ! f.visible( point<T>( 5, -5, -10 ) ) )
+		throw std::runtime_error( "frustum point inside" );
+	if ( f.visible( point<T>( 0, 0, 10 ) ) || f.visible( point<T>( 0, 0, T( -0.5 ) ) ) ||
+		 f.visible( point<T>( 0, 0, -150 ) ) || f.visible( point<T>( 20, 0, -10 ) ) )
+		throw std::runtime_error( "frustum point outside" );
+
+	if ( ! f.visible( sphere<T>( point<T>( 20, 0, -10 ), T( 15 ) ) ) ||
+		 f.visible( sphere<T>( point<T>( 20, 0, -10 ), T( 5 ) ) ) ||
+		 ! f.visible( sphere<T>( point<T>( 0, 0, -105 ), T( 10 ) ) ) )
+		throw std::runtime_error( "frustum sphere" );
+
+	if ( ! f.visible( aabb<T>( point<T>( 9, -1, -11 ), point<T>( 12, 1, -9 ) ) ) ||
+		 f.visible( aabb<T>( point<T>( T( 11.5 ), -1, -11 ), point<T>( 12, 1, -9 ) ) ) ||
+		 f.visible( aabb<T>() ) )
+		throw std::runtime_error( "frustum box" );
+
+	frustum<T> all;
+	if ( ! all.visible( point<T>( 1e6, -1e6, 1e6 ) ) )
+		throw std::runtime_error( "default frustum should see everything" );
+	return 0;
+}
+
+template <typename T>
+aabb_soa<T>
+randomBoxes( std::mt19937 &gen, size_t n )
+{
+	std::uniform_real_distribution<double> pos( -120.0, 120.0 );
+	std::uniform_real_distribution<double> size( 0.0, 20.0 );
+	aabb_soa<T> r;
+	r.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		if ( i % 97 == 13 )
+		{
+			r.push_back( aabb<T>() );
+			continue;
+		}
+		point<T> lo( T( pos( gen ) ), T( pos( gen ) ), T( pos( gen ) ) );
+		point<T> hi( lo[0] + T( size( gen ) ), lo[1] + T( size( gen ) ), lo[2] + T( size( gen ) ) );
+		r.push_back( aabb<T>( lo, hi ) );
+	}
+	return r;
+}
+
+template <typename T>
+int
+testCull( size_t n, size_t nthreads )
+{
+	std::mt19937 gen( 42 + unsigned( n ) );
+	aabb_soa<T> boxes = randomBoxes<T>( gen, n );
+
+	// looking down -z from z = 60, off to one side a bit
+	matrix4<T> cam{
+		T( 1 ), T( 0 ), T( 0 ), T( -10 ),
+		T( 0 ), T( 1 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 0 ), T( 1 ), T( -60 ),
+		T( 0 ), T( 0 ), T( 0 ), T( 1 ) };
+	frustum<T> f( projection<T>( false ) * cam );
+
+	std::vector<uint64_t> mask;
+	size_t count = cull( f, boxes, mask, nthreads );
+	if ( mask.size() != ( n + 63 ) / 64 )
+		throw std::runtime_error( "cull mask size" );
+
+	size_t expect = 0;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		bool v = f.visible( boxes[i] );
+		bool bit = ( mask[i / 64] >> ( i % 64 ) ) & 1;
+		if ( v != bit )
+			throw std::runtime_error( "cull does not match frustum::visible" );
+		expect += v ? 1 : 0;
+	}
+	for ( size_t i = n; i < mask.size() * 64; ++i )
+	{
+		if ( ( mask[i / 64] >> ( i % 64 ) ) & 1 )
+			throw std::runtime_error( "cull set bits past the end" );
+	}
+	if ( count != expect )
+		throw std::runtime_error( "cull count" );
+	if ( n > 1000 && ( count == 0 || count == n ) )
+		throw std::runtime_error( "cull test scene should be partly visible" );
+	return 0;
+}
+
+template <typename T>
+int
+testAll( void )
+{
+	int retval = 0;
+	retval += testTransforms<T>();
+	retval += testPlane<T>();
+	retval += testBoxes<T>();
+	retval += testFrustum<T>( false );
+	retval += testFrustum<T>( true );
+	for ( size_t n: { 0, 1, 7, 64, 1001 } )
+		retval += testCull<T>( n, 1 );
+
+	// big enough to be split, into an odd number of pieces
+	for ( size_t nthreads: { 0, 3 } )
+		retval += testCull<T>( cull_parallel_min * 2 + 5, nthreads );
+	return retval;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testAll<float>();
+		retval += testAll<double>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
+
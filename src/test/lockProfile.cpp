@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <lock_profile.h>
+#include <mutexext.h>
+#include <locked_queue.h>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+int
+testCounts( void )
+{
+	yaco::profiled_mutex<> m( "test.counts" );
+	{
+		std::lock_guard<yaco::profiled_mutex<>> g( m );
+		yaco::unlock_guard<yaco::profiled_mutex<>> ug( m );
+	}
+	if ( ! m.try_lock() )
+		throw std::runtime_error( "try_lock failed on unlocked profiled_mutex" );
+	m.unlock();
+
+	const yaco::lock_stats &s = m.stats();
+	if ( s.acquisitions != 3 || s.contended != 0 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	uint64_t holds = 0;
+	for ( size_t b = 0; b != yaco::lock_stats::histogram_buckets; ++b )
+		holds += s.hold_histogram[b];
+	if ( holds != 3 )
+		throw std::runtime_error( "hold histogram does not match acquisitions" );
+
+	// same name shares the same statistics
+	yaco::profiled_mutex<> m2( "test.counts" );
+	m2.lock();
+	m2.unlock();
+	if ( s.acquisitions != 4 )
+		throw std::runtime_error( "locks with the same name do not share stats" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testContention( void )
+{
+	yaco::profiled_mutex<yaco::adaptive_mutex> m( "test.contention" );
+	long counter = 0;
+
+	std::vector<std::thread> threads;
+	for ( int t = 0; t < 4; ++t )
+	{
+		threads.emplace_back( [&]()
+		{
+			for ( int i = 0; i < 10000; ++i )
+			{
+				std::lock_guard<yaco::profiled_mutex<yaco::adaptive_mutex>> g( m );
+				++counter;
+			}
+		} );
+	}
+	for ( auto &t: threads )
+		t.join();
+
+	if ( counter != 40000 || m.stats().acquisitions != 40000 ||
+		 m.stats().contended > m.stats().acquisitions )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testQueue( void )
+{
+	yaco::locked_queue<int, yaco::profiled_mutex<>> q( "test.queue" );
+	std::thread producer( [&]()
+	{
+		for ( int i = 1; i <= 1000; ++i )
+			q.push( i );
+	} );
+
+	long sum = 0;
+	for ( int i = 0; i < 1000; ++i )
+		sum += q.pop();
+	producer.join();
+
+	if ( sum != 500500 || ! q.empty() )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	std::ostringstream out;
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize prec = out.precision();
+	yaco::dump_lock_profile( out );
+	if ( out.str().find( "test.queue" ) == std::string::npos )
+		throw std::runtime_error( "lock profile dump missing queue lock" );
+	if ( out.flags() != flags || out.precision() != prec )
+		throw std::runtime_error( "lock profile dump changed the stream format" );
+
+	std::vector<yaco::lock_profile_entry> snap = yaco::lock_profile_snapshot();
+	for ( size_t i = 1; i < snap.size(); ++i )
+		if ( snap[i - 1].wait_ns < snap[i].wait_ns )
+			throw std::runtime_error( "lock profile snapshot not sorted by wait time" );
+
+	yaco::reset_lock_profile();
+	for ( auto &e: yaco::lock_profile_snapshot() )
+		if ( e.acquisitions != 0 )
+			throw std::runtime_error( "lock profile reset failed" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testCounts();
+		retval += testContention();
+		retval += testQueue();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,339 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/matrix.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+/// row major reference values, in long double
+template <size_t dim>
+struct reference
+{
+	long double v[dim][dim];
+
+	template <typename T>
+	explicit reference( const square_matrix<T, dim> &m )
+	{
+		for ( size_t r = 0; r != dim; ++r )
+			for ( size_t c = 0; c != dim; ++c )
+				v[r][c] = m( r, c );
+	}
+	reference( void ) {}
+
+	reference operator*( const reference &o ) const
+	{
+		reference out;
+		for ( size_t r = 0; r != dim; ++r )
+		{
+			for ( size_t c = 0; c != dim; ++c )
+			{
+				long double s = 0;
+				for ( size_t k = 0; k != dim; ++k )
+					s += v[r][k] * o.v[k][c];
+				out.v[r][c] = s;
+			}
+		}
+		return out;
+	}
+
+	/// Gauss-Jordan, returns the determinant
+	long double invert( reference &out ) const
+	{
+		reference a = *this;
+		for ( size_t r = 0; r != dim; ++r )
+			for ( size_t c = 0; c != dim; ++c )
+				out.v[r][c] = r == c ? 1 : 0;
+		long double det = 1;
+		for ( size_t k = 0; k != dim; ++k )
+		{
+			size_t p = k;
+			for ( size_t r = k + 1; r != dim; ++r )
+				if ( std::abs( a.v[r][k] ) > std::abs( a.v[p][k] ) )
+					p = r;
+			if ( a.v[p][k] == 0 )
+				return 0;
+			if ( p != k )
+			{
+				std::swap( a.v[p], a.v[k] );
+				std::swap( out.v[p], out.v[k] );
+				det = -det;
+			}
+			long double piv = a.v[k][k];
+			det *= piv;
+			for ( size_t c = 0; c != dim; ++c )
+			{
+				a.v[k][c] /= piv;
+				out.v[k][c] /= piv;
+			}
+			for ( size_t r = 0; r != dim; ++r )
+			{
+				if ( r == k )
+					continue;
+				long double f = a.v[r][k];
+				for ( size_t c = 0; c != dim; ++c )
+				{
+					a.v[r][c] -= f * a.v[k][c];
+					out.v[r][c] -= f * out.v[k][c];
+				}
+			}
+		}
+		return det;
+	}
+};
+
+template <typename T>
+bool
+close( long double a, long double b, long double scale )
+{
+	return std::abs( a - b ) <= std::numeric_limits<T>::epsilon() * 64 * std::max( 1.0L, scale );
+}
+
+template <typename T, size_t dim>
+void
+checkClose( const square_matrix<T, dim> &m, const reference<dim> &ref, long double scale, const char *what )
+{
+	for ( size_t r = 0; r != dim; ++r )
+		for ( size_t c = 0; c != dim; ++c )
+			if ( ! close<T>( m( r, c ), ref.v[r][c], scale ) )
+				throw std::runtime_error( what );
+}
+
+/// diagonally dominant, so well conditioned
+template <typename T, size_t dim>
+square_matrix<T, dim>
+randomMatrix( std::mt19937 &gen )
+{
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	square_matrix<T, dim> m;
+	for ( size_t r = 0; r != dim; ++r )
+		for ( size_t c = 0; c != dim; ++c )
+			m( r, c ) = static_cast<T>( val( gen ) + ( r == c ? 3.0 * ( val( gen ) < 0 ? -1 : 1 ) : 0.0 ) );
+	return m;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T, size_t dim>
+int
+testOps( void )
+{
+	typedef square_matrix<T, dim> mat;
+	typedef vector<T, dim> vec;
+	std::mt19937 gen( 17 + dim );
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+
+	for ( int iter = 0; iter < 500; ++iter )
+	{
+		mat a = randomMatrix<T, dim>( gen );
+		mat b = randomMatrix<T, dim>( gen );
+		reference<dim> ra( a ), rb( b );
+
+		checkClose( mat( a * b ), ra * rb, 16, "multiply" );
+		mat c = a;
+		c *= b;
+		checkClose( c, ra * rb, 16, "multiply in place" );
+
+		vec v;
+		for ( size_t i = 0; i != dim; ++i )
+			v[i] = static_cast<T>( val( gen ) );
+		vec av = a * v;
+		for ( size_t r = 0; r != dim; ++r )
+		{
+			long double s = 0;
+			for ( size_t k = 0; k != dim; ++k )
+				s += ra.v[r][k] * v[k];
+			if ( ! close<T>( av[r], s, 4 ) )
+				throw std::runtime_error( "transform" );
+		}
+		// an expression as the vector
+		if ( vec( a * ( v + v ) ) != vec( a * vec( v * T( 2 ) ) ) )
+			throw std::runtime_error( "transform of an expression" );
+
+		mat t = a.transposed();
+		for ( size_t r = 0; r != dim; ++r )
+			for ( size_t k = 0; k != dim; ++k )
+				if ( t( r, k ) != a( k, r ) )
+					throw std::runtime_error( "transpose" );
+
+		reference<dim> rinv;
+		long double rdet = ra.invert( rinv );
+		long double dscale = std::abs( rdet );
+		if ( ! close<T>( a.determinant(), rdet, dscale ) || ! close<T>( determinant( a ), rdet, dscale ) )
+			throw std::runtime_error( "determinant" );
+
+		mat inv = a.inverse();
+		checkClose( inv, rinv, 16, "inverse" );
+		checkClose( mat( a * inv ), reference<dim>( mat() ), 16, "a * inverse( a )" );
+		// not compared bit for bit with inv: with fused multiply-add
+		// the two inlined copies may be contracted differently
+		mat inv2;
+		if ( ! a.invert( inv2 ) )
+			throw std::runtime_error( "invert" );
+		checkClose( inv2, rinv, 16, "invert" );
+	}
+
+	// singular: two equal rows, of small integers so the
+	// determinant is exactly 0
+	if ( dim > 1 )
+	{
+		std::uniform_int_distribution<int> ival( -4, 4 );
+		mat s;
+		for ( size_t r = 0; r != dim; ++r )
+			for ( size_t c = 0; c != dim; ++c )
+				s( r, c ) = T( ival( gen ) );
+		s.set_row( 1, s.row( 0 ) );
+		mat out = mat::zero();
+		bool threw = false;
+		try
+		{
+			s.inverse();
+		}
+		catch ( std::runtime_error & )
+		{
+			threw = true;
+		}
+		if ( ! threw || s.invert( out ) || out != mat::zero() || s.determinant() != T( 0 ) )
+			throw std::runtime_error( "singular matrix" );
+	}
+
+	// rank deficient with real values, where rounding leaves the
+	// computed determinant near, but not at, 0
+	for ( int iter = 0; dim > 1 && iter < 200; ++iter )
+	{
+		mat s = randomMatrix<T, dim>( gen );
+		vec r0 = s.row( 0 ), rl = s.row( dim - 1 );
+		T k = static_cast<T>( val( gen ) ) * T( 1000 );
+		if ( dim > 2 )
+			s.set_row( 1, vec( r0 * T( 0.3 ) - rl * T( 1.7 ) ) );
+		else
+			s.set_row( 1, vec( r0 * T( 0.3 ) ) );
+		// and the scale of the matrix shouldn't matter
+		if ( iter % 2 )
+			s *= k;
+
+		bool threw = false;
+		try
+		{
+			s.inverse();
+		}
+		catch ( std::runtime_error & )
+		{
+			threw = true;
+		}
+		mat out = mat::zero();
+		if ( ! threw || s.invert( out ) || s.determinant() != T( 0 ) )
+			throw std::runtime_error( "rank deficient matrix should be singular" );
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testBasics( void )
+{
+	fmat3 m{ 1, 2, 3,
+			 4, 5, 6,
+			 7, 8, 9 };
+	if ( m( 0, 1 ) != 2 || m( 1, 0 ) != 4 || m.data()[1] != 4 || m.at( 2, 2 ) != 9 )
+		throw std::runtime_error( "initializer list is not by rows" );
+	if ( m.row( 1 ) != fvec3{ 4, 5, 6 } || m.column( 1 ) != fvec3{ 2, 5, 8 } )
+		throw std::runtime_error( "row / column" );
+	if ( fmat3() != fmat3{ 1, 0, 0, 0, 1, 0, 0, 0, 1 } || fmat3::identity() * m != m )
+		throw std::runtime_error( "identity" );
+	if ( mat3( m )( 2, 1 ) != 8.0 )
+		throw std::runtime_error( "conversion" );
+	bool threw = false;
+	try
+	{
+		m.at( 3, 0 );
+	}
+	catch ( std::out_of_range & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "at past the end" );
+
+	// translate by ( 1, 2, 3 ), then a perspective w = z
+	mat4 xlate{ 1, 0, 0, 1,
+				0, 1, 0, 2,
+				0, 0, 1, 3,
+				0, 0, 0, 1 };
+	if ( transform_point( xlate, vec3{ 1, 1, 1 } ) != vec3{ 2, 3, 4 } ||
+		 transform_vector( xlate, vec3{ 1, 1, 1 } ) != vec3{ 1, 1, 1 } )
+		throw std::runtime_error( "transform_point / transform_vector" );
+	fmat4 persp{ 1, 0, 0, 0,
+				 0, 1, 0, 0,
+				 0, 0, 1, 0,
+				 0, 0, 1, 0 };
+	if ( transform_point( persp, fvec3{ 2, 4, 2 } ) != fvec3{ 1, 2, 1 } )
+		throw std::runtime_error( "perspective divide" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testBasics();
+		retval += testOps<float, 2>();
+		retval += testOps<float, 3>();
+		retval += testOps<float, 4>();
+		retval += testOps<double, 2>();
+		retval += testOps<double, 3>();
+		retval += testOps<double, 4>();
+		retval += testOps<long double, 4>();
+		retval += testOps<float, 5>();
+		retval += testOps<double, 6>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <mutexext.h>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+struct snapshot
+{
+	int a, b, c, d;
+};
+
+int
+testSeqLock( void )
+{
+	yaco::seqlock<snapshot> sl( snapshot{ 0, 1, 2, 3 } );
+	std::atomic<bool> done( false );
+	std::atomic<int> bad( 0 );
+
+	std::vector<std::thread> readers;
+	for ( int t = 0; t < 3; ++t )
+	{
+		readers.emplace_back( [&]()
+		{
+			while ( ! done.load() )
+			{
+				snapshot s = sl.load();
+				if ( s.b != s.a + 1 || s.c != s.a + 2 || s.d != s.a + 3 )
+					++bad;
+			}
+		} );
+	}
+
+	for ( int i = 0; i < 100000; ++i )
+	{
+		if ( i & 1 )
+			sl.store( snapshot{ i, i + 1, i + 2, i + 3 } );
+		else
+		{
+			std::lock_guard<yaco::seqlock<snapshot>> g( sl );
+			snapshot w = sl.load_locked();
+			w.a = i; w.b = i + 1; w.c = i + 2; w.d = i + 3;
+			sl.store_locked( w );
+		}
+	}
+	done = true;
+	for ( auto &t: readers )
+		t.join();
+
+	if ( bad != 0 || sl.load().a != 99999 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testRWMutex( void )
+{
+	yaco::distributed_rw_mutex m;
+	long shared_a = 0, shared_b = 0;
+	std::atomic<int> bad( 0 );
+
+	std::vector<std::thread> threads;
+	for ( int t = 0; t < 4; ++t )
+	{
+		threads.emplace_back( [&, t]()
+		{
+			for ( int i = 0; i < 20000; ++i )
+			{
+				if ( t == 0 && ( i % 8 ) == 0 )
+				{
+					std::lock_guard<yaco::distributed_rw_mutex> g( m );
+					++shared_a;
+					++shared_b;
+				}
+				else
+				{
+					yaco::shared_lock_guard<yaco::distributed_rw_mutex> g( m );
+					if ( shared_a != shared_b )
+						++bad;
+				}
+			}
+		} );
+	}
+	for ( auto &t: threads )
+		t.join();
+
+	if ( bad != 0 || shared_a != 2500 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	m.lock();
+	if ( m.try_lock_shared() )
+		throw std::runtime_error( "shared lock acquired while writer holds lock" );
+	{
+		yaco::unlock_guard<yaco::distributed_rw_mutex> ug( m );
+		if ( ! m.try_lock_shared() )
+			throw std::runtime_error( "unable to acquire shared lock after unlock" );
+		m.unlock_shared();
+	}
+	m.unlock();
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testAdaptiveMutex( void )
+{
+	yaco::adaptive_mutex m( 50 );
+	long counter = 0;
+
+	std::vector<std::thread> threads;
+	for ( int t = 0; t < 8; ++t )
+	{
+		threads.emplace_back( [&]()
+		{
+			for ( int i = 0; i < 50000; ++i )
+			{
+				std::lock_guard<yaco::adaptive_mutex> g( m );
+				++counter;
+			}
+		} );
+	}
+	for ( auto &t: threads )
+		t.join();
+
+	if ( counter != 400000 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	std::lock_guard<yaco::adaptive_mutex> g( m );
+	if ( m.try_lock() )
+		throw std::runtime_error( "try_lock succeeded on a locked adaptive_mutex" );
+	{
+		yaco::unlock_guard<yaco::adaptive_mutex> ug( m );
+		if ( ! m.try_lock() )
+			throw std::runtime_error( "try_lock failed on an unlocked adaptive_mutex" );
+		m.unlock();
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testSeqLock();
+		retval += testRWMutex();
+		retval += testAdaptiveMutex();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
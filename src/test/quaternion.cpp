@@ -0,0 +1,326 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/quaternion_soa.h>
+#include <random>
+#include <limits>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename T>
+bool
+close( T a, T b, T ulps = T( 64 ) )
+{
+	T tol = std::numeric_limits<T>::epsilon() * ulps * std::max( T( 1 ), std::max( std::abs( a ), std::abs( b ) ) );
+	return std::abs( a - b ) <= tol;
+}
+
+template <typename T>
+void
+checkClose( const quaternion<T> &a, const quaternion<T> &b, const char *what, T ulps = T( 64 ) )
+{
+	for ( size_t i = 0; i != 4; ++i )
+	{
+		if ( ! close( a[i], b[i], ulps ) )
+			throw std::runtime_error( std::string( what ) + ": quaternion mismatch" );
+	}
+}
+
+template <typename T>
+void
+checkClose( const vector<T, 3> &a, const vector<T, 3> &b, const char *what )
+{
+	for ( size_t i = 0; i != 3; ++i )
+	{
+		if ( ! close( a[i], b[i] ) )
+			throw std::runtime_error( std::string( what ) + ": vector mismatch" );
+	}
+}
+
+template <typename T>
+quaternion<T>
+randomRotation( std::mt19937 &gen )
+{
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	quaternion<T> q;
+	do
+	{
+		for ( size_t i = 0; i != 4; ++i )
+			q[i] = static_cast<T>( val( gen ) );
+	} while ( q.magnitude() < T( 0.1 ) );
+	q.normalize();
+	return q;
+}
+
+template <typename T>
+int
+testArithmetic( void )
+{
+	typedef quaternion<T> Q;
+	const Q one( 1 ), i( 0, 1 ), j( 0, 0, 1 ), k( 0, 0, 0, 1 );
+
+	if ( i * i != -one || j * j != -one || k * k != -one ||
+		 i * j != k || j * k != i || k * i != j || j * i != -k )
+		throw std::runtime_error( "quaternion multiplication table" );
+	if ( Q::identity() != one || Q() != Q( 0, 0, 0, 0 ) )
+		throw std::runtime_error( "quaternion construction" );
+
+	typedef typename Q::complex_type C;
+	Q c( C( 1, 2 ), C( 3, 4 ) );
+	if ( c != Q( 1, 2, 3, 4 ) || c.real() != T( 1 ) || ! ( c.unreal() == vector<T, 3>{ 2, 3, 4 } ) )
+		throw std::runtime_error( "quaternion from complex" );
+	c += C( 1, 1 );
+	c -= T( 1 );
+	if ( c != Q( 1, 3, 3, 4 ) )
+		throw std::runtime_error( "quaternion complex add" );
+
+	std::mt19937 gen( 7 );
+	for ( int n = 0; n != 100; ++n )
+	{
+		Q a = randomRotation<T>( gen ) * T( 3 ), b = randomRotation<T>( gen );
+		checkClose( a * a.inverse(), one, "inverse" );
+		checkClose( ( a / b ) * b, a, "divide" );
+		Q bc = b;
+		bc *= C( 2, 1 );
+		checkClose( bc, b * Q( C( 2, 1 ) ), "complex multiply" );
+		bc /= C( 2, 1 );
+		checkClose( bc, b, "complex divide" );
+		checkClose( conj( a * b ), conj( b ) * conj( a ), "conjugate" );
+		if ( ! close( magnitude( normalize( a ) ), T( 1 ) ) || ! close( a.magnitude(), T( 3 ) ) )
+			throw std::runtime_error( "quaternion normalize" );
+
+		quaternion<long double> wide( a );
+		if ( Q( wide ) != a )
+			throw std::runtime_error( "quaternion conversion" );
+	}
+
+	bool threw = false;
+	try
+	{
+		Q().inverse();
+	}
+	catch ( std::runtime_error & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "inverted zero quaternion" );
+	return 0;
+}
+
+template <typename T>
+int
+testRotation( void )
+{
+	typedef quaternion<T> Q;
+	typedef vector<T, 3> V;
+	const T pi = T( 3.14159265358979323846264338327950288L );
+
+	// a quarter turn about z takes x to y
+	Q q = Q::from_rotation( pi / T( 2 ), V{ 0, 0, 2 } );
+	checkClose( q.rotate( V{ 1, 0, 0 } ), V{ 0, 1, 0 }, "rotate" );
+	checkClose( q.to_matrix() * V{ 1, 0, 0 }, V{ 0, 1, 0 }, "to_matrix" );
+
+	auto ra = Q::identity().rotation();
+	if ( ra.first != T( 0 ) || ! ( ra.second == V{ 1, 0, 0 } ) )
+		throw std::runtime_error( "identity rotation" );
+
+	std::mt19937 gen( 11 );
+	std::uniform_real_distribution<double> val( -1.0, 1.0 );
+	for ( int n = 0; n != 100; ++n )
+	{
+		Q a = randomRotation<T>( gen ), b = randomRotation<T>( gen );
+		V v{ static_cast<T>( val( gen ) ), static_cast<T>( val( gen ) ), static_cast<T>( val( gen ) ) };
+
+		checkClose( a.rotate( v ), a.to_matrix() * v, "rotate vs to_matrix" );
+		checkClose( ( a * b ).rotate( v ), a.rotate( b.rotate( v ) ), "composition" );
+		checkClose( ( a * T( 5 ) ).to_matrix() * v, a.to_matrix() * v, "to_matrix scale" );
+		if ( ! close( a.to_matrix().determinant(), T( 1 ) ) )
+			throw std::runtime_error( "to_matrix not a rotation" );
+
+		auto r = a.rotation();
+		Q back = Q::from_rotation( r.first, r.second );
+		checkClose( back, a, "rotation round trip" );
+
+		// slerp at constant speed about the same axis (the angle
+		// below pi, so the short way round)
+		T ang = static_cast<T>( 1.5 * ( val( gen ) + 1.0 ) );
+		Q e = Q::from_rotation( ang, r.second );
+		Q h = Q::from_rotation( ang / T( 2 ), r.second );
+		checkClose( slerp( Q::identity(), e, T( 0.5 ) ), h, "slerp midpoint" );
+		checkClose( slerp( a, b, T( 0 ) ), a, "slerp start" );
+		checkClose( slerp( a, -b, T( 1 ) ) * T( dot( a, -b ) < 0 ? -1 : 1 ), -b, "slerp end" );
+		checkClose( nlerp( a, b, T( 0.5 ) ), normalize( slerp( a, b, T( 0.5 ) ) ), "nlerp midpoint" );
+	}
+	return 0;
+}
+
+template <typename T>
+quaternion_soa<T>
+randomBuffer( std::mt19937 &gen, size_t n )
+{
+	quaternion_soa<T> r;
+	r.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+		r.push_back( randomRotation<T>( gen ) );
+	return r;
+}
+
+// the compiler is free to fuse the single quaternion functions into
+// multiply-adds (gcc does so when it vectorizes operator*, even with
+// -ffp-contract=off), so the batch results may differ in the last bits
+template <typename T>
+void
+checkSame( const quaternion_soa<T> &a, const quaternion_soa<T> &b, const char *what )
+{
+	if ( a.size() != b.size() )
+		throw std::runtime_error( std::string( what ) + ": size mismatch" );
+	for ( size_t i = 0; i != a.size(); ++i )
+	{
+		quaternion<T> x = a[i], y = b[i];
+		for ( size_t k = 0; k != 4; ++k )
+		{
+			if ( ! close( x[k], y[k], T( 8 ) ) )
+				throw std::runtime_error( std::string( what ) + ": mismatch at " + std::to_string( i ) );
+		}
+	}
+}
+
+template <typename T>
+int
+testBatch( size_t n, size_t nthreads )
+{
+	std::mt19937 gen( static_cast<unsigned>( n ) );
+	quaternion_soa<T> a = randomBuffer<T>( gen, n ), b = randomBuffer<T>( gen, n ), out, expect;
+
+	// not unit length, and a zero one
+	quaternion_soa<T> scaled;
+	for ( size_t i = 0; i != n; ++i )
+		scaled.push_back( a[i] * T( i % 7 ) );
+	expect.clear();
+	for ( size_t i = 0; i != n; ++i )
+		expect.push_back( normalize( scaled[i] ) );
+	normalize( scaled, nthreads );
+	checkSame( scaled, expect, "normalize" );
+
+	expect.clear();
+	for ( size_t i = 0; i != n; ++i )
+		expect.push_back( a[i] * b[i] );
+	multiply( a, b, out, nthreads );
+	checkSame( out, expect, "multiply" );
+
+	vector_soa<T, 9> mats;
+	to_matrix( a, mats, nthreads );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		square_matrix<T, 3> m = a[i].to_matrix();
+		for ( size_t c = 0; c != 9; ++c )
+		{
+			if ( ! close( mats.component( c )[i], m.data()[c], T( 8 ) ) )
+				throw std::runtime_error( "to_matrix mismatch at " + std::to_string( i ) );
+		}
+	}
+
+	for ( T t: { T( 0 ), T( 0.25 ), T( 0.5 ), T( 0.7 ), T( 1 ) } )
+	{
+		expect.clear();
+		for ( size_t i = 0; i != n; ++i )
+			expect.push_back( nlerp( a[i], b[i], t ) );
+		nlerp( a, b, t, out, nthreads );
+		checkSame( out, expect, "nlerp" );
+
+		slerp( a, b, t, out, nthreads );
+		for ( size_t i = 0; i != n; ++i )
+			checkClose( out[i], slerp( a[i], b[i], t ), "batch slerp", T( 16 ) );
+	}
+
+	// in place
+	out = a;
+	multiply( out, b, out, nthreads );
+	multiply( a, b, expect, nthreads );
+	checkSame( out, expect, "in place multiply" );
+
+	bool threw = false;
+	try
+	{
+		b.push_back( quaternion<T>() );
+		multiply( a, b, out, nthreads );
+	}
+	catch ( std::invalid_argument & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "multiply accepted buffers of different sizes" );
+	return 0;
+}
+
+template <typename T>
+int
+testAll( void )
+{
+	int retval = testArithmetic<T>();
+	retval += testRotation<T>();
+	for ( size_t n: { 0, 1, 7, 64, 1001 } )
+		retval += testBatch<T>( n, 1 );
+	for ( size_t nthreads: { 0, 3 } )
+		retval += testBatch<T>( vector_soa_parallel_min + 13, nthreads );
+	return retval;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testAll<float>();
+		retval += testAll<double>();
+		retval += testArithmetic<long double>();
+		retval += testRotation<long double>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -20,7 +20,13 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
-#include <math/region>
+#include <math/region.h>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+#include <new>
 #include <stdexcept>
 #include <iostream>
 
@@ -179,6 +185,430 @@ testXORRegion( void )
 ////////////////////////////////////////
 
 
+static int
+testCanonicalize( void )
+{
+	// a plus sign, given as overlapping bars, plus a duplicate
+	region_list l{ region( 10, 19, 0, 29 ), region( 0, 29, 10, 19 ), region( 10, 19, 0, 29 ) };
+	canonicalize( l );
+
+	region_list expect{ region( 10, 19, 0, 9 ), region( 0, 29, 10, 19 ), region( 10, 19, 20, 29 ) };
+	if ( l != expect )
+	{
+		std::cout << "canonicalize: " << l << std::endl;
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	}
+
+	// side by side regions with the same span join, bands with
+	// different spans stay separate
+	region_list m{ region( 5, 9, 0, 4 ), region( 0, 4, 0, 4 ), region( 0, 9, 5, 9 ), region( 20, 24, 0, 9 ) };
+	sort_and_merge( m );
+	region_list expectm{ region( 0, 9, 0, 9 ), region( 20, 24, 0, 9 ) };
+	if ( m != expectm )
+	{
+		std::cout << "sort_and_merge: " << m << std::endl;
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	}
+
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+static int
+testCombine( void )
+{
+	region_list a{ region( 0, 9, 0, 9 ), region( 5, 14, 5, 14 ) };
+	region_list b{ region( 5, 9, 0, 19 ) };
+
+	// covered by at least two regions, regardless of list
+	region_list twice = region_combine( a, b, []( int ca, int cb ) { return ( ca + cb ) >= 2; } );
+	region_list expect{ region( 5, 9, 0, 14 ) };
+	if ( twice != expect )
+	{
+		std::cout << "combine twice: " << twice << std::endl;
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	}
+
+	if ( region_combine( a, b, []( int ca, int cb ) { return ca > 0 && cb > 0; } ) != ( a & b ) )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+static int
+testParallel( void )
+{
+	std::mt19937 gen( 42 );
+	std::uniform_int_distribution<int> pos( 0, 2000 );
+	std::uniform_int_distribution<int> sz( 1, 40 );
+
+	region_list a, b;
+	for ( int i = 0; i < 5000; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		a.push_back( r );
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		b.push_back( r );
+	}
+	// something spanning every slab
+	a.push_back( region( 100, 120, -10, 3000 ) );
+
+	if ( parallel_and( a, b, 4 ) != ( a & b ) ||
+		 parallel_or( a, b, 4 ) != ( a | b ) ||
+		 parallel_xor( a, b, 3 ) != ( a ^ b ) ||
+		 parallel_not_in( a, b, 7 ) != not_in( a, b ) )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	auto twice = []( int ca, int cb ) { return ( ca + cb ) >= 2; };
+	if ( region_combine_parallel( a, b, twice, 5 ) != region_combine( a, b, twice ) )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+static bool
+covers( const region_list_t<T> &l, T x, T y )
+{
+	for ( auto &r: l )
+		if ( r.contains( x, y ) )
+			return true;
+	return false;
+}
+
+/// checks the operators point by point, on coordinates picked from
+/// the region edges (and their neighbors) so every boundary is hit
+template <typename T>
+static void
+checkCoordinateType( const std::vector<T> &coords )
+{
+	typedef yaco::__priv::region_coord<T> coord;
+	std::mt19937 gen( 7 );
+	std::uniform_int_distribution<size_t> pick( 0, coords.size() - 1 );
+
+	for ( int iter = 0; iter < 20; ++iter )
+	{
+		region_list_t<T> a, b;
+		for ( int i = 0; i < 6; ++i )
+		{
+			T x0 = coords[pick( gen )], x1 = coords[pick( gen )];
+			T y0 = coords[pick( gen )], y1 = coords[pick( gen )];
+			( i % 2 ? a : b ).push_back( region_t<T>( std::min( x0, x1 ), std::max( x0, x1 ),
+													  std::min( y0, y1 ), std::max( y0, y1 ) ) );
+		}
+
+		region_list_t<T> ra = a & b, ro = a | b, rx = a ^ b, rn = not_in( a, b );
+		region_list_t<T> inv = ~a;
+		std::vector<T> samples;
+		for ( T c: coords )
+		{
+			samples.push_back( coord::prev( c ) );
+			samples.push_back( c );
+			samples.push_back( coord::next( c ) );
+		}
+		for ( T x: samples )
+		{
+			for ( T y: samples )
+			{
+				bool ia = covers( a, x, y ), ib = covers( b, x, y );
+				if ( covers( ra, x, y ) != ( ia && ib ) ||
+					 covers( ro, x, y ) != ( ia || ib ) ||
+					 covers( rx, x, y ) != ( ia != ib ) ||
+					 covers( rn, x, y ) != ( ia && ! ib ) ||
+					 covers( inv, x, y ) == ia )
+					throw std::runtime_error( __PRETTY_FUNCTION__ );
+			}
+		}
+	}
+}
+
+
+////////////////////////////////////////
+
+
+static int
+testCoordinateTypes( void )
+{
+	const int64_t big = int64_t( 1 ) << 40;
+	region64 w( 0, big, 0, 10 );
+	region64_list u = region64_list{ w } | region64( big / 2, 2 * big, 0, 10 );
+	if ( u.size() != 1 || u[0] != region64( 0, 2 * big, 0, 10 ) || w.size_x() != big + 1 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	if ( ! region64( region64::inf ).infinite_r() ||
+		 region64( region64::inf ).right() != std::numeric_limits<int64_t>::max() )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	regiond d( regiond::inf );
+	if ( d.right() != std::numeric_limits<double>::infinity() || ! d.infinite() )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	regiond box;
+	box.reset_by_size( 0.5, 0.5, 2.0, 2.0 );
+	if ( box != regiond( 0.5, 2.5, 0.5, 2.5 ) || box.size_x() != 2.0 )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+	regiond_list cut = not_in( regiond( 0.0, 1.0, 0.0, 1.0 ), regiond_list{ regiond( 0.5, 2.0, 0.0, 1.0 ) } );
+	if ( cut.size() != 1 || cut[0].right() != std::nextafter( 0.5, 0.0 ) )
+		throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+	checkCoordinateType<int>( { -7, -1, 0, 3, 4, 10 } );
+	checkCoordinateType<int64_t>( { -big, -1, 0, 1, big, 3 * big } );
+	checkCoordinateType<float>( { -2.5f, -0.125f, 0.0f, 1.0f, 1.5f, 7.75f } );
+	checkCoordinateType<double>( { -1e12, -0.5, 0.0, 0.25, 1e-9, 3.0 } );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+static size_t theAllocations = 0;
+
+void *
+operator new( size_t n )
+{
+	++theAllocations;
+	if ( void *p = std::malloc( n ? n : 1 ) )
+		return p;
+	throw std::bad_alloc();
+}
+
+void
+operator delete( void *p ) noexcept
+{
+	std::free( p );
+}
+
+static int
+testInto( void )
+{
+	std::mt19937 gen( 8 );
+	std::uniform_int_distribution<int> pos( 0, 500 );
+	std::uniform_int_distribution<int> sz( 1, 60 );
+
+	std::vector<region_list> inputs( 6 );
+	for ( auto &l: inputs )
+	{
+		for ( int i = 0; i < 300; ++i )
+		{
+			region r;
+			r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+			l.push_back( r );
+		}
+	}
+
+	region_scratch scratch;
+	region_list out, out2;
+	for ( int round = 0; round < 4; ++round )
+	{
+		// the first rounds grow the buffers, after which nothing
+		// should allocate
+		size_t before = theAllocations;
+		for ( size_t i = 0; i < inputs.size(); i += 2 )
+		{
+			const region_list &a = inputs[i], &b = inputs[i + 1];
+			const region &rb = b.front();
+			intersect_into( out, a, b, scratch );
+			union_into( out, a, b, scratch );
+			xor_into( out, a, b, scratch );
+			not_in_into( out, a, b, scratch );
+			complement_into( out, a, scratch );
+			intersect_into( out, a, rb, scratch );
+			union_into( out, a, rb, scratch );
+			xor_into( out, a, rb, scratch );
+			not_in_into( out, a, rb, scratch );
+			not_in_into( out, rb, a, scratch );
+		}
+		if ( round >= 2 && theAllocations != before )
+			throw std::runtime_error( "region _into operations allocated in steady state" );
+	}
+
+	for ( size_t i = 0; i < inputs.size(); i += 2 )
+	{
+		const region_list &a = inputs[i], &b = inputs[i + 1];
+		const region &rb = b.front();
+		if ( ( intersect_into( out, a, b, scratch ), out ) != ( a & b ) ||
+			 ( union_into( out, a, b, scratch ), out ) != ( a | b ) ||
+			 ( xor_into( out, a, b, scratch ), out ) != ( a ^ b ) ||
+			 ( not_in_into( out, a, b, scratch ), out ) != not_in( a, b ) ||
+			 ( complement_into( out, a, scratch ), out ) != ~a ||
+			 ( intersect_into( out, a, rb, scratch ), out ) != ( a & rb ) ||
+			 ( union_into( out, a, rb, scratch ), out ) != ( a | rb ) ||
+			 ( xor_into( out, a, rb, scratch ), out ) != ( a ^ rb ) ||
+			 ( not_in_into( out, a, rb, scratch ), out ) != not_in( a, rb ) ||
+			 ( not_in_into( out, rb, a, scratch ), out ) != not_in( rb, a ) )
+			throw std::runtime_error( __PRETTY_FUNCTION__ );
+
+		// output aliasing an input
+		out2 = a;
+		intersect_into( out2, out2, b, scratch );
+		if ( out2 != ( a & b ) )
+			throw std::runtime_error( __PRETTY_FUNCTION__ );
+	}
+	return 0;
+}
+
+static double
+area( const region_list &l )
+{
+	double retval = 0.0;
+	for ( const auto &r: l )
+		retval += ( double(r.right()) - double(r.left()) + 1.0 ) * ( double(r.top()) - double(r.bottom()) + 1.0 );
+	return retval;
+}
+
+static void
+checkQueries( const region_list &a, const region_list &b )
+{
+	region_list both = a & b;
+	if ( intersection_area( a, b ) != area( both ) ||
+		 any_overlap( a, b ) != ! both.empty() ||
+		 covers( a, b ) != not_in( b, a ).empty() ||
+		 equal_coverage( a, b ) != ( a ^ b ).empty() )
+		throw std::runtime_error( "region list query does not match the operators" );
+
+	for ( const auto &r: b )
+	{
+		region_list rboth = a & r;
+		if ( intersection_area( a, r ) != area( rboth ) ||
+			 any_overlap( a, r ) != ! rboth.empty() ||
+			 covers( a, r ) != not_in( r, a ).empty() )
+			throw std::runtime_error( "region query does not match the operators" );
+	}
+}
+
+static int
+testQueries( void )
+{
+	region_list a{ region( 0, 9, 0, 9 ), region( 10, 19, 0, 4 ) };
+	// same coverage, split differently
+	region_list b{ region( 0, 19, 0, 4 ), region( 0, 9, 5, 9 ) };
+	region_list c{ region( 2, 3, 2, 3 ), region( 15, 19, 1, 2 ) };
+	region_list d{ region( 30, 40, 30, 40 ) };
+
+	if ( ! equal_coverage( a, b ) || ! covers( a, b ) || ! covers( b, a ) ||
+		 ! covers( a, c ) || covers( c, a ) || equal_coverage( a, c ) ||
+		 any_overlap( a, d ) || ! any_overlap( a, c ) ||
+		 intersection_area( a, b ) != 150.0 || intersection_area( a, c ) != 14.0 ||
+		 intersection_area( a, d ) != 0.0 ||
+		 ! covers( a, region( 5, 15, 1, 3 ) ) || covers( a, region( 5, 15, 1, 5 ) ) ||
+		 ! covers( d, region() ) || ! covers( region_list(), region_list() ) ||
+		 ! equal_coverage( region_list(), region_list{ region() } ) ||
+		 any_overlap( region_list(), a ) )
+		throw std::runtime_error( "region queries failed on fixed input" );
+
+	// the integer sentinels must not be counted as pixels
+	const double inf = std::numeric_limits<double>::infinity();
+	region_list all{ region( region::inf ) };
+	region_list right{ region( 0, std::numeric_limits<int>::max(), 0, 9 ) };
+	if ( intersection_area( all, region_list{ region( region::inf ) } ) != inf ||
+		 intersection_area( all, region( region::inf ) ) != inf ||
+		 intersection_area( all, right ) != inf ||
+		 intersection_area( all, a ) != 150.0 ||
+		 intersection_area( regiond_list{ regiond( regiond::inf ) }, regiond( regiond::inf ) ) != inf )
+		throw std::runtime_error( "intersection_area of infinite regions" );
+
+	std::mt19937 gen( 11 );
+	std::uniform_int_distribution<int> count( 0, 40 );
+	std::uniform_int_distribution<int> sz( 1, 40 );
+	for ( int span: { 30, 100, 400 } )
+	{
+		std::uniform_int_distribution<int> pos( 0, span );
+		for ( int iter = 0; iter < 200; ++iter )
+		{
+			region_list la, lb;
+			for ( region_list *l: { &la, &lb } )
+			{
+				for ( int i = count( gen ); i > 0; --i )
+				{
+					region r;
+					r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+					l->push_back( r );
+				}
+			}
+			checkQueries( la, lb );
+			checkQueries( lb, la );
+			// b inside a, and the same coverage split differently
+			checkQueries( la | lb, lb );
+			checkQueries( la | lb, ( la ^ lb ) | ( la & lb ) );
+		}
+	}
+
+	// nothing is built, so once the sweep buffers have grown
+	// the queries don't allocate
+	std::uniform_int_distribution<int> pos( 0, 500 );
+	region_list big, small;
+	for ( int i = 0; i < 200; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		( i % 4 ? big : small ).push_back( r );
+	}
+	for ( int round = 0; round < 3; ++round )
+	{
+		size_t before = theAllocations;
+		double total = intersection_area( big, small );
+		bool any = any_overlap( big, small ) || covers( big, small ) || equal_coverage( big, small );
+		if ( round > 0 && theAllocations != before )
+			throw std::runtime_error( "region queries allocated" );
+		if ( total != area( big & small ) || ! any )
+			throw std::runtime_error( "region queries failed on reused buffers" );
+	}
+	return 0;
+}
+
+static int
+testSmallLists( void )
+{
+	const region a( 0, 9, 0, 9 ), b( 5, 14, 3, 12 ), c( 20, 30, 20, 30 );
+	const region_list ab{ a, b };
+
+	// first pass sets up the per thread sweep buffers
+	for ( int round = 0; round < 2; ++round )
+	{
+		size_t before = theAllocations;
+		size_t inline_results = 0, results = 0;
+		auto use = [&]( const region_list &l ) { ++results; if ( l.is_inline() ) ++inline_results; };
+		use( a & b );
+		use( a & c );
+		use( a | b );
+		use( a | c );
+		use( a ^ b );
+		use( ~a );
+		use( ab & c );
+		use( ab & a );
+		use( not_in( a, ab ) );
+		use( ab | b );
+		if ( round > 0 && theAllocations != before )
+			throw std::runtime_error( "operators on short lists allocated" );
+		if ( inline_results != results )
+			throw std::runtime_error( "short region list was not stored inline" );
+	}
+	if ( ( a & b ) != region_list{ region( 5, 9, 3, 9 ) } || ! ( a & c ).empty() ||
+		 ( a | c ) != ( region_list{ c, a } | region_list() ) )
+		throw std::runtime_error( "operators on short lists are wrong" );
+
+	// callers written against the old std::vector region_list
+	std::vector<region> old = a | b;
+	region_list fromOld = old;
+	if ( old.size() != ( a | b ).size() || fromOld != ( a | b ) )
+		throw std::runtime_error( "std::vector conversion of region_list" );
+	return 0;
+}
+
+////////////////////////////////////////
+
+
 int
 main( int /*argc*/, char */*argv*/[] )
 {
@@ -193,6 +623,13 @@ main( int /*argc*/, char */*argv*/[] )
 		retval += testIntersectRegion();
 		retval += testUnionRegion();
 		retval += testXORRegion();
+		retval += testCanonicalize();
+		retval += testCombine();
+		retval += testParallel();
+		retval += testCoordinateTypes();
+		retval += testInto();
+		retval += testQueries();
+		retval += testSmallLists();
 	}
 	catch ( std::exception &e )
 	{
@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/region_codec.h>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename T>
+region_list_t<T>
+roundTrip( const region_list_t<T> &l, std::vector<uint8_t> &buf )
+{
+	buf.clear();
+	encode_regions( buf, l );
+
+	region_list_t<T> viaIter;
+	region_decoder_t<T> dec( buf );
+	for ( const auto &r: dec )
+		viaIter.push_back( r );
+	if ( viaIter.size() != dec.size() )
+		throw std::runtime_error( "decoder size does not match its regions" );
+
+	region_list_t<T> retval;
+	decode_regions( retval, buf.data(), buf.size() );
+	if ( retval != viaIter )
+		throw std::runtime_error( "decode_regions does not match the decoder" );
+
+	region_list_t<T> canon = l;
+	canonicalize( canon );
+	if ( retval != canon )
+		throw std::runtime_error( "decoded list is not the canonical input" );
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testFormat( void )
+{
+	std::vector<uint8_t> buf;
+	roundTrip( region_list(), buf );
+	if ( buf != std::vector<uint8_t>{ 0 } )
+		throw std::runtime_error( "empty list encoding is wrong" );
+
+	// two bands, the first with two runs
+	region_list l{ region( 10, 19, 5, 6 ), region( 0, 3, 5, 6 ), region( 2, 4, 7, 7 ) };
+	roundTrip( l, buf );
+	const std::vector<uint8_t> expect{
+		3,
+		10, 1, 2, 0, 3, 7, 9,
+		2, 0, 1, 4, 2 };
+	if ( buf != expect )
+		throw std::runtime_error( "encoding is wrong" );
+
+	// negative coordinates and the infinite extents
+	roundTrip( region_list{ region( -1000, -900, -70000, -5 ) }, buf );
+	roundTrip( region_list{ region( region::inf ) }, buf );
+	roundTrip( region_list{ region( region::inf ), region( 0, 5, 0, 5 ) }, buf );
+	roundTrip( region64_list{ region64( region64::inf ) }, buf );
+	roundTrip( region64_list{ region64( -( int64_t( 1 ) << 50 ), int64_t( 1 ) << 52, 3, 4 ) }, buf );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testRandom( void )
+{
+	std::mt19937 gen( 42 );
+	std::uniform_int_distribution<int> pos( -500, 1500 );
+	std::uniform_int_distribution<int> sz( 1, 120 );
+	std::uniform_int_distribution<int> count( 0, 300 );
+
+	std::vector<uint8_t> buf;
+	size_t binary = 0, text = 0;
+	for ( int iter = 0; iter < 200; ++iter )
+	{
+		region_list l;
+		for ( int i = count( gen ); i > 0; --i )
+		{
+			region r;
+			r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+			l.push_back( r );
+		}
+		region_list canon = roundTrip( l, buf );
+
+		std::ostringstream str;
+		str << canon;
+		binary += buf.size();
+		text += str.str().size();
+	}
+	if ( binary * 4 > text )
+		throw std::runtime_error( "binary encoding is not much smaller than text" );
+	std::cout << "binary " << binary << " bytes, text " << text << " bytes" << std::endl;
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testMalformed( void )
+{
+	region_list l;
+	for ( int i = 0; i < 50; ++i )
+		l.push_back( region( i * 10, i * 10 + 5, i * 3, i * 3 + 40 ) );
+	std::vector<uint8_t> buf;
+	encode_regions( buf, l );
+
+	region_list out;
+	for ( size_t n = 0; n < buf.size(); ++n )
+	{
+		bool threw = false;
+		try
+		{
+			decode_regions( out, buf.data(), n );
+		}
+		catch ( std::runtime_error & )
+		{
+			threw = true;
+		}
+		if ( ! threw )
+			throw std::runtime_error( "truncated buffer was accepted" );
+	}
+
+	buf.push_back( 0 );
+	bool threw = false;
+	try
+	{
+		decode_regions( out, buf.data(), buf.size() );
+	}
+	catch ( std::runtime_error & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "trailing data was accepted" );
+
+	// a band with no runs
+	const std::vector<uint8_t> empty_band{ 1, 0, 0, 0, 0, 0 };
+	threw = false;
+	try
+	{
+		decode_regions( out, empty_band.data(), empty_band.size() );
+	}
+	catch ( std::runtime_error & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "empty band was accepted" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testFormat();
+		retval += testRandom();
+		retval += testMalformed();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
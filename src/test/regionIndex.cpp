@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_index.h>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+double
+distance_sq( const region &r, int x, int y )
+{
+	double dx = std::max( 0.0, std::max( double(r.left()) - x, x - double(r.right()) ) );
+	double dy = std::max( 0.0, std::max( double(r.bottom()) - y, y - double(r.top()) ) );
+	return dx * dx + dy * dy;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testQueries( void )
+{
+	std::mt19937 gen( 17 );
+	std::uniform_int_distribution<int> pos( -500, 500 );
+	std::uniform_int_distribution<int> sz( -2, 60 );
+
+	for ( size_t n: { 0, 1, 2, 15, 16, 17, 255, 256, 257, 3000 } )
+	{
+		for ( size_t node: { 2, 4, 16 } )
+		{
+			region_list l;
+			for ( size_t i = 0; i != n; ++i )
+			{
+				region r;
+				r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+				l.push_back( r );
+			}
+			if ( n == 257 )
+				l.push_back( region( region::inf ) );
+			region_index idx( l, node );
+
+			size_t nonempty = 0;
+			for ( auto &r: l )
+				nonempty += r.empty() ? 0 : 1;
+			if ( idx.size() != nonempty )
+				throw std::runtime_error( "region_index size is wrong" );
+
+			for ( int k = 0; k < 50; ++k )
+			{
+				region q;
+				q.reset_by_size( pos( gen ), pos( gen ), sz( gen ) * 3, sz( gen ) * 3 );
+				int x = pos( gen ), y = pos( gen );
+
+				std::vector<uint32_t> expect, expectPt, got;
+				for ( size_t i = 0; i != l.size(); ++i )
+				{
+					if ( l[i].empty() )
+						continue;
+					if ( l[i].intersects( q ) )
+						expect.push_back( uint32_t( i ) );
+					if ( l[i].contains( x, y ) )
+						expectPt.push_back( uint32_t( i ) );
+				}
+
+				idx.query( q, got );
+				std::sort( got.begin(), got.end() );
+				if ( got != expect )
+					throw std::runtime_error( "region_index rect query does not match scan" );
+				if ( idx.any( q ) != ! expect.empty() )
+					throw std::runtime_error( "region_index any does not match scan" );
+
+				idx.query( x, y, got );
+				std::sort( got.begin(), got.end() );
+				if ( got != expectPt )
+					throw std::runtime_error( "region_index point query does not match scan" );
+
+				idx.query( q, got, 3 );
+				if ( got.size() != std::min( size_t(3), expect.size() ) )
+					throw std::runtime_error( "region_index limited query returned wrong count" );
+				for ( uint32_t i: got )
+					if ( ! l[i].intersects( q ) )
+						throw std::runtime_error( "region_index limited query returned a miss" );
+
+				// nearest: distances must match the k smallest of a scan
+				std::vector<double> dists;
+				for ( auto &r: l )
+					if ( ! r.empty() )
+						dists.push_back( distance_sq( r, x, y ) );
+				std::sort( dists.begin(), dists.end() );
+				size_t want = std::min( size_t(5), dists.size() );
+				idx.nearest( x, y, 5, got );
+				if ( got.size() != want )
+					throw std::runtime_error( "region_index nearest returned wrong count" );
+				for ( size_t i = 0; i != want; ++i )
+				{
+					if ( distance_sq( l[got[i]], x, y ) != dists[i] )
+						throw std::runtime_error( "region_index nearest is not ordered by distance" );
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testQueries();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region.h>
+#include <math/banded_region.h>
+#include <limits>
+#include <random>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+// pixels of [lo, hi] x [lo, hi] are compared exactly, plus a few
+// points far outside to check infinite results
+const int lo = -4;
+const int hi = 67;
+const int W = hi - lo + 1;
+
+typedef std::vector<char> pixel_set;
+
+pixel_set
+pixels( const region_list &l )
+{
+	pixel_set retval( W * W, 0 );
+	for ( const region &r: l )
+	{
+		for ( int y = std::max( lo, r.bottom() ); y <= std::min( hi, r.top() ); ++y )
+			for ( int x = std::max( lo, r.left() ); x <= std::min( hi, r.right() ); ++x )
+				retval[size_t( ( y - lo ) * W + ( x - lo ) )] = 1;
+	}
+	return retval;
+}
+
+bool
+covers( const region_list &l, int x, int y )
+{
+	for ( const region &r: l )
+		if ( r.contains( x, y ) )
+			return true;
+	return false;
+}
+
+const int far_points[] = { std::numeric_limits<int>::min(), -1000000, 1000000, std::numeric_limits<int>::max() };
+
+void
+check( const region_list &got, const region_list &a, const region_list &b,
+	   const std::function<bool ( bool, bool )> &pred,
+	   const std::string &what )
+{
+	pixel_set pa = pixels( a ), pb = pixels( b ), pg = pixels( got );
+	for ( size_t i = 0; i != pg.size(); ++i )
+	{
+		if ( bool( pg[i] ) != pred( pa[i], pb[i] ) )
+		{
+			std::cout << what << " wrong at pixel (" << int( i % W ) + lo << ", " << int( i / W ) + lo
+					  << ")\n  a: " << a << "\n  b: " << b << "\n  got: " << got << std::endl;
+			throw std::runtime_error( "result does not match the pixel oracle" );
+		}
+	}
+	for ( int x: far_points )
+	{
+		for ( int y: far_points )
+		{
+			if ( covers( got, x, y ) != pred( covers( a, x, y ), covers( b, x, y ) ) )
+				throw std::runtime_error( what + " wrong far from the origin" );
+		}
+	}
+}
+
+/// the canonical form invariants, see canonicalize
+void
+check_banded( const region_list &l, const std::string &what )
+{
+	for ( size_t i = 1; i < l.size(); ++i )
+	{
+		const region &p = l[i - 1], &c = l[i];
+		bool ok = ( p.bottom() == c.bottom() && p.top() == c.top() && int64_t( p.right() ) + 1 < c.left() ) ||
+			p.top() < c.bottom();
+		if ( ! ok )
+			throw std::runtime_error( what + " is not banded" );
+	}
+}
+
+
+////////////////////////////////////////
+
+
+typedef region_list (*generator)( std::mt19937 &, size_t );
+
+region_list
+random_gen( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( -2, 60 );
+	std::uniform_int_distribution<int> sz( 1, 20 );
+	region_list retval;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+region_list
+grid_gen( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( 0, 7 );
+	std::uniform_int_distribution<int> sz( 1, 3 );
+	region_list retval;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ) * 8, pos( gen ) * 8, sz( gen ) * 8, sz( gen ) * 8 );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+region_list
+overlap_gen( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( 0, 16 );
+	std::uniform_int_distribution<int> sz( 24, 48 );
+	region_list retval;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+region_list
+sliver_gen( std::mt19937 &gen, size_t n )
+{
+	std::uniform_int_distribution<int> pos( 0, 63 );
+	std::uniform_int_distribution<int> len( 2, 40 );
+	region_list retval;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		region r;
+		if ( i & 1 )
+			r.reset_by_size( pos( gen ), pos( gen ), 1, len( gen ) );
+		else
+			r.reset_by_size( pos( gen ), pos( gen ), len( gen ), 1 );
+		retval.push_back( r );
+	}
+	return retval;
+}
+
+/// random inputs, with the occasional empty, degenerate or
+/// (half) infinite region thrown in
+region_list
+make( std::mt19937 &gen, generator g, size_t n )
+{
+	region_list retval = g( gen, n );
+	std::uniform_int_distribution<int> pick( 0, 15 );
+	switch ( pick( gen ) )
+	{
+		case 0: retval.push_back( region( region::inf ) ); break;
+		case 1: retval.push_back( region( 10, 20, std::numeric_limits<int>::min(), 5 ) ); break;
+		case 2: retval.push_back( region( 30, std::numeric_limits<int>::max(), 3, 9 ) ); break;
+		case 3: retval.push_back( region() ); break;
+		case 4: retval.push_back( region( 5, 5, 5, 5 ) ); break;
+		default: break;
+	}
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testOracle( void )
+{
+	const generator gens[] = { random_gen, grid_gen, overlap_gen, sliver_gen };
+	auto And = []( bool a, bool b ) { return a && b; };
+	auto Or = []( bool a, bool b ) { return a || b; };
+	auto Xor = []( bool a, bool b ) { return a != b; };
+	auto NotIn = []( bool a, bool b ) { return a && ! b; };
+	auto A = []( bool a, bool ) { return a; };
+	auto NotA = []( bool a, bool ) { return ! a; };
+
+	std::mt19937 gen( 2012 );
+	for ( generator g: gens )
+	{
+		for ( int iter = 0; iter < 60; ++iter )
+		{
+			size_t n = size_t( iter % 20 );
+			region_list a = make( gen, g, n );
+			region_list b = make( gen, g, n / 2 + 1 );
+			const region &ra = a.empty() ? region() : a.front();
+			region_list la{ ra };
+			const region &rb = b.front();
+			region_list lb{ rb };
+
+			check( a & b, a, b, And, "list & list" );
+			check( a | b, a, b, Or, "list | list" );
+			check( a ^ b, a, b, Xor, "list ^ list" );
+			check( not_in( a, b ), a, b, NotIn, "not_in( list, list )" );
+			check( ~a, a, b, NotA, "~list" );
+
+			check( a & rb, a, lb, And, "list & region" );
+			check( rb & a, lb, a, And, "region & list" );
+			check( a | rb, a, lb, Or, "list | region" );
+			check( rb | a, lb, a, Or, "region | list" );
+			check( a ^ rb, a, lb, Xor, "list ^ region" );
+			check( rb ^ a, lb, a, Xor, "region ^ list" );
+			check( not_in( a, rb ), a, lb, NotIn, "not_in( list, region )" );
+			check( not_in( rb, a ), lb, a, NotIn, "not_in( region, list )" );
+
+			check( ra & rb, la, lb, And, "region & region" );
+			check( ra | rb, la, lb, Or, "region | region" );
+			check( ra ^ rb, la, lb, Xor, "region ^ region" );
+			check( ~rb, lb, a, NotA, "~region" );
+
+			region_list m = a;
+			sort_and_merge( m );
+			check( m, a, b, A, "sort_and_merge" );
+			check_banded( m, "sort_and_merge" );
+			check_banded( a | b, "list | list" );
+
+			check( parallel_and( a, b, 3 ), a, b, And, "parallel_and" );
+			check( parallel_or( a, b, 3 ), a, b, Or, "parallel_or" );
+			check( parallel_xor( a, b, 3 ), a, b, Xor, "parallel_xor" );
+			check( parallel_not_in( a, b, 3 ), a, b, NotIn, "parallel_not_in" );
+
+			banded_region ba( a ), bb( b );
+			check( ( ba & bb ).rects(), a, b, And, "banded &" );
+			check( ( ba | bb ).rects(), a, b, Or, "banded |" );
+			check( ( ba ^ bb ).rects(), a, b, Xor, "banded ^" );
+			check( not_in( ba, bb ).rects(), a, b, NotIn, "banded not_in" );
+			check( ( ~ba ).rects(), a, b, NotA, "banded ~" );
+
+			auto twice = []( int ca, int cb ) { return ( ca + cb ) >= 2; };
+			region_list c = region_combine( a, b, twice );
+			for ( int y = lo; y <= hi; ++y )
+			{
+				for ( int x = lo; x <= hi; ++x )
+				{
+					int ca = 0, cb = 0;
+					for ( const region &r: a )
+						ca += r.contains( x, y ) ? 1 : 0;
+					for ( const region &r: b )
+						cb += r.contains( x, y ) ? 1 : 0;
+					if ( covers( c, x, y ) != twice( ca, cb ) )
+						throw std::runtime_error( "region_combine does not match the pixel oracle" );
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testOracle();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
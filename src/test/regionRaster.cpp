@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_raster.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+bool
+covered( const region_list &l, int x, int y )
+{
+	for ( auto &r: l )
+		if ( r.contains( x, y ) )
+			return true;
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testRaster( void )
+{
+	std::mt19937 gen( 3 );
+	std::uniform_int_distribution<int> pos( -40, 260 );
+	std::uniform_int_distribution<int> sz( 0, 90 );
+	std::uniform_int_distribution<int> wsz( 1, 200 );
+
+	for ( int iter = 0; iter < 200; ++iter )
+	{
+		region_list l;
+		size_t n = size_t( iter % 17 );
+		for ( size_t i = 0; i != n; ++i )
+		{
+			region r;
+			r.reset_by_size( pos( gen ), pos( gen ) / 4, sz( gen ), sz( gen ) / 4 );
+			l.push_back( r );
+		}
+		if ( iter == 50 )
+			l.push_back( region( region::inf ) );
+		region clip;
+		clip.reset_by_size( pos( gen ) / 2, pos( gen ) / 8, wsz( gen ), wsz( gen ) / 4 );
+
+		// spans: iterator and for_each agree, and match the pixels
+		region_spans spans( l, clip );
+		std::vector<coverage_span> viaIter( spans.begin(), spans.end() ), viaFunc;
+		spans.for_each( [&]( int y, int x0, int x1 ) { viaFunc.push_back( coverage_span{ y, x0, x1 } ); } );
+		if ( viaIter != viaFunc )
+			throw std::runtime_error( "span iterator and for_each disagree" );
+
+		size_t pixels = 0;
+		for ( size_t i = 0; i != viaIter.size(); ++i )
+		{
+			const coverage_span &s = viaIter[i];
+			if ( s.x0 >= s.x1 )
+				throw std::runtime_error( "empty span" );
+			if ( i > 0 && viaIter[i - 1].y == s.y && viaIter[i - 1].x1 >= s.x0 )
+				throw std::runtime_error( "spans overlap or touch" );
+			if ( i > 0 && viaIter[i - 1].y > s.y )
+				throw std::runtime_error( "spans out of order" );
+			for ( int x = s.x0; x < s.x1; ++x )
+				if ( ! clip.contains( x, s.y ) || ! covered( l, x, s.y ) )
+					throw std::runtime_error( "span covers an empty pixel" );
+			pixels += size_t( s.x1 - s.x0 );
+		}
+
+		coverage_mask mask( l, clip );
+		size_t expect = 0;
+		for ( int y = clip.bottom(); y <= clip.top(); ++y )
+		{
+			for ( int x = clip.left(); x <= clip.right(); ++x )
+			{
+				bool c = covered( l, x, y );
+				expect += c ? 1 : 0;
+				if ( mask.test( x, y ) != c )
+					throw std::runtime_error( "mask does not match the regions" );
+			}
+		}
+		if ( pixels != expect || mask.count() != expect )
+			throw std::runtime_error( "pixel counts disagree" );
+
+		// round trips
+		region_list banded = spans.bands();
+		if ( mask.to_list() != banded )
+			throw std::runtime_error( "mask to list is not the banded clip" );
+		coverage_rle rle( l, clip ), rleMask( mask );
+		if ( rle != rleMask )
+			throw std::runtime_error( "run length encodings disagree" );
+		if ( rle.to_mask() != mask || rle.to_list() != banded )
+			throw std::runtime_error( "run length decoding is wrong" );
+		size_t runs = 0;
+		for ( int y = clip.bottom(); y <= clip.top(); ++y )
+			runs += size_t( rle.row_end( y ) - rle.row_begin( y ) );
+		if ( runs != rle.run_count() || runs != viaIter.size() )
+			throw std::runtime_error( "run count is wrong" );
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testRaster();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_soa.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename Scalar>
+void
+check( const region_list &l, const std::vector<uint64_t> &mask,
+	   const std::vector<uint32_t> &idx, size_t count,
+	   const Scalar &scalar, const char *what )
+{
+	size_t expect = 0;
+	size_t next = 0;
+	for ( size_t i = 0; i != l.size(); ++i )
+	{
+		bool m = ( mask[i / 64] >> ( i % 64 ) ) & 1;
+		if ( m != scalar( l[i] ) )
+		{
+			std::cout << what << ": entry " << i << " " << l[i] << std::endl;
+			throw std::runtime_error( "SoA mask does not match scalar test" );
+		}
+		if ( m )
+		{
+			++expect;
+			if ( next >= idx.size() || idx[next] != i )
+				throw std::runtime_error( "SoA index list does not match mask" );
+			++next;
+		}
+	}
+	if ( count != expect || idx.size() != expect )
+		throw std::runtime_error( "SoA match count is wrong" );
+}
+
+
+////////////////////////////////////////
+
+
+int
+testQueries( void )
+{
+	std::mt19937 gen( 99 );
+	std::uniform_int_distribution<int> pos( -50, 50 );
+	std::uniform_int_distribution<int> sz( 0, 30 );
+
+	// exercise every tail length for the 4 and 8 wide kernels
+	for ( size_t n = 0; n < 80; ++n )
+	{
+		region_list l;
+		for ( size_t i = 0; i != n; ++i )
+		{
+			region r;
+			r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+			l.push_back( r );
+		}
+		if ( n == 40 )
+			l.push_back( region( region::inf ) );
+		region_soa s( l );
+
+		for ( int k = 0; k < 10; ++k )
+		{
+			region q;
+			q.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+			int x = pos( gen ), y = pos( gen );
+
+			std::vector<uint64_t> mask;
+			std::vector<uint32_t> idx;
+			size_t c;
+
+			c = s.intersects( q, mask );
+			s.intersects( q, idx );
+			check( l, mask, idx, c, [&]( const region &r ) { return r.intersects( q ); }, "intersects" );
+
+			c = s.inside( q, mask );
+			s.inside( q, idx );
+			check( l, mask, idx, c, [&]( const region &r ) { return r.inside( q ); }, "inside" );
+
+			c = s.contains( q, mask );
+			s.contains( q, idx );
+			check( l, mask, idx, c, [&]( const region &r ) { return q.inside( r ); }, "contains" );
+
+			c = s.contains( x, y, mask );
+			s.contains( x, y, idx );
+			check( l, mask, idx, c, [&]( const region &r ) { return r.contains( x, y ); }, "contains point" );
+		}
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		std::cout << "region_soa kernel: " << region_soa::kernel_name() << std::endl;
+		retval += testQueries();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
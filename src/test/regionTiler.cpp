@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <math/region_tiler.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+bool
+covered( const region_list &l, int x, int y )
+{
+	for ( auto &r: l )
+		if ( r.contains( x, y ) )
+			return true;
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testTiles( void )
+{
+	std::mt19937 gen( 11 );
+	std::uniform_int_distribution<int> pos( -150, 150 );
+	std::uniform_int_distribution<int> sz( 0, 120 );
+
+	for ( int iter = 0; iter < 40; ++iter )
+	{
+		region_list l;
+		for ( int i = 0; i < iter % 13; ++i )
+		{
+			region r;
+			r.reset_by_size( pos( gen ), pos( gen ), sz( gen ), sz( gen ) );
+			l.push_back( r );
+		}
+		region clip( -100 - iter, 130, -90, 110 + iter );
+		int tw = 16 + iter % 3 * 24, th = 8 + iter % 5 * 8;
+		region_tiler tiler( l, clip, tw, th );
+
+		int w = clip.size_x(), h = clip.size_y();
+		std::unique_ptr<std::atomic<int>[]> hits( new std::atomic<int>[size_t( w * h )] );
+		for ( int i = 0; i < w * h; ++i )
+			hits[i] = 0;
+
+		uint64_t total = 0;
+		for ( size_t i = 0; i != tiler.size(); ++i )
+		{
+			const region_tile &t = tiler[i];
+			if ( i > 0 && ( tiler[i - 1].ty > t.ty || ( tiler[i - 1].ty == t.ty && tiler[i - 1].tx >= t.tx ) ) )
+				throw std::runtime_error( "tiles out of order" );
+			if ( ! t.bounds.inside( clip ) || t.covered == 0 )
+				throw std::runtime_error( "bad tile" );
+			uint64_t c = 0;
+			for ( const region *r = tiler.rects_begin( t ); r != tiler.rects_end( t ); ++r )
+			{
+				if ( ! r->inside( t.bounds ) )
+					throw std::runtime_error( "tile rect outside its tile" );
+				if ( t.bounds.left() != std::max( clip.left(), t.tx * tw ) ||
+					 t.bounds.bottom() != std::max( clip.bottom(), t.ty * th ) )
+					throw std::runtime_error( "tile is not aligned" );
+				c += uint64_t( r->size_x() ) * uint64_t( r->size_y() );
+			}
+			if ( c != t.covered )
+				throw std::runtime_error( "tile coverage is wrong" );
+			total += c;
+		}
+		if ( total != tiler.covered() )
+			throw std::runtime_error( "total coverage is wrong" );
+
+		tiler.for_each_span( [&]( int y, int x0, int x1 )
+							 {
+								 for ( int x = x0; x < x1; ++x )
+									 ++hits[( y - clip.bottom() ) * w + ( x - clip.left() )];
+							 }, 4 );
+
+		uint64_t expect = 0;
+		for ( int y = clip.bottom(); y <= clip.top(); ++y )
+		{
+			for ( int x = clip.left(); x <= clip.right(); ++x )
+			{
+				int want = covered( l, x, y ) ? 1 : 0;
+				expect += uint64_t( want );
+				if ( hits[( y - clip.bottom() ) * w + ( x - clip.left() )] != want )
+					throw std::runtime_error( "spans do not cover each pixel exactly once" );
+			}
+		}
+		if ( expect != total )
+			throw std::runtime_error( "coverage does not match the regions" );
+
+		std::atomic<size_t> ntiles( 0 );
+		tiler.for_each_tile( [&]( const region_tile &, const region *, const region * ) { ++ntiles; }, 3 );
+		if ( ntiles != tiler.size() )
+			throw std::runtime_error( "for_each_tile skipped tiles" );
+	}
+
+	region_tiler full( region_list{ region( 0, 127, 0, 63 ) }, region( 0, 127, 0, 63 ), 64, 64 );
+	if ( full.size() != 2 || ! full[0].full() || ! full[1].full() )
+		throw std::runtime_error( "full tiles not detected" );
+
+	bool caught = false;
+	try
+	{
+		full.for_each_tile( []( const region_tile &t, const region *, const region * )
+							{
+								if ( t.tx == 1 )
+									throw std::runtime_error( "expected" );
+							}, 2 );
+	}
+	catch ( std::runtime_error & )
+	{
+		caught = true;
+	}
+	if ( ! caught )
+		throw std::runtime_error( "worker exception was not propagated" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testTiles();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <small_vector.h>
+#include <random>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+typedef yaco::small_vector<int, 4> small;
+
+void
+check( const small &s, const std::vector<int> &v, const char *what )
+{
+	if ( s.size() != v.size() || ! std::equal( v.begin(), v.end(), s.begin() ) )
+		throw std::runtime_error( what );
+	if ( s.capacity() < s.size() || s.is_inline() != ( s.capacity() == small::inline_capacity ) )
+		throw std::runtime_error( what );
+}
+
+
+////////////////////////////////////////
+
+
+int
+testInline( void )
+{
+	small s;
+	if ( ! s.empty() || ! s.is_inline() || s.capacity() != 4 )
+		throw std::runtime_error( "default small_vector is wrong" );
+
+	s.push_back( 1 );
+	s.push_back( 2 );
+	s.insert( s.begin(), 0 );
+	s.emplace_back( 3 );
+	check( s, { 0, 1, 2, 3 }, "inline push_back / insert" );
+	if ( ! s.is_inline() )
+		throw std::runtime_error( "small_vector allocated before it was full" );
+
+	s.push_back( 4 );
+	check( s, { 0, 1, 2, 3, 4 }, "push_back past the inline capacity" );
+	if ( s.is_inline() )
+		throw std::runtime_error( "small_vector did not grow" );
+
+	s.erase( s.begin() + 1, s.begin() + 4 );
+	check( s, { 0, 4 }, "erase" );
+	s.shrink_to_fit();
+	check( s, { 0, 4 }, "shrink_to_fit" );
+	if ( ! s.is_inline() )
+		throw std::runtime_error( "shrink_to_fit did not move back inline" );
+
+	// pushing one of our own elements while growing
+	s = { 1, 2, 3, 4 };
+	s.push_back( s[0] );
+	check( s, { 1, 2, 3, 4, 1 }, "push_back of an element" );
+	s.insert( s.begin() + 1, s.begin(), s.end() );
+	check( s, { 1, 1, 2, 3, 4, 1, 2, 3, 4, 1 }, "insert of own range" );
+
+	s.resize( 2 );
+	s.resize( 4, 7 );
+	check( s, { 1, 1, 7, 7 }, "resize" );
+	s.assign( 3, 9 );
+	check( s, { 9, 9, 9 }, "assign" );
+	std::vector<int> v{ 5, 6, 7, 8, 9, 10 };
+	s.assign( v.begin(), v.end() );
+	check( s, v, "assign from iterators" );
+	s.insert( s.end(), v.rbegin(), v.rend() );
+	check( s, { 5, 6, 7, 8, 9, 10, 10, 9, 8, 7, 6, 5 }, "insert from iterators" );
+
+	bool threw = false;
+	try
+	{
+		s.at( s.size() );
+	}
+	catch ( std::out_of_range & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "at past the end did not throw" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testCopyMove( void )
+{
+	for ( size_t n: { 0, 3, 4, 9 } )
+	{
+		std::vector<int> v;
+		for ( size_t i = 0; i < n; ++i )
+			v.push_back( int( i * 3 ) );
+
+		small a( v.begin(), v.end() );
+		small b( a );
+		check( b, v, "copy" );
+		small c( std::move( b ) );
+		check( c, v, "move" );
+		check( b, {}, "moved from" );
+
+		b = c;
+		check( b, v, "copy assignment" );
+		small d{ 42 };
+		d = std::move( c );
+		check( d, v, "move assignment" );
+		const small &self = d;
+		d = self;
+		check( d, v, "self assignment" );
+
+		small e{ 1, 2, 3, 4, 5, 6 };
+		swap( d, e );
+		check( e, v, "swap" );
+		check( d, { 1, 2, 3, 4, 5, 6 }, "swap" );
+		if ( ! ( a == e ) || a != e || a == d )
+			throw std::runtime_error( "comparison" );
+	}
+	if ( ! ( small{ 1, 2 } < small{ 1, 3 } ) || small{ 1, 3 } < small{ 1, 2 } || ! ( small{ 1 } < small{ 1, 0 } ) )
+		throw std::runtime_error( "ordering" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testVectorConversion( void )
+{
+	for ( size_t n: { 0, 4, 9 } )
+	{
+		std::vector<int> v;
+		for ( size_t i = 0; i < n; ++i )
+			v.push_back( int( i * 5 ) );
+
+		small s = v;
+		check( s, v, "from std::vector" );
+		std::vector<int> back = s;
+		if ( back != v )
+			throw std::runtime_error( "to std::vector" );
+		back.clear();
+		back = s;
+		if ( back != v )
+			throw std::runtime_error( "assign to std::vector" );
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testRandom( void )
+{
+	std::mt19937 gen( 5 );
+	std::uniform_int_distribution<int> op( 0, 5 );
+	std::uniform_int_distribution<int> val( -100, 100 );
+
+	small s;
+	std::vector<int> v;
+	for ( int iter = 0; iter < 20000; ++iter )
+	{
+		size_t pos = v.empty() ? 0 : size_t( gen() % ( v.size() + 1 ) );
+		int x = val( gen );
+		switch ( op( gen ) )
+		{
+			case 0:
+			case 1:
+				s.push_back( x );
+				v.push_back( x );
+				break;
+			case 2:
+				s.insert( s.begin() + pos, x );
+				v.insert( v.begin() + static_cast<std::ptrdiff_t>( pos ), x );
+				break;
+			case 3:
+				s.insert( s.begin() + pos, size_t( 3 ), x );
+				v.insert( v.begin() + static_cast<std::ptrdiff_t>( pos ), size_t( 3 ), x );
+				break;
+			case 4:
+				if ( pos < v.size() )
+				{
+					s.erase( s.begin() + pos );
+					v.erase( v.begin() + static_cast<std::ptrdiff_t>( pos ) );
+				}
+				break;
+			case 5:
+				if ( v.size() > 40 || ( gen() % 8 ) == 0 )
+				{
+					s.resize( pos );
+					v.resize( pos );
+				}
+				break;
+		}
+		check( s, v, "random operations" );
+	}
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testInline();
+		retval += testCopyMove();
+		retval += testVectorConversion();
+		retval += testRandom();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
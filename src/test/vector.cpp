@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/vector.h>
+#include <random>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename T, size_t dim>
+vector<T, dim>
+randomVector( std::mt19937 &gen )
+{
+	std::uniform_real_distribution<double> val( -10.0, 10.0 );
+	vector<T, dim> r;
+	for ( size_t i = 0; i != dim; ++i )
+		r[i] = static_cast<T>( val( gen ) );
+	return r;
+}
+
+template <typename T>
+bool
+close( T a, T b )
+{
+	T tol = std::numeric_limits<T>::epsilon() * T( 256 ) * std::max( T( 1 ), std::max( std::abs( a ), std::abs( b ) ) );
+	return std::abs( a - b ) <= tol;
+}
+
+template <typename T, size_t dim>
+void
+checkClose( const vector<T, dim> &v, const T *expect, const char *what )
+{
+	for ( size_t i = 0; i != dim; ++i )
+		if ( ! close( v[i], expect[i] ) )
+			throw std::runtime_error( what );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T, size_t dim>
+int
+testArithmetic( void )
+{
+	typedef vector<T, dim> vec;
+	std::mt19937 gen( 7 + dim );
+	for ( int iter = 0; iter < 1000; ++iter )
+	{
+		vec a = randomVector<T, dim>( gen );
+		vec b = randomVector<T, dim>( gen );
+		vec c = randomVector<T, dim>( gen );
+		T s = a[0] + T( 11 );
+
+		T expect[dim];
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = a[i] * s + b[i] - c[i];
+		checkClose( vec( a * s + b - c ), expect, "a * s + b - c" );
+
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = ( a[i] + T( 2 ) ) * b[i] / s - T( 1 ) / s;
+		checkClose( vec( ( a + T( 2 ) ) * b / s - T( 1 ) / s ), expect, "element by element" );
+
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = -a[i] + T( 3 ) * ( b[i] - c[i] );
+		checkClose( vec( -a + T( 3 ) * ( b - c ) ), expect, "negate" );
+
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = a[i] + ( b[i] - a[i] ) * T( 0.25 );
+		checkClose( vec( lerp( a, b, T( 0.25 ) ) ), expect, "lerp" );
+
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = std::min( a[i], b[i] ) - std::max( b[i], c[i] );
+		checkClose( vec( min( a, b ) - max( b, c ) ), expect, "min / max" );
+
+		// the result aliasing an operand
+		vec d = a;
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = b[i] - a[i] * T( 2 );
+		d = b - d * T( 2 );
+		checkClose( d, expect, "aliased assignment" );
+
+		d = a;
+		d += b;
+		d *= s;
+		d -= c * T( 2 );
+		d /= T( 4 );
+		for ( size_t i = 0; i != dim; ++i )
+			expect[i] = ( ( a[i] + b[i] ) * s - c[i] * T( 2 ) ) / T( 4 );
+		checkClose( d, expect, "compound assignment" );
+
+		T dp = 0, mag = 0;
+		for ( size_t i = 0; i != dim; ++i )
+		{
+			dp += a[i] * b[i];
+			mag += a[i] * a[i];
+		}
+		if ( ! close( dot( a, b ), dp ) || ! close( a.dot( b ), dp ) ||
+			 ! close( a.mag_squared(), mag ) || ! close( magnitude( a ), std::sqrt( mag ) ) ||
+			 ! close( dot( a + b, c ), dot( a, c ) + dot( b, c ) ) )
+			throw std::runtime_error( "dot" );
+
+		vec n = normalize( a * T( 3 ) );
+		if ( ! close( n.magnitude(), T( 1 ) ) || ! close( dot( n, a ), a.magnitude() ) )
+			throw std::runtime_error( "normalize" );
+	}
+
+	vec z;
+	if ( z.normalize() != T( 0 ) || z != vec() )
+		throw std::runtime_error( "normalizing a zero vector" );
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+int
+testCross( void )
+{
+	typedef vector<T, 3> vec;
+	vec x{ 1, 0, 0 }, y{ 0, 1, 0 }, z{ 0, 0, 1 };
+	if ( vec( cross( x, y ) ) != z || vec( cross( y, z ) ) != x || vec( cross( z, x ) ) != y ||
+		 vec( cross( y, x ) ) != vec( -z ) )
+		throw std::runtime_error( "cross of the axes" );
+
+	std::mt19937 gen( 3 );
+	for ( int iter = 0; iter < 1000; ++iter )
+	{
+		vec a = randomVector<T, 3>( gen );
+		vec b = randomVector<T, 3>( gen );
+		T expect[3] = {
+			a[1] * b[2] - a[2] * b[1],
+			a[2] * b[0] - a[0] * b[2],
+			a[0] * b[1] - a[1] * b[0] };
+		vec c = cross( a, b );
+		checkClose( c, expect, "cross" );
+		if ( std::abs( dot( c, a ) ) > std::numeric_limits<T>::epsilon() * T( 16 ) * c.magnitude() * a.magnitude() )
+			throw std::runtime_error( "cross is not perpendicular" );
+		// an expression as an operand
+		checkClose( vec( cross( a * T( 1 ), b + vec() ) ), expect, "cross of expressions" );
+	}
+	return 0;
+}
+
+
+////////////////////////////////////////
+
+
+int
+testBasics( void )
+{
+	fvec3 a{ 1, 2 };
+	if ( a[0] != 1 || a[1] != 2 || a[2] != 0 || a.at( 2 ) != 0 )
+		throw std::runtime_error( "initializer list" );
+	bool threw = false;
+	try
+	{
+		a.at( 3 );
+	}
+	catch ( std::out_of_range & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "at past the end" );
+
+	vec3 b( a );
+	if ( b[0] != 1.0 || b[1] != 2.0 || b[2] != 0.0 )
+		throw std::runtime_error( "conversion" );
+
+	if ( sizeof(fvec3) != 16 || sizeof(fvec4) != 16 || sizeof(vec2) != 16 ||
+		 alignof(fvec4) < 8 )
+		throw std::runtime_error( "vector layout" );
+	return 0;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testBasics();
+		retval += testArithmetic<float, 2>();
+		retval += testArithmetic<float, 3>();
+		retval += testArithmetic<float, 4>();
+		retval += testArithmetic<double, 2>();
+		retval += testArithmetic<double, 3>();
+		retval += testArithmetic<double, 4>();
+		retval += testArithmetic<long double, 3>();
+		retval += testArithmetic<float, 5>();
+		retval += testCross<float>();
+		retval += testCross<double>();
+		retval += testCross<long double>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
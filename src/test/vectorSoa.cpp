@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+
+#include <math/vector_soa.h>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <iostream>
+
+
+////////////////////////////////////////
+
+
+using namespace yaco::math;
+
+namespace
+{
+
+template <typename T>
+vector_soa<T, 3>
+randomPoints( std::mt19937 &gen, size_t n )
+{
+	std::uniform_real_distribution<double> val( -100.0, 100.0 );
+	vector_soa<T, 3> r;
+	r.reserve( n );
+	for ( size_t i = 0; i != n; ++i )
+		r.push_back( vector<T, 3>{ static_cast<T>( val( gen ) ), static_cast<T>( val( gen ) ), static_cast<T>( val( gen ) ) } );
+	return r;
+}
+
+template <typename T>
+square_matrix<T, 4>
+affine( void )
+{
+	return square_matrix<T, 4>{
+		T( 0.8 ), T( -0.6 ), T( 0 ), T( 12.5 ),
+		T( 0.3 ), T( 0.4 ), T( 1.5 ), T( -3 ),
+		T( 0.1 ), T( 0.9 ), T( 0.2 ), T( 7 ),
+		T( 0 ), T( 0 ), T( 0 ), T( 1 ) };
+}
+
+template <typename T>
+square_matrix<T, 4>
+perspective( void )
+{
+	// a typical projection times a camera transform
+	square_matrix<T, 4> p{
+		T( 1.5 ), T( 0 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 2 ), T( 0 ), T( 0 ),
+		T( 0 ), T( 0 ), T( -1.002 ), T( -0.2002 ),
+		T( 0 ), T( 0 ), T( -1 ), T( 0 ) };
+	square_matrix<T, 4> cam = affine<T>();
+	cam( 2, 3 ) = T( -400 );
+	return p * cam;
+}
+
+template <typename T>
+bool
+close( T a, T b )
+{
+	T tol = std::numeric_limits<T>::epsilon() * T( 64 ) * std::max( T( 1 ), std::max( std::abs( a ), std::abs( b ) ) );
+	return std::abs( a - b ) <= tol;
+}
+
+// the batch kernels and the single vector functions are inlined
+// separately, so with multiply-add contraction enabled they may round
+// differently
+template <typename T, size_t dim>
+void
+checkSame( const vector_soa<T, dim> &a, const vector_soa<T, dim> &b, const char *what )
+{
+	if ( a.size() != b.size() )
+		throw std::runtime_error( std::string( what ) + ": size mismatch" );
+	for ( size_t i = 0; i != a.size(); ++i )
+	{
+		vector<T, dim> x = a[i], y = b[i];
+		for ( size_t c = 0; c != dim; ++c )
+		{
+			if ( ! close( x[c], y[c] ) )
+				throw std::runtime_error( std::string( what ) + ": mismatch at " + std::to_string( i ) );
+		}
+	}
+}
+
+template <typename T>
+int
+testTransforms( size_t n, size_t nthreads )
+{
+	std::mt19937 gen( static_cast<unsigned>( n ) );
+	vector_soa<T, 3> in = randomPoints<T>( gen, n ), out, expect;
+	vector_soa<T, 4> clip, expect4;
+
+	const square_matrix<T, 4> mats[2] = { affine<T>(), perspective<T>() };
+	for ( const auto &m: mats )
+	{
+		expect.clear();
+		for ( size_t i = 0; i != n; ++i )
+			expect.push_back( transform_point( m, in[i] ) );
+		transform_points( m, in, out, nthreads );
+		checkSame( out, expect, "transform_points" );
+
+		expect4.clear();
+		for ( size_t i = 0; i != n; ++i )
+			expect4.push_back( m * vector<T, 4>{ in[i][0], in[i][1], in[i][2], T( 1 ) } );
+		project_points( m, in, clip, nthreads );
+		checkSame( clip, expect4, "project_points" );
+		perspective_divide( clip, out, nthreads );
+		checkSame( out, expect, "perspective_divide" );
+
+		expect.clear();
+		for ( size_t i = 0; i != n; ++i )
+			expect.push_back( transform_vector( m, in[i] ) );
+		transform_vectors( m, in, out, nthreads );
+		checkSame( out, expect, "transform_vectors" );
+	}
+
+	// in place
+	out = in;
+	transform_points( mats[1], out, out, nthreads );
+	transform_points( mats[1], in, expect, nthreads );
+	checkSame( out, expect, "in place transform_points" );
+	return 0;
+}
+
+template <typename T>
+int
+testNormals( size_t n, size_t nthreads )
+{
+	std::mt19937 gen( static_cast<unsigned>( n + 1 ) );
+	vector_soa<T, 3> in = randomPoints<T>( gen, n ), out;
+	if ( n > 3 )
+		in.set( 3, vector<T, 3>() );
+
+	// a non-uniform scale, where the inverse transpose matters
+	square_matrix<T, 4> m = affine<T>();
+	m( 0, 0 ) *= T( 4 );
+	m( 1, 2 ) *= T( 0.25 );
+
+	transform_normals( m, in, out, nthreads );
+	if ( out.size() != n )
+		throw std::runtime_error( "transform_normals size" );
+	for ( size_t i = 0; i != n; ++i )
+	{
+		vector<T, 3> nrm = out[i];
+		if ( i == 3 )
+		{
+			if ( ! ( nrm == vector<T, 3>() ) )
+				throw std::runtime_error( "transform_normals changed a zero normal" );
+			continue;
+		}
+		if ( ! close( nrm.magnitude(), T( 1 ) ) )
+			throw std::runtime_error( "transform_normals not normalized" );
+
+		// still perpendicular to the transformed tangents
+		vector<T, 3> src = in[i];
+		vector<T, 3> t1 = cross( src, vector<T, 3>{ T( 1 ), T( 0 ), T( 0 ) } );
+		vector<T, 3> t2 = cross( src, t1 );
+		for ( const auto &t: { t1, t2 } )
+		{
+			vector<T, 3> tt = transform_vector( m, t );
+			if ( ! close( dot( nrm, tt ) / tt.magnitude(), T( 0 ) ) )
+				throw std::runtime_error( "transform_normals not perpendicular" );
+		}
+	}
+
+	vector_soa<T, 3> v = in, expect;
+	for ( size_t i = 0; i != n; ++i )
+	{
+		vector<T, 3> e = in[i];
+		e.normalize();
+		expect.push_back( e );
+	}
+	normalize( v, nthreads );
+	checkSame( v, expect, "normalize" );
+
+	square_matrix<T, 4> singular = m;
+	for ( size_t c = 0; c != 3; ++c )
+		singular( 2, c ) = T( 0 );
+	bool threw = false;
+	try
+	{
+		transform_normals( singular, in, out, nthreads );
+	}
+	catch ( std::runtime_error & )
+	{
+		threw = true;
+	}
+	if ( ! threw )
+		throw std::runtime_error( "transform_normals accepted a singular matrix" );
+	return 0;
+}
+
+template <typename T>
+int
+testBounds( size_t n, size_t nthreads )
+{
+	std::mt19937 gen( static_cast<unsigned>( n + 2 ) );
+	vector_soa<T, 3> in = randomPoints<T>( gen, n );
+	if ( n > 10 )
+		in.set( n / 2, vector<T, 3>{ std::numeric_limits<T>::quiet_NaN(), T( 0 ), T( 0 ) } );
+
+	vector<T, 3> lo, hi;
+	for ( size_t c = 0; c != 3; ++c )
+	{
+		lo[c] = std::numeric_limits<T>::infinity();
+		hi[c] = -std::numeric_limits<T>::infinity();
+	}
+	for ( size_t i = 0; i != n; ++i )
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			T v = in.component( c )[i];
+			if ( v != v )
+				continue;
+			lo[c] = std::min( lo[c], v );
+			hi[c] = std::max( hi[c], v );
+		}
+	}
+
+	auto box = bounding_box( in, nthreads );
+	if ( ! ( box.first == lo ) || ! ( box.second == hi ) )
+		throw std::runtime_error( "bounding_box mismatch at " + std::to_string( n ) );
+	return 0;
+}
+
+template <typename T>
+int
+testAll( void )
+{
+	int retval = 0;
+	for ( size_t n: { 0, 1, 7, 64, 1001 } )
+	{
+		retval += testTransforms<T>( n, 1 );
+		retval += testNormals<T>( n, 1 );
+		retval += testBounds<T>( n, 1 );
+	}
+
+	// big enough to be split, into an odd number of pieces
+	for ( size_t nthreads: { 0, 3 } )
+	{
+		size_t n = vector_soa_parallel_min * 2 + 5;
+		retval += testTransforms<T>( n, nthreads );
+		retval += testNormals<T>( n, nthreads );
+		retval += testBounds<T>( n, nthreads );
+	}
+	return retval;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+int
+main( int /*argc*/, char */*argv*/[] )
+{
+	int retval = 0;
+	try
+	{
+		retval += testAll<float>();
+		retval += testAll<double>();
+	}
+	catch ( std::exception &e )
+	{
+		std::cout << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return retval;
+}
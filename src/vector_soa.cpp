@@ -0,0 +1,446 @@
+//
+// Copyright (c) 2012 Kimball Thurston
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math/vector_soa.h>
+#include <impl/soa_priv.h>
+#include <algorithm>
+#include <limits>
+
+
+////////////////////////////////////////
+
+
+namespace
+{
+
+using namespace yaco::math;
+using yaco::__priv::scalar_lane;
+using yaco::__priv::simd_lane;
+using yaco::__priv::parallel_for;
+using yaco::__priv::piece_count;
+
+size_t
+piece_size( size_t n, size_t nthreads )
+{
+	return yaco::__priv::piece_size( n, nthreads, vector_soa_parallel_min );
+}
+
+/// row r of the column major 4 x 4 m times ( x, y, z, w ), with w
+/// 0 (no w), or 1 (w column added as is)
+template <typename L>
+struct row_consts
+{
+	typename L::type c[4];
+
+	template <typename T>
+	void init( const T *m, size_t r )
+	{
+		for ( size_t k = 0; k != 4; ++k )
+			c[k] = L::set1( m[k * 4 + r] );
+	}
+
+	typename L::type vec( typename L::type x, typename L::type y, typename L::type z ) const
+	{
+		return L::add( L::add( L::mul( c[0], x ), L::mul( c[1], y ) ), L::mul( c[2], z ) );
+	}
+
+	typename L::type point( typename L::type x, typename L::type y, typename L::type z ) const
+	{
+		return L::add( vec( x, y, z ), c[3] );
+	}
+};
+
+template <typename L, typename T>
+size_t
+points_kernel( const T *m, bool divide, const T *const in[3], T *const out[3], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	row_consts<L> rows[4];
+	for ( size_t r = 0; r != 4; ++r )
+		rows[r].init( m, r );
+	const V one = L::set1( T( 1 ) );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V x = L::load( in[0] + i ), y = L::load( in[1] + i ), z = L::load( in[2] + i );
+		V rx = rows[0].point( x, y, z );
+		V ry = rows[1].point( x, y, z );
+		V rz = rows[2].point( x, y, z );
+		if ( divide )
+		{
+			V iw = L::div( one, rows[3].point( x, y, z ) );
+			rx = L::mul( rx, iw );
+			ry = L::mul( ry, iw );
+			rz = L::mul( rz, iw );
+		}
+		L::store( out[0] + i, rx );
+		L::store( out[1] + i, ry );
+		L::store( out[2] + i, rz );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+project_kernel( const T *m, const T *const in[3], T *const out[4], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	row_consts<L> rows[4];
+	for ( size_t r = 0; r != 4; ++r )
+		rows[r].init( m, r );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V x = L::load( in[0] + i ), y = L::load( in[1] + i ), z = L::load( in[2] + i );
+		V r[4];
+		for ( size_t c = 0; c != 4; ++c )
+			r[c] = rows[c].point( x, y, z );
+		for ( size_t c = 0; c != 4; ++c )
+			L::store( out[c] + i, r[c] );
+	}
+	return i;
+}
+
+/// same as vector::normalize, including leaving the (nearly) 0
+/// length ones alone
+template <typename L>
+inline void
+normalize_lanes( typename L::type &x, typename L::type &y, typename L::type &z,
+				 typename L::type eps, typename L::type one )
+{
+	typename L::type l = L::sqrt( L::add( L::add( L::mul( x, x ), L::mul( y, y ) ), L::mul( z, z ) ) );
+	l = L::select_gt( l, eps, l, one );
+	x = L::div( x, l );
+	y = L::div( y, l );
+	z = L::div( z, l );
+}
+
+/// m * ( x, y, z, 0 ), normalized afterwards when asked to
+template <typename L, typename T>
+size_t
+vectors_kernel( const T *m, bool norm, const T *const in[3], T *const out[3], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	row_consts<L> rows[3];
+	for ( size_t r = 0; r != 3; ++r )
+		rows[r].init( m, r );
+	const V eps = L::set1( std::numeric_limits<T>::epsilon() );
+	const V one = L::set1( T( 1 ) );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V x = L::load( in[0] + i ), y = L::load( in[1] + i ), z = L::load( in[2] + i );
+		V rx = rows[0].vec( x, y, z );
+		V ry = rows[1].vec( x, y, z );
+		V rz = rows[2].vec( x, y, z );
+		if ( norm )
+			normalize_lanes<L>( rx, ry, rz, eps, one );
+		L::store( out[0] + i, rx );
+		L::store( out[1] + i, ry );
+		L::store( out[2] + i, rz );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+normalize_kernel( T *const v[3], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	const V eps = L::set1( std::numeric_limits<T>::epsilon() );
+	const V one = L::set1( T( 1 ) );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V x = L::load( v[0] + i ), y = L::load( v[1] + i ), z = L::load( v[2] + i );
+		normalize_lanes<L>( x, y, z, eps, one );
+		L::store( v[0] + i, x );
+		L::store( v[1] + i, y );
+		L::store( v[2] + i, z );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+divide_kernel( const T *const in[4], T *const out[3], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	const V one = L::set1( T( 1 ) );
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		V iw = L::div( one, L::load( in[3] + i ) );
+		V x = L::mul( L::load( in[0] + i ), iw );
+		V y = L::mul( L::load( in[1] + i ), iw );
+		V z = L::mul( L::load( in[2] + i ), iw );
+		L::store( out[0] + i, x );
+		L::store( out[1] + i, y );
+		L::store( out[2] + i, z );
+	}
+	return i;
+}
+
+template <typename L, typename T>
+size_t
+bounds_kernel( const T *const in[3], T lo[3], T hi[3], size_t i, size_t e )
+{
+	typedef typename L::type V;
+	V mn[3], mx[3];
+	for ( size_t c = 0; c != 3; ++c )
+	{
+		mn[c] = L::set1( lo[c] );
+		mx[c] = L::set1( hi[c] );
+	}
+
+	for ( ; i + L::width <= e; i += L::width )
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			V v = L::load( in[c] + i );
+			mn[c] = L::min( mn[c], v );
+			mx[c] = L::max( mx[c], v );
+		}
+	}
+
+	for ( size_t c = 0; c != 3; ++c )
+	{
+		alignas(32) T a[L::width], b[L::width];
+		L::store( a, mn[c] );
+		L::store( b, mx[c] );
+		for ( size_t k = 0; k != L::width; ++k )
+		{
+			lo[c] = scalar_lane<T>::min( lo[c], a[k] );
+			hi[c] = scalar_lane<T>::max( hi[c], b[k] );
+		}
+	}
+	return i;
+}
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+namespace yaco
+{
+
+namespace math
+{
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+transform_points( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads )
+{
+	const size_t n = in.size();
+	out.resize( n );
+
+	const T *mv = m.data();
+	bool divide = ! ( mv[3] == T( 0 ) && mv[7] == T( 0 ) && mv[11] == T( 0 ) && mv[15] == T( 1 ) );
+	const T *const src[3] = { in.component( 0 ), in.component( 1 ), in.component( 2 ) };
+	T *const dst[3] = { out.component( 0 ), out.component( 1 ), out.component( 2 ) };
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = points_kernel<simd_lane<T>>( mv, divide, src, dst, b, e );
+		points_kernel<scalar_lane<T>>( mv, divide, src, dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+transform_vectors( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads )
+{
+	const size_t n = in.size();
+	out.resize( n );
+
+	const T *mv = m.data();
+	const T *const src[3] = { in.component( 0 ), in.component( 1 ), in.component( 2 ) };
+	T *const dst[3] = { out.component( 0 ), out.component( 1 ), out.component( 2 ) };
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = vectors_kernel<simd_lane<T>>( mv, false, src, dst, b, e );
+		vectors_kernel<scalar_lane<T>>( mv, false, src, dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+transform_normals( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 3> &out, size_t nthreads )
+{
+	square_matrix<T, 3> u;
+	for ( size_t r = 0; r != 3; ++r )
+		for ( size_t c = 0; c != 3; ++c )
+			u( r, c ) = m( r, c );
+	u = u.inverse().transposed();
+
+	// widened to 4 x 4 so the kernel can share the row code
+	square_matrix<T, 4> nm;
+	for ( size_t r = 0; r != 3; ++r )
+		for ( size_t c = 0; c != 3; ++c )
+			nm( r, c ) = u( r, c );
+
+	const size_t n = in.size();
+	out.resize( n );
+
+	const T *mv = nm.data();
+	const T *const src[3] = { in.component( 0 ), in.component( 1 ), in.component( 2 ) };
+	T *const dst[3] = { out.component( 0 ), out.component( 1 ), out.component( 2 ) };
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = vectors_kernel<simd_lane<T>>( mv, true, src, dst, b, e );
+		vectors_kernel<scalar_lane<T>>( mv, true, src, dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+project_points( const square_matrix<T, 4> &m, const vector_soa<T, 3> &in, vector_soa<T, 4> &out, size_t nthreads )
+{
+	const size_t n = in.size();
+	out.resize( n );
+
+	const T *mv = m.data();
+	const T *const src[3] = { in.component( 0 ), in.component( 1 ), in.component( 2 ) };
+	T *const dst[4] = { out.component( 0 ), out.component( 1 ), out.component( 2 ), out.component( 3 ) };
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = project_kernel<simd_lane<T>>( mv, src, dst, b, e );
+		project_kernel<scalar_lane<T>>( mv, src, dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+perspective_divide( const vector_soa<T, 4> &in, vector_soa<T, 3> &out, size_t nthreads )
+{
+	const size_t n = in.size();
+	out.resize( n );
+
+	const T *const src[4] = { in.component( 0 ), in.component( 1 ), in.component( 2 ), in.component( 3 ) };
+	T *const dst[3] = { out.component( 0 ), out.component( 1 ), out.component( 2 ) };
+	parallel_for( n, piece_size( n, nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = divide_kernel<simd_lane<T>>( src, dst, b, e );
+		divide_kernel<scalar_lane<T>>( src, dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+void
+normalize( vector_soa<T, 3> &v, size_t nthreads )
+{
+	T *const dst[3] = { v.component( 0 ), v.component( 1 ), v.component( 2 ) };
+	parallel_for( v.size(), piece_size( v.size(), nthreads ), [&]( size_t, size_t b, size_t e )
+	{
+		size_t i = normalize_kernel<simd_lane<T>>( dst, b, e );
+		normalize_kernel<scalar_lane<T>>( dst, i, e );
+	} );
+}
+
+
+////////////////////////////////////////
+
+
+template <typename T>
+std::pair<vector<T, 3>, vector<T, 3>>
+bounding_box( const vector_soa<T, 3> &v, size_t nthreads )
+{
+	const size_t n = v.size();
+	const size_t chunk = piece_size( n, nthreads );
+	struct box { T lo[3], hi[3]; };
+	std::vector<box> boxes( piece_count( n, chunk ) );
+	for ( auto &b: boxes )
+	{
+		for ( size_t c = 0; c != 3; ++c )
+		{
+			b.lo[c] = std::numeric_limits<T>::infinity();
+			b.hi[c] = -std::numeric_limits<T>::infinity();
+		}
+	}
+
+	const T *const src[3] = { v.component( 0 ), v.component( 1 ), v.component( 2 ) };
+	parallel_for( n, chunk, [&]( size_t p, size_t b, size_t e )
+	{
+		size_t i = bounds_kernel<simd_lane<T>>( src, boxes[p].lo, boxes[p].hi, b, e );
+		bounds_kernel<scalar_lane<T>>( src, boxes[p].lo, boxes[p].hi, i, e );
+	} );
+
+	std::pair<vector<T, 3>, vector<T, 3>> r;
+	for ( size_t c = 0; c != 3; ++c )
+	{
+		r.first[c] = boxes[0].lo[c];
+		r.second[c] = boxes[0].hi[c];
+		for ( size_t p = 1; p < boxes.size(); ++p )
+		{
+			r.first[c] = std::min( r.first[c], boxes[p].lo[c] );
+			r.second[c] = std::max( r.second[c], boxes[p].hi[c] );
+		}
+	}
+	return r;
+}
+
+
+////////////////////////////////////////
+
+
+#define YACO_INSTANTIATE_VECTOR_SOA( T ) \
+	template void transform_points( const square_matrix<T, 4> &, const vector_soa<T, 3> &, vector_soa<T, 3> &, size_t ); \
+	template void transform_vectors( const square_matrix<T, 4> &, const vector_soa<T, 3> &, vector_soa<T, 3> &, size_t ); \
+	template void transform_normals( const square_matrix<T, 4> &, const vector_soa<T, 3> &, vector_soa<T, 3> &, size_t ); \
+	template void project_points( const square_matrix<T, 4> &, const vector_soa<T, 3> &, vector_soa<T, 4> &, size_t ); \
+	template void perspective_divide( const vector_soa<T, 4> &, vector_soa<T, 3> &, size_t ); \
+	template void normalize( vector_soa<T, 3> &, size_t ); \
+	template std::pair<vector<T, 3>, vector<T, 3>> bounding_box( const vector_soa<T, 3> &, size_t )
+
+YACO_INSTANTIATE_VECTOR_SOA( float );
+YACO_INSTANTIATE_VECTOR_SOA( double );
+
+#undef YACO_INSTANTIATE_VECTOR_SOA
+
+} // math
+} // yaco